@@ -1,4 +1,4 @@
-QT       += core gui network xml svg
+QT       += core gui network svg sql
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -15,13 +15,50 @@ SOURCES += \
     src/mainwindow.cpp \
     src/rssfeedmodel.cpp \
     src/newsfeedwidget.cpp \
-    src/rssparser.cpp
+    src/rssparser.cpp \
+    src/feedmetrics.cpp \
+    src/diagnosticsdialog.cpp \
+    src/stallwatchdog.cpp \
+    src/articlestore.cpp \
+    src/feeditem.cpp \
+    src/feedrecovery.cpp \
+    src/htmlscanner.cpp \
+    src/bytescanner.cpp \
+    src/jsonfeedreader.cpp \
+    src/alertengine.cpp \
+    src/notificationaggregator.cpp \
+    src/categoryindex.cpp \
+    src/storycluster.cpp \
+    src/thememanager.cpp \
+    src/savedsearch.cpp \
+    src/localapiserver.cpp \
+    src/singleinstance.cpp \
+    src/feeditemdelegate.cpp
 
 HEADERS += \
     src/mainwindow.h \
     src/rssfeedmodel.h \
     src/newsfeedwidget.h \
-    src/rssparser.h
+    src/rssparser.h \
+    src/feedmetrics.h \
+    src/diagnosticsdialog.h \
+    src/stallwatchdog.h \
+    src/feeditem.h \
+    src/articlestore.h \
+    src/feedrecovery.h \
+    src/htmlscanner.h \
+    src/bytescanner.h \
+    src/jsonfeedreader.h \
+    src/alertengine.h \
+    src/notificationaggregator.h \
+    src/categoryindex.h \
+    src/storycluster.h \
+    src/thememanager.h \
+    src/savedsearch.h \
+    src/localapiserver.h \
+    src/singleinstance.h \
+    src/feeditemdelegate.h \
+    src/qtcompat.h
 
 FORMS += \
     src/mainwindow.ui
@@ -38,7 +38,9 @@ echo "   cp /path/to/mxe/usr/x86_64-w64-mingw32.shared/qt5/bin/Qt5Gui.dll window
 echo "   cp /path/to/mxe/usr/x86_64-w64-mingw32.shared/qt5/bin/Qt5Widgets.dll windows-build/MotorsportRSS/"
 echo "   cp /path/to/mxe/usr/x86_64-w64-mingw32.shared/qt5/bin/Qt5Svg.dll windows-build/MotorsportRSS/"
 echo "   cp /path/to/mxe/usr/x86_64-w64-mingw32.shared/qt5/bin/Qt5Network.dll windows-build/MotorsportRSS/"
-echo "   cp /path/to/mxe/usr/x86_64-w64-mingw32.shared/qt5/bin/Qt5Xml.dll windows-build/MotorsportRSS/"
+echo "   cp /path/to/mxe/usr/x86_64-w64-mingw32.shared/qt5/bin/Qt5Sql.dll windows-build/MotorsportRSS/"
+echo "   mkdir -p windows-build/MotorsportRSS/sqldrivers"
+echo "   cp /path/to/mxe/usr/x86_64-w64-mingw32.shared/qt5/plugins/sqldrivers/qsqlite.dll windows-build/MotorsportRSS/sqldrivers/"
 echo "   mkdir -p windows-build/MotorsportRSS/platforms"
 echo "   cp /path/to/mxe/usr/x86_64-w64-mingw32.shared/qt5/plugins/platforms/qwindows.dll windows-build/MotorsportRSS/platforms/"
 echo "   mkdir -p windows-build/MotorsportRSS/resources"
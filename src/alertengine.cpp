@@ -0,0 +1,204 @@
+#include "alertengine.h"
+#include "qtcompat.h"
+
+#include <QSettings>
+#include <QQueue>
+
+namespace {
+
+quint64 transitionKey(int state, ushort unit)
+{
+    return quint64(state) << 16 | unit;
+}
+
+} // namespace
+
+AlertEngine::AlertEngine()
+    : m_throttleSecs(30 * 60)
+{
+    compile();
+}
+
+void AlertEngine::setRules(const QList<AlertRule> &rules)
+{
+    m_rules = rules;
+    compile();
+}
+
+int AlertEngine::next(int state, ushort unit) const
+{
+    auto it = m_transitions.constFind(transitionKey(state, unit));
+    return it == m_transitions.constEnd() ? -1 : it.value();
+}
+
+void AlertEngine::compile()
+{
+    m_patterns.clear();
+    m_states.clear();
+    m_transitions.clear();
+    m_states.append(State());
+
+    // Trie of the case-folded keywords
+    for (int rule = 0; rule < m_rules.size(); ++rule) {
+        for (const QString &keyword : m_rules.at(rule).keywords) {
+            const QString folded = keyword.trimmed().toCaseFolded();
+            if (folded.isEmpty()) {
+                continue;
+            }
+
+            int state = 0;
+            for (QChar c : folded) {
+                int target = next(state, c.unicode());
+                if (target < 0) {
+                    target = m_states.size();
+                    m_states.append(State());
+                    m_transitions.insert(transitionKey(state, c.unicode()), target);
+                }
+                state = target;
+            }
+            m_states[state].outputs.append(m_patterns.size());
+            m_patterns.append({ rule, folded.size() });
+        }
+    }
+
+    // Failure links breadth first; outputs of the fail target are inherited
+    QVector<QVector<QPair<ushort, int>>> children(m_states.size());
+    for (auto it = m_transitions.constBegin(); it != m_transitions.constEnd(); ++it) {
+        children[int(it.key() >> 16)].append(qMakePair(ushort(it.key() & 0xFFFF), it.value()));
+    }
+
+    QQueue<int> queue;
+    for (const auto &child : children.at(0)) {
+        queue.enqueue(child.second);
+    }
+    while (!queue.isEmpty()) {
+        int state = queue.dequeue();
+        for (const auto &child : children.at(state)) {
+            int fail = m_states.at(state).fail;
+            int target;
+            while ((target = next(fail, child.first)) < 0 && fail != 0) {
+                fail = m_states.at(fail).fail;
+            }
+            m_states[child.second].fail = target >= 0 ? target : 0;
+            m_states[child.second].outputs += m_states.at(m_states.at(child.second).fail).outputs;
+            queue.enqueue(child.second);
+        }
+    }
+}
+
+QVector<int> AlertEngine::match(const QString &text) const
+{
+    QVector<int> matched;
+    if (m_patterns.isEmpty()) {
+        return matched;
+    }
+
+    const QString folded = text.toCaseFolded();
+    QVector<bool> seen(m_rules.size(), false);
+    int state = 0;
+
+    for (int i = 0; i < folded.size(); ++i) {
+        const ushort unit = folded.at(i).unicode();
+        int target;
+        while ((target = next(state, unit)) < 0 && state != 0) {
+            state = m_states.at(state).fail;
+        }
+        state = target >= 0 ? target : 0;
+
+        for (int patternIndex : m_states.at(state).outputs) {
+            const Pattern &pattern = m_patterns.at(patternIndex);
+            if (seen.at(pattern.rule)) {
+                continue;
+            }
+            // Keywords must start a word
+            int start = i - pattern.length + 1;
+            if (start > 0 && folded.at(start - 1).isLetterOrNumber()) {
+                continue;
+            }
+            seen[pattern.rule] = true;
+            matched.append(pattern.rule);
+        }
+    }
+    return matched;
+}
+
+QStringList AlertEngine::evaluate(const QString &text, qint64 now)
+{
+    QStringList fired;
+    for (int rule : match(text)) {
+        const QString &name = m_rules.at(rule).name;
+        auto it = m_lastFired.find(name);
+        if (it != m_lastFired.end() && now - it.value() < m_throttleSecs) {
+            continue;
+        }
+        m_lastFired.insert(name, now);
+        fired.append(name);
+    }
+    return fired;
+}
+
+QList<AlertRule> AlertEngine::parseRules(const QString &text)
+{
+    QList<AlertRule> rules;
+    const QStringList lines = text.split(QLatin1Char('\n'), QtCompat::SkipEmptyParts);
+    for (const QString &line : lines) {
+        // Without a name the keywords name the rule
+        int colon = line.indexOf(QLatin1Char(':'));
+        AlertRule rule;
+        rule.name = colon >= 0 ? line.left(colon).trimmed() : line.trimmed();
+        const QStringList keywords = line.mid(colon + 1).split(QLatin1Char(','), QtCompat::SkipEmptyParts);
+        for (const QString &keyword : keywords) {
+            if (!keyword.trimmed().isEmpty()) {
+                rule.keywords.append(keyword.trimmed());
+            }
+        }
+        if (!rule.name.isEmpty() && !rule.keywords.isEmpty()) {
+            rules.append(rule);
+        }
+    }
+    return rules;
+}
+
+QString AlertEngine::formatRules(const QList<AlertRule> &rules)
+{
+    QStringList lines;
+    for (const AlertRule &rule : rules) {
+        lines.append(rule.name + QLatin1String(": ") + rule.keywords.join(QLatin1String(", ")));
+    }
+    return lines.join(QLatin1Char('\n'));
+}
+
+void AlertEngine::load()
+{
+    QSettings settings;
+    m_throttleSecs = settings.value("alerts/throttleMinutes", m_throttleSecs / 60).toLongLong() * 60;
+
+    QList<AlertRule> rules;
+    int size = settings.beginReadArray("alerts/rules");
+    for (int i = 0; i < size; ++i) {
+        settings.setArrayIndex(i);
+        AlertRule rule;
+        rule.name = settings.value("name").toString();
+        rule.keywords = settings.value("keywords").toStringList();
+        if (!rule.name.isEmpty() && !rule.keywords.isEmpty()) {
+            rules.append(rule);
+        }
+    }
+    settings.endArray();
+
+    setRules(rules);
+}
+
+void AlertEngine::save() const
+{
+    QSettings settings;
+    settings.setValue("alerts/throttleMinutes", m_throttleSecs / 60);
+
+    settings.beginWriteArray("alerts/rules");
+    for (int i = 0; i < m_rules.size(); ++i) {
+        settings.setArrayIndex(i);
+        settings.setValue("name", m_rules.at(i).name);
+        settings.setValue("keywords", m_rules.at(i).keywords);
+    }
+    settings.endArray();
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef ALERTENGINE_H
+#define ALERTENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QHash>
+
+// A named set of keywords; any keyword in a new article triggers the rule
+struct AlertRule {
+    QString name;
+    QStringList keywords;
+};
+
+// Keyword alerts for new articles. All keywords of all rules are compiled
+// into one Aho-Corasick automaton, so matching costs a single pass over the
+// text however many rules there are. Keywords match case-insensitively at
+// the start of a word ("crash" also matches "crashes"). Each rule fires at
+// most once per throttle interval.
+class AlertEngine
+{
+public:
+    AlertEngine();
+
+    void setRules(const QList<AlertRule> &rules);
+    const QList<AlertRule> &rules() const { return m_rules; }
+    bool isEmpty() const { return m_patterns.isEmpty(); }
+
+    void setThrottleSecs(qint64 secs) { m_throttleSecs = secs; }
+    qint64 throttleSecs() const { return m_throttleSecs; }
+
+    // Indexes of the rules with a keyword in the text
+    QVector<int> match(const QString &text) const;
+
+    // Names of the matching rules that are not throttled; they are marked fired
+    QStringList evaluate(const QString &text, qint64 now);
+
+    // One rule per line: "Name: keyword, keyword"
+    static QList<AlertRule> parseRules(const QString &text);
+    static QString formatRules(const QList<AlertRule> &rules);
+
+    // QSettings persistence
+    void load();
+    void save() const;
+
+private:
+    struct Pattern {
+        int rule;
+        int length;
+    };
+
+    struct State {
+        int fail = 0;
+        QVector<int> outputs; // patterns ending here, including via fail links
+    };
+
+    QList<AlertRule> m_rules;
+    QVector<Pattern> m_patterns;
+    QVector<State> m_states;
+    QHash<quint64, int> m_transitions; // state << 16 | UTF-16 unit -> state
+    QHash<QString, qint64> m_lastFired; // rule name -> seconds since epoch
+    qint64 m_throttleSecs;
+
+    int next(int state, ushort unit) const;
+    void compile();
+};
+
+#endif // ALERTENGINE_H
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "alloccounter.h"
+
+#include <cstddef>
+
+#if defined(MOTORSPORTRSS_ALLOC_COUNTER) && defined(__GLIBC__)
+
+#include <malloc.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+}
+
+namespace {
+
+// Plain thread-locals of the executable live in static TLS, so touching
+// them from inside malloc never allocates
+thread_local bool t_counting = false;
+thread_local quint64 t_count = 0;
+
+} // namespace
+
+extern "C" void *malloc(size_t size)
+{
+    if (t_counting) {
+        ++t_count;
+    }
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    if (t_counting) {
+        ++t_count;
+    }
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    if (t_counting) {
+        ++t_count;
+    }
+    return __libc_realloc(ptr, size);
+}
+
+bool AllocCounter::isAvailable()
+{
+    return true;
+}
+
+void AllocCounter::start()
+{
+    t_count = 0;
+    t_counting = true;
+}
+
+quint64 AllocCounter::stop()
+{
+    t_counting = false;
+    return t_count;
+}
+
+quint64 AllocCounter::heapInUse()
+{
+    // Arena chunks in use plus blocks large enough to be mapped on their own
+#if __GLIBC_PREREQ(2, 33)
+    const struct mallinfo2 info = mallinfo2();
+#else
+    const struct mallinfo info = mallinfo();
+#endif
+    return quint64(info.uordblks) + quint64(info.hblkhd);
+}
+
+#else
+
+bool AllocCounter::isAvailable()
+{
+    return false;
+}
+
+void AllocCounter::start()
+{
+}
+
+quint64 AllocCounter::stop()
+{
+    return 0;
+}
+
+quint64 AllocCounter::heapInUse()
+{
+    return 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,23 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <QtGlobal>
+
+// Counts heap allocations made by the calling thread between start() and
+// stop(). Works by interposing malloc, calloc and realloc, so Qt's own
+// string and container allocations are included. Only the benchmarks link
+// it, with MOTORSPORTRSS_ALLOC_COUNTER defined, and only with glibc;
+// elsewhere it reports the counter unavailable.
+namespace AllocCounter {
+
+bool isAvailable();
+void start();
+quint64 stop();
+
+// Bytes currently allocated from the heap by the whole process, as malloc
+// accounts them; the difference of two calls is the live growth between
+quint64 heapInUse();
+
+} // namespace AllocCounter
+
+#endif // ALLOCCOUNTER_H
\ No newline at end of file
@@ -0,0 +1,1187 @@
+#include "articlestore.h"
+#include "htmlscanner.h"
+#include "qtcompat.h"
+
+#include <QSqlError>
+#include <QVariant>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QDebug>
+
+#include <algorithm>
+
+ArticleStore::ArticleStore()
+    : m_connectionName(QString("articles-%1").arg(quintptr(this), 0, 16))
+{
+}
+
+ArticleStore::~ArticleStore()
+{
+    // Queries must be released before the connection is removed
+    m_insertItem = QSqlQuery();
+    m_attachStory = QSqlQuery();
+    m_selectItems = QSqlQuery();
+    m_selectRecentItems = QSqlQuery();
+    m_selectOlderItems = QSqlQuery();
+    m_containsItem = QSqlQuery();
+    m_selectArticle = QSqlQuery();
+    m_selectDescription = QSqlQuery();
+    m_selectSources = QSqlQuery();
+    m_selectStoryArticles = QSqlQuery();
+    m_findStory = QSqlQuery();
+    m_insertStory = QSqlQuery();
+    m_fillStory = QSqlQuery();
+    m_pruneStories = QSqlQuery();
+    m_searchItems = QSqlQuery();
+    m_searchCandidates = QSqlQuery();
+    m_pruneAge = QSqlQuery();
+    m_pruneCount = QSqlQuery();
+    m_pruneOldest = QSqlQuery();
+    m_pruneTombstones = QSqlQuery();
+    m_selectEvicted = QSqlQuery();
+    m_clearEvicted = QSqlQuery();
+    m_updateRead = QSqlQuery();
+    m_countItems = QSqlQuery();
+    m_selectUnread = QSqlQuery();
+    m_selectMeta = QSqlQuery();
+    m_ensureFeed = QSqlQuery();
+    m_updateValidators = QSqlQuery();
+    m_updateLastUpdate = QSqlQuery();
+
+    if (m_db.isValid()) {
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+}
+
+QString ArticleStore::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/articles.sqlite";
+}
+
+bool ArticleStore::open(const QString &path)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    m_db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    m_db.setDatabaseName(path);
+    if (!m_db.open()) {
+        qWarning() << "Could not open article store" << path << m_db.lastError().text();
+        return false;
+    }
+
+    // WAL lets readers proceed during writes and turns commits into appends
+    exec("PRAGMA journal_mode=WAL");
+    exec("PRAGMA synchronous=NORMAL");
+    exec("PRAGMA temp_store=MEMORY");
+
+    if (!migrate() || !createEvictionLog() || !prepareStatements()) {
+        m_db.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool ArticleStore::createEvictionLog()
+{
+    // Deleted rows are logged per connection, so prune can report them. The
+    // trigger needs the articles table, so this runs after the migration.
+    return exec("CREATE TEMP TABLE IF NOT EXISTS evicted_articles (feed_url TEXT, guid TEXT)")
+        && exec("CREATE TEMP TRIGGER IF NOT EXISTS articles_evicted AFTER DELETE ON main.articles"
+                " BEGIN INSERT INTO evicted_articles (feed_url, guid) VALUES (old.feed_url, old.guid); END");
+}
+
+bool ArticleStore::exec(const QString &sql)
+{
+    QSqlQuery query(m_db);
+    if (!query.exec(sql)) {
+        qWarning() << "Article store query failed:" << sql << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+qint64 ArticleStore::pragmaValue(const QString &pragma)
+{
+    QSqlQuery query(m_db);
+    if (query.exec("PRAGMA " + pragma) && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
+
+bool ArticleStore::migrate()
+{
+    int version = int(pragmaValue("user_version"));
+    if (version >= SchemaVersion) {
+        return true;
+    }
+
+    // Incremental auto-vacuum lets pruning hand pages back to the file system.
+    // The mode only takes effect after a VACUUM, which cannot run in a transaction.
+    if (version < 2 && pragmaValue("auto_vacuum") != 2) {
+        exec("PRAGMA auto_vacuum=INCREMENTAL");
+        exec("VACUUM");
+    }
+
+    if (!m_db.transaction()) {
+        qWarning() << "Could not migrate article store:" << m_db.lastError().text();
+        return false;
+    }
+
+    bool ok = true;
+    if (version < 1) {
+        ok = ok && exec("CREATE TABLE IF NOT EXISTS feeds ("
+                        " url TEXT PRIMARY KEY,"
+                        " etag TEXT,"
+                        " last_modified TEXT,"
+                        " last_update INTEGER)");
+        ok = ok && exec("CREATE TABLE IF NOT EXISTS articles ("
+                        " id INTEGER PRIMARY KEY,"
+                        " feed_url TEXT NOT NULL,"
+                        " guid TEXT NOT NULL,"
+                        " title TEXT,"
+                        " link TEXT,"
+                        " description TEXT,"
+                        " pub_date TEXT,"
+                        " pub_time INTEGER NOT NULL DEFAULT 0,"
+                        " image_url TEXT,"
+                        " category TEXT,"
+                        " is_read INTEGER NOT NULL DEFAULT 0,"
+                        " fetch_time INTEGER NOT NULL)");
+        ok = ok && exec("CREATE UNIQUE INDEX IF NOT EXISTS idx_articles_feed_guid ON articles(feed_url, guid)");
+        ok = ok && exec("CREATE INDEX IF NOT EXISTS idx_articles_guid ON articles(guid)");
+        ok = ok && exec("CREATE INDEX IF NOT EXISTS idx_articles_feed_pub ON articles(feed_url, pub_time)");
+        ok = ok && exec("CREATE INDEX IF NOT EXISTS idx_articles_feed_read ON articles(feed_url, is_read)");
+    }
+    if (version < 3) {
+        // Derived from the description by HtmlScanner at ingest
+        ok = ok && exec("ALTER TABLE articles ADD COLUMN snippet TEXT");
+        ok = ok && exec("ALTER TABLE articles ADD COLUMN word_count INTEGER NOT NULL DEFAULT 0");
+        ok = ok && exec("ALTER TABLE articles ADD COLUMN links TEXT");
+        ok = ok && backfillHtmlSummaries();
+    }
+    if (version < 4) {
+        // One row per story holds the body; articles from several feeds point at it
+        ok = ok && exec("CREATE TABLE IF NOT EXISTS stories ("
+                        " id INTEGER PRIMARY KEY,"
+                        " canonical_url TEXT,"
+                        " title_hash INTEGER NOT NULL DEFAULT 0,"
+                        " description TEXT,"
+                        " links TEXT,"
+                        " pub_time INTEGER NOT NULL DEFAULT 0)");
+        ok = ok && exec("CREATE INDEX IF NOT EXISTS idx_stories_url ON stories(canonical_url)");
+        ok = ok && exec("CREATE INDEX IF NOT EXISTS idx_stories_pub ON stories(pub_time)");
+        ok = ok && exec("ALTER TABLE articles ADD COLUMN story_id INTEGER");
+        ok = ok && exec("CREATE INDEX IF NOT EXISTS idx_articles_story ON articles(story_id)");
+        ok = ok && clusterExistingArticles();
+    }
+    if (version < 5) {
+        // Unread counter per feed, counted once here and then kept by triggers
+        ok = ok && exec("ALTER TABLE feeds ADD COLUMN unread INTEGER NOT NULL DEFAULT 0");
+        ok = ok && exec("INSERT OR IGNORE INTO feeds (url) SELECT DISTINCT feed_url FROM articles");
+        ok = ok && exec("UPDATE feeds SET unread ="
+                        " (SELECT COUNT(*) FROM articles WHERE feed_url = feeds.url AND is_read = 0)");
+        ok = ok && exec("CREATE TRIGGER IF NOT EXISTS articles_unread_insert AFTER INSERT ON articles"
+                        " WHEN NEW.is_read = 0 BEGIN"
+                        " INSERT OR IGNORE INTO feeds (url) VALUES (NEW.feed_url);"
+                        " UPDATE feeds SET unread = unread + 1 WHERE url = NEW.feed_url;"
+                        " END");
+        ok = ok && exec("CREATE TRIGGER IF NOT EXISTS articles_unread_delete AFTER DELETE ON articles"
+                        " WHEN OLD.is_read = 0 BEGIN"
+                        " UPDATE feeds SET unread = MAX(unread - 1, 0) WHERE url = OLD.feed_url;"
+                        " END");
+        ok = ok && exec("CREATE TRIGGER IF NOT EXISTS articles_unread_update AFTER UPDATE OF is_read ON articles"
+                        " WHEN (OLD.is_read = 0) <> (NEW.is_read = 0) BEGIN"
+                        " UPDATE feeds SET unread = MAX(unread + CASE WHEN NEW.is_read = 0 THEN 1 ELSE -1 END, 0)"
+                        " WHERE url = NEW.feed_url;"
+                        " END");
+    }
+    if (version < 6) {
+        // Deleted articles leave a tombstone, so a refresh does not bring
+        // back what retention has just removed
+        ok = ok && exec("CREATE TABLE IF NOT EXISTS evicted_guids ("
+                        " feed_url TEXT NOT NULL,"
+                        " guid TEXT NOT NULL,"
+                        " evicted_at INTEGER NOT NULL,"
+                        " PRIMARY KEY (feed_url, guid)) WITHOUT ROWID");
+        ok = ok && exec("CREATE INDEX IF NOT EXISTS idx_evicted_guids_time ON evicted_guids(evicted_at)");
+        ok = ok && exec("CREATE TRIGGER IF NOT EXISTS articles_tombstone AFTER DELETE ON articles BEGIN"
+                        " INSERT OR REPLACE INTO evicted_guids (feed_url, guid, evicted_at)"
+                        " VALUES (OLD.feed_url, OLD.guid, CAST(strftime('%s', 'now') AS INTEGER));"
+                        " END");
+    }
+
+    ok = ok && exec(QString("PRAGMA user_version = %1").arg(SchemaVersion));
+
+    if (!ok || !m_db.commit()) {
+        qWarning() << "Could not migrate article store:" << m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool ArticleStore::backfillHtmlSummaries()
+{
+    QSqlQuery select(m_db);
+    select.setForwardOnly(true);
+    QSqlQuery update(m_db);
+    if (!select.exec("SELECT id, description, image_url FROM articles")
+        || !update.prepare("UPDATE articles SET snippet = ?, word_count = ?, links = ?, image_url = ? WHERE id = ?")) {
+        qWarning() << "Could not backfill article summaries:" << m_db.lastError().text();
+        return false;
+    }
+
+    while (select.next()) {
+        HtmlSummary summary = HtmlScanner::scan(select.value(1).toString());
+        QString imageUrl = select.value(2).toString();
+        update.addBindValue(summary.snippet);
+        update.addBindValue(summary.wordCount);
+        update.addBindValue(summary.links.join('\n'));
+        update.addBindValue(imageUrl.isEmpty() ? summary.imageUrl : imageUrl);
+        update.addBindValue(select.value(0));
+        if (!update.exec()) {
+            qWarning() << "Could not backfill article summaries:" << update.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ArticleStore::clusterExistingArticles()
+{
+    if (!prepareStoryStatements()) {
+        return false;
+    }
+    m_storyIndex.clear();
+    m_storyIndexLoaded = true;
+
+    QSqlQuery select(m_db);
+    select.setForwardOnly(true);
+    QSqlQuery update(m_db);
+    if (!select.exec("SELECT id, title, link, description, links, pub_time, fetch_time FROM articles ORDER BY id")
+        || !update.prepare("UPDATE articles SET story_id = ?, description = NULL, links = NULL WHERE id = ?")) {
+        qWarning() << "Could not cluster stored articles:" << m_db.lastError().text();
+        return false;
+    }
+
+    while (select.next()) {
+        FeedItem item;
+        item.title = select.value(1).toString();
+        item.setLink(select.value(2).toString());
+        item.setDescription(select.value(3).toString());
+        QString links = select.value(4).toString();
+        item.setLinks(links.isEmpty() ? QStringList() : links.split('\n'));
+        item.pubTime = select.value(5).toLongLong();
+        item.fetchTime = select.value(6).toLongLong();
+
+        qint64 storyId = assignStory(item);
+        if (storyId == 0) {
+            return false;
+        }
+        update.addBindValue(storyId);
+        update.addBindValue(select.value(0));
+        if (!update.exec()) {
+            qWarning() << "Could not cluster stored articles:" << update.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ArticleStore::prepareStoryStatements()
+{
+    m_findStory = QSqlQuery(m_db);
+    m_insertStory = QSqlQuery(m_db);
+    m_fillStory = QSqlQuery(m_db);
+    m_pruneStories = QSqlQuery(m_db);
+
+    bool ok = m_findStory.prepare("SELECT id FROM stories WHERE canonical_url = ? ORDER BY id DESC LIMIT 1");
+    ok = ok && m_insertStory.prepare(
+        "INSERT INTO stories (canonical_url, title_hash, description, links, pub_time) VALUES (?, ?, ?, ?, ?)");
+    ok = ok && m_fillStory.prepare(
+        "UPDATE stories SET description = ?, links = ? WHERE id = ? AND IFNULL(description, '') = ''");
+    ok = ok && m_pruneStories.prepare(
+        "DELETE FROM stories WHERE NOT EXISTS (SELECT 1 FROM articles WHERE articles.story_id = stories.id)");
+
+    if (!ok) {
+        qWarning() << "Could not prepare story statements:" << m_db.lastError().text();
+    }
+    return ok;
+}
+
+qint64 ArticleStore::assignStory(const FeedItem &item)
+{
+    const QString canonicalUrl = item.hasLink() ? StoryKey::canonicalUrl(item.link()) : QString();
+    const quint64 signature = StoryKey::titleSignature(item.title);
+    const qint64 time = item.ageTime();
+
+    // Same canonical URL first, then a near-identical title from the same days
+    qint64 storyId = 0;
+    if (!canonicalUrl.isEmpty()) {
+        m_findStory.addBindValue(canonicalUrl);
+        if (m_findStory.exec() && m_findStory.next()) {
+            storyId = m_findStory.value(0).toLongLong();
+        }
+        m_findStory.finish();
+    }
+    if (storyId == 0 && signature != 0) {
+        loadStoryIndex();
+        storyId = m_storyIndex.find(signature, time);
+    }
+
+    if (storyId != 0) {
+        // The first copy may have come from a feed without a body
+        if (!item.descriptionUtf8().isEmpty()) {
+            m_fillStory.addBindValue(item.description());
+            m_fillStory.addBindValue(item.links().join('\n'));
+            m_fillStory.addBindValue(storyId);
+            m_fillStory.exec();
+        }
+        return storyId;
+    }
+
+    m_insertStory.addBindValue(canonicalUrl);
+    m_insertStory.addBindValue(qint64(signature)); // SQLite integers are signed
+    m_insertStory.addBindValue(item.description());
+    m_insertStory.addBindValue(item.links().join('\n'));
+    m_insertStory.addBindValue(time);
+    if (!m_insertStory.exec()) {
+        qWarning() << "Could not store story:" << m_insertStory.lastError().text();
+        return 0;
+    }
+
+    storyId = m_insertStory.lastInsertId().toLongLong();
+    m_storyIndex.insert(signature, storyId, time);
+    return storyId;
+}
+
+void ArticleStore::loadStoryIndex()
+{
+    if (m_storyIndexLoaded) {
+        return;
+    }
+    m_storyIndexLoaded = true;
+    m_storyIndex.clear();
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT id, title_hash, pub_time FROM stories WHERE title_hash <> 0 AND pub_time > ? ORDER BY id");
+    query.addBindValue(QDateTime::currentSecsSinceEpoch() - 2 * StoryIndex::WindowSecs);
+    if (!query.exec()) {
+        qWarning() << "Could not load story index:" << query.lastError().text();
+        return;
+    }
+    while (query.next()) {
+        m_storyIndex.insert(quint64(query.value(1).toLongLong()), query.value(0).toLongLong(),
+                            query.value(2).toLongLong());
+    }
+}
+
+bool ArticleStore::prepareStatements()
+{
+    m_insertItem = QSqlQuery(m_db);
+    m_attachStory = QSqlQuery(m_db);
+    m_selectItems = QSqlQuery(m_db);
+    m_selectRecentItems = QSqlQuery(m_db);
+    m_selectOlderItems = QSqlQuery(m_db);
+    m_containsItem = QSqlQuery(m_db);
+    m_selectArticle = QSqlQuery(m_db);
+    m_selectDescription = QSqlQuery(m_db);
+    m_selectSources = QSqlQuery(m_db);
+    m_selectStoryArticles = QSqlQuery(m_db);
+    m_searchItems = QSqlQuery(m_db);
+    m_searchCandidates = QSqlQuery(m_db);
+    m_pruneAge = QSqlQuery(m_db);
+    m_pruneCount = QSqlQuery(m_db);
+    m_pruneOldest = QSqlQuery(m_db);
+    m_pruneTombstones = QSqlQuery(m_db);
+    m_selectEvicted = QSqlQuery(m_db);
+    m_clearEvicted = QSqlQuery(m_db);
+    m_updateRead = QSqlQuery(m_db);
+    m_countItems = QSqlQuery(m_db);
+    m_selectUnread = QSqlQuery(m_db);
+    m_selectMeta = QSqlQuery(m_db);
+    m_ensureFeed = QSqlQuery(m_db);
+    m_updateValidators = QSqlQuery(m_db);
+    m_updateLastUpdate = QSqlQuery(m_db);
+
+    // Rows are only ever appended, then attached to their story by m_attachStory;
+    // read state changes go through m_updateRead.
+    // Bodies live in the story row and are paged in with m_selectDescription.
+    bool ok = prepareStoryStatements();
+    ok = ok && m_insertItem.prepare(
+        "INSERT OR IGNORE INTO articles"
+        " (feed_url, guid, title, link, pub_date, pub_time, image_url, category, is_read, fetch_time,"
+        "  snippet, word_count)"
+        " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    ok = ok && m_attachStory.prepare("UPDATE articles SET story_id = ? WHERE id = ?");
+    ok = ok && m_selectItems.prepare(
+        "SELECT guid, title, link, pub_date, image_url, category, is_read, fetch_time, pub_time, snippet, word_count"
+        " FROM articles WHERE feed_url = ? ORDER BY id");
+    ok = ok && m_selectRecentItems.prepare(
+        "SELECT guid, title, link, pub_date, image_url, category, is_read, fetch_time, pub_time, snippet, word_count, id"
+        " FROM articles WHERE feed_url = ? ORDER BY pub_time DESC, id DESC LIMIT ?");
+    ok = ok && m_selectArticle.prepare(
+        "SELECT guid, title, link, pub_date, image_url, category, is_read, fetch_time, pub_time, snippet, word_count"
+        " FROM articles WHERE feed_url = ? AND guid = ?");
+    // Keyset paging over idx_articles_feed_pub, no OFFSET scan
+    ok = ok && m_selectOlderItems.prepare(
+        "SELECT guid, title, link, pub_date, image_url, category, is_read, fetch_time, pub_time, snippet, word_count, id"
+        " FROM articles WHERE feed_url = ? AND (pub_time < ? OR (pub_time = ? AND id < ?))"
+        " ORDER BY pub_time DESC, id DESC LIMIT ?");
+    ok = ok && m_containsItem.prepare(
+        "SELECT 1 FROM articles WHERE feed_url = ? AND guid = ?"
+        " UNION ALL SELECT 1 FROM evicted_guids WHERE feed_url = ? AND guid = ? LIMIT 1");
+    ok = ok && m_selectDescription.prepare(
+        "SELECT s.description FROM articles a JOIN stories s ON s.id = a.story_id"
+        " WHERE a.feed_url = ? AND a.guid = ?");
+    ok = ok && m_selectSources.prepare(
+        "SELECT DISTINCT o.feed_url FROM articles a JOIN articles o ON o.story_id = a.story_id"
+        " WHERE a.feed_url = ? AND a.guid = ?");
+    ok = ok && m_selectStoryArticles.prepare(
+        "SELECT o.feed_url, o.guid FROM articles a JOIN articles o ON o.story_id = a.story_id"
+        " WHERE a.feed_url = ? AND a.guid = ?");
+    ok = ok && m_searchItems.prepare(
+        "SELECT a.guid FROM articles a LEFT JOIN stories s ON s.id = a.story_id WHERE a.feed_url = ?"
+        " AND (a.title LIKE ? ESCAPE '\\' OR s.description LIKE ? ESCAPE '\\' OR a.category LIKE ? ESCAPE '\\')");
+    // Non-ASCII text is matched again on the columns, see likePattern()
+    ok = ok && m_searchCandidates.prepare(
+        "SELECT a.guid, a.title, s.description, a.category FROM articles a LEFT JOIN stories s ON s.id = a.story_id"
+        " WHERE a.feed_url = ?"
+        " AND (a.title LIKE ? ESCAPE '\\' OR s.description LIKE ? ESCAPE '\\' OR a.category LIKE ? ESCAPE '\\')");
+    ok = ok && m_pruneAge.prepare(
+        "DELETE FROM articles WHERE feed_url = ?"
+        " AND ((pub_time > 0 AND pub_time < ?) OR (pub_time = 0 AND fetch_time < ?))");
+    ok = ok && m_pruneCount.prepare(
+        "DELETE FROM articles WHERE id IN"
+        " (SELECT id FROM articles WHERE feed_url = ? ORDER BY pub_time DESC, id DESC LIMIT -1 OFFSET ?)");
+    ok = ok && m_pruneOldest.prepare(
+        "DELETE FROM articles WHERE id IN (SELECT id FROM articles ORDER BY id LIMIT ?)");
+    ok = ok && m_pruneTombstones.prepare("DELETE FROM evicted_guids WHERE evicted_at < ?");
+    ok = ok && m_selectEvicted.prepare("SELECT feed_url, guid FROM evicted_articles");
+    ok = ok && m_clearEvicted.prepare("DELETE FROM evicted_articles");
+    // Reading a story in one feed reads it everywhere
+    ok = ok && m_updateRead.prepare(
+        "UPDATE articles SET is_read = ? WHERE story_id ="
+        " (SELECT story_id FROM articles WHERE feed_url = ? AND guid = ?)");
+    ok = ok && m_countItems.prepare("SELECT COUNT(*) FROM articles WHERE feed_url = ?");
+    ok = ok && m_selectUnread.prepare("SELECT url, unread FROM feeds WHERE unread > 0");
+    ok = ok && m_selectMeta.prepare("SELECT etag, last_modified, last_update FROM feeds WHERE url = ?");
+    ok = ok && m_ensureFeed.prepare("INSERT OR IGNORE INTO feeds (url) VALUES (?)");
+    ok = ok && m_updateValidators.prepare("UPDATE feeds SET etag = ?, last_modified = ? WHERE url = ?");
+    ok = ok && m_updateLastUpdate.prepare("UPDATE feeds SET last_update = ? WHERE url = ?");
+
+    if (!ok) {
+        qWarning() << "Could not prepare article store statements:" << m_db.lastError().text();
+    }
+    return ok;
+}
+
+bool ArticleStore::insertItems(const QString &feedUrl, const QList<FeedItem> &items)
+{
+    if (!isOpen() || items.isEmpty()) {
+        return false;
+    }
+
+    if (!m_db.transaction()) {
+        qWarning() << "Could not store articles:" << m_db.lastError().text();
+        return false;
+    }
+
+    for (const FeedItem &item : items) {
+        m_insertItem.addBindValue(feedUrl);
+        m_insertItem.addBindValue(item.guid());
+        m_insertItem.addBindValue(item.title);
+        m_insertItem.addBindValue(item.link());
+        m_insertItem.addBindValue(item.pubDate);
+        m_insertItem.addBindValue(item.pubTime > 0 ? item.pubTime : parsePubTime(item.pubDate));
+        m_insertItem.addBindValue(item.imageUrl());
+        m_insertItem.addBindValue(item.categories().join(QLatin1Char('\n')));
+        m_insertItem.addBindValue(item.isRead ? 1 : 0);
+        m_insertItem.addBindValue(item.fetchTime);
+        m_insertItem.addBindValue(item.snippet());
+        m_insertItem.addBindValue(item.wordCount);
+
+        if (!m_insertItem.exec()) {
+            qWarning() << "Could not store article:" << m_insertItem.lastError().text();
+            m_db.rollback();
+            m_storyIndexLoaded = false; // may name stories that were rolled back
+            return false;
+        }
+
+        // A duplicate must not start a story or fill in the body of one
+        if (m_insertItem.numRowsAffected() <= 0) {
+            continue;
+        }
+        const qint64 articleId = m_insertItem.lastInsertId().toLongLong();
+        const qint64 storyId = assignStory(item);
+        if (storyId == 0) {
+            m_db.rollback();
+            m_storyIndexLoaded = false;
+            return false;
+        }
+        m_attachStory.addBindValue(storyId);
+        m_attachStory.addBindValue(articleId);
+        if (!m_attachStory.exec()) {
+            qWarning() << "Could not store article:" << m_attachStory.lastError().text();
+            m_db.rollback();
+            m_storyIndexLoaded = false;
+            return false;
+        }
+    }
+
+    if (!m_db.commit()) {
+        qWarning() << "Could not store articles:" << m_db.lastError().text();
+        m_db.rollback();
+        m_storyIndexLoaded = false;
+        return false;
+    }
+    return true;
+}
+
+FeedItem ArticleStore::readItem(const QSqlQuery &query) const
+{
+    FeedItem item;
+    item.setGuid(query.value(0).toString());
+    item.title = query.value(1).toString();
+    item.setLink(query.value(2).toString());
+    item.pubDate = query.value(3).toString();
+    item.setImageUrl(query.value(4).toString());
+    // All categories, newline separated; older rows hold a single one
+    item.setCategories(query.value(5).toString().split(QLatin1Char('\n'), QtCompat::SkipEmptyParts));
+    item.isRead = query.value(6).toInt() != 0;
+    item.fetchTime = query.value(7).toLongLong();
+    item.pubTime = query.value(8).toLongLong();
+    item.setSnippet(query.value(9).toString());
+    item.wordCount = query.value(10).toUInt();
+    return item;
+}
+
+QList<FeedItem> ArticleStore::loadItems(const QString &feedUrl, int limit, ItemCursor *cursor)
+{
+    QList<FeedItem> items;
+    if (cursor) {
+        *cursor = ItemCursor();
+    }
+    if (!isOpen()) {
+        return items;
+    }
+
+    // With a limit, take the newest rows and return them in insertion order
+    QSqlQuery &query = limit > 0 ? m_selectRecentItems : m_selectItems;
+    query.addBindValue(feedUrl);
+    if (limit > 0) {
+        query.addBindValue(limit);
+    }
+
+    if (!query.exec()) {
+        qWarning() << "Could not load articles:" << query.lastError().text();
+        return items;
+    }
+
+    quint16 feedId = InternTable::feeds().intern(feedUrl);
+    while (query.next()) {
+        items.append(readItem(query));
+        items.last().feedId = feedId;
+        if (cursor && limit > 0) {
+            cursor->pubTime = query.value(8).toLongLong();
+            cursor->id = query.value(11).toLongLong();
+        }
+    }
+    query.finish();
+
+    if (limit > 0) {
+        if (cursor) {
+            cursor->atEnd = items.size() < limit;
+        }
+        std::reverse(items.begin(), items.end());
+    }
+
+    return items;
+}
+
+QList<FeedItem> ArticleStore::loadItemsBefore(const QString &feedUrl, ItemCursor *cursor, int limit)
+{
+    QList<FeedItem> items;
+    if (!isOpen() || cursor->atEnd) {
+        return items;
+    }
+
+    m_selectOlderItems.addBindValue(feedUrl);
+    m_selectOlderItems.addBindValue(cursor->pubTime);
+    m_selectOlderItems.addBindValue(cursor->pubTime);
+    m_selectOlderItems.addBindValue(cursor->id);
+    m_selectOlderItems.addBindValue(limit);
+    if (!m_selectOlderItems.exec()) {
+        qWarning() << "Could not load articles:" << m_selectOlderItems.lastError().text();
+        return items;
+    }
+
+    quint16 feedId = InternTable::feeds().intern(feedUrl);
+    while (m_selectOlderItems.next()) {
+        items.append(readItem(m_selectOlderItems));
+        items.last().feedId = feedId;
+        cursor->pubTime = m_selectOlderItems.value(8).toLongLong();
+        cursor->id = m_selectOlderItems.value(11).toLongLong();
+    }
+    m_selectOlderItems.finish();
+
+    cursor->atEnd = items.size() < limit;
+    return items;
+}
+
+bool ArticleStore::containsItem(const QString &feedUrl, const QString &guid)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    m_containsItem.addBindValue(feedUrl);
+    m_containsItem.addBindValue(guid);
+    m_containsItem.addBindValue(feedUrl);
+    m_containsItem.addBindValue(guid);
+    bool found = m_containsItem.exec() && m_containsItem.next();
+    m_containsItem.finish();
+    return found;
+}
+
+QString ArticleStore::loadDescription(const QString &feedUrl, const QString &guid)
+{
+    if (!isOpen()) {
+        return QString();
+    }
+
+    m_selectDescription.addBindValue(feedUrl);
+    m_selectDescription.addBindValue(guid);
+    QString description;
+    if (m_selectDescription.exec() && m_selectDescription.next()) {
+        description = m_selectDescription.value(0).toString();
+    }
+    m_selectDescription.finish();
+    return description;
+}
+
+QStringList ArticleStore::storySources(const QString &feedUrl, const QString &guid)
+{
+    QStringList sources;
+    if (!isOpen()) {
+        return sources;
+    }
+
+    m_selectSources.addBindValue(feedUrl);
+    m_selectSources.addBindValue(guid);
+    if (m_selectSources.exec()) {
+        while (m_selectSources.next()) {
+            sources.append(m_selectSources.value(0).toString());
+        }
+    }
+    m_selectSources.finish();
+    return sources;
+}
+
+QList<ArticleKey> ArticleStore::storyArticles(const QString &feedUrl, const QString &guid)
+{
+    QList<ArticleKey> articles;
+    if (!isOpen()) {
+        return articles;
+    }
+
+    m_selectStoryArticles.addBindValue(feedUrl);
+    m_selectStoryArticles.addBindValue(guid);
+    if (m_selectStoryArticles.exec()) {
+        while (m_selectStoryArticles.next()) {
+            ArticleKey key;
+            key.feedUrl = m_selectStoryArticles.value(0).toString();
+            key.guid = m_selectStoryArticles.value(1).toString().toUtf8();
+            articles.append(key);
+        }
+    }
+    m_selectStoryArticles.finish();
+    return articles;
+}
+
+QList<FeedItem> ArticleStore::loadArticles(const QList<ArticleKey> &articles)
+{
+    QList<FeedItem> items;
+    if (!isOpen()) {
+        return items;
+    }
+
+    // One lookup per article over idx_articles_feed_guid
+    for (const ArticleKey &article : articles) {
+        m_selectArticle.addBindValue(article.feedUrl);
+        m_selectArticle.addBindValue(QString::fromUtf8(article.guid));
+        if (m_selectArticle.exec() && m_selectArticle.next()) {
+            items.append(readItem(m_selectArticle));
+            items.last().setFeedUrl(article.feedUrl);
+        }
+        m_selectArticle.finish();
+    }
+    return items;
+}
+
+QString ArticleStore::likePattern(const QString &text)
+{
+    // Substring match. LIKE folds ASCII case only, so any other character
+    // matches as a wildcard and the candidates are checked by matchesText().
+    QString pattern(QLatin1Char('%'));
+    for (int i = 0; i < text.size(); ++i) {
+        const QChar c = text.at(i);
+        if (c == QLatin1Char('\\') || c == QLatin1Char('%') || c == QLatin1Char('_')) {
+            pattern += QLatin1Char('\\');
+            pattern += c;
+        } else if (c.unicode() < 0x80) {
+            pattern += c;
+        } else {
+            // One wildcard per code point, as LIKE counts them
+            if (c.isHighSurrogate() && i + 1 < text.size() && text.at(i + 1).isLowSurrogate()) {
+                ++i;
+            }
+            pattern += QLatin1Char('_');
+        }
+    }
+    pattern += QLatin1Char('%');
+    return pattern;
+}
+
+bool ArticleStore::isAsciiText(const QString &text)
+{
+    for (const QChar c : text) {
+        if (c.unicode() >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ArticleStore::matchesText(const QSqlQuery &query, const QList<int> &columns, const QString &text)
+{
+    for (int column : columns) {
+        if (query.value(column).toString().contains(text, Qt::CaseInsensitive)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QSet<QByteArray> ArticleStore::searchItems(const QString &feedUrl, const QString &text)
+{
+    QSet<QByteArray> guids;
+    if (!isOpen() || text.isEmpty()) {
+        return guids;
+    }
+
+    const QString pattern = likePattern(text);
+    const bool ascii = isAsciiText(text);
+    QSqlQuery &query = ascii ? m_searchItems : m_searchCandidates;
+
+    query.addBindValue(feedUrl);
+    query.addBindValue(pattern);
+    query.addBindValue(pattern);
+    query.addBindValue(pattern);
+    if (!query.exec()) {
+        qWarning() << "Could not search articles:" << query.lastError().text();
+        return guids;
+    }
+
+    while (query.next()) {
+        if (ascii || matchesText(query, { 1, 2, 3 }, text)) {
+            guids.insert(query.value(0).toString().toUtf8());
+        }
+    }
+    query.finish();
+    return guids;
+}
+
+QList<FeedItem> ArticleStore::searchArticles(const QString &feedUrl, const QString &text, int limit)
+{
+    QList<FeedItem> items;
+    if (!isOpen()) {
+        return items;
+    }
+
+    // Candidates of non-ASCII text are matched again, so their limit is applied here
+    const bool ascii = isAsciiText(text);
+
+    // Built per call; saved searches are only rebuilt when they change
+    QString sql = "SELECT a.guid, a.title, a.link, a.pub_date, a.image_url, a.category, a.is_read, a.fetch_time,"
+                  " a.pub_time, a.snippet, a.word_count, a.feed_url";
+    if (!ascii) {
+        sql += ", s.description";
+    }
+    sql += " FROM articles a LEFT JOIN stories s ON s.id = a.story_id WHERE 1";
+    if (!feedUrl.isEmpty()) {
+        sql += " AND a.feed_url = ?";
+    }
+    if (!text.isEmpty()) {
+        sql += " AND (a.title LIKE ? ESCAPE '\\' OR s.description LIKE ? ESCAPE '\\' OR a.category LIKE ? ESCAPE '\\')";
+    }
+    sql += " ORDER BY a.pub_time DESC, a.id DESC";
+    if (ascii) {
+        sql += " LIMIT ?";
+    }
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    if (!feedUrl.isEmpty()) {
+        query.addBindValue(feedUrl);
+    }
+    if (!text.isEmpty()) {
+        const QString pattern = likePattern(text);
+        query.addBindValue(pattern);
+        query.addBindValue(pattern);
+        query.addBindValue(pattern);
+    }
+    if (ascii) {
+        query.addBindValue(limit);
+    }
+    if (!query.exec()) {
+        qWarning() << "Could not search articles:" << query.lastError().text();
+        return items;
+    }
+
+    while ((limit < 0 || items.size() < limit) && query.next()) {
+        if (!ascii && !matchesText(query, { 1, 12, 5 }, text)) {
+            continue;
+        }
+        items.append(readItem(query));
+        items.last().setFeedUrl(query.value(11).toString());
+    }
+    return items;
+}
+
+int ArticleStore::prune(const QString &feedUrl, const RetentionPolicy &policy, QList<ArticleKey> *evicted)
+{
+    if (!isOpen()) {
+        return 0;
+    }
+
+    int removed = 0;
+    if (!m_db.transaction()) {
+        qWarning() << "Could not prune article store:" << m_db.lastError().text();
+        return 0;
+    }
+
+    if (policy.maxAgeDays > 0) {
+        qint64 cutoff = QDateTime::currentDateTime().addDays(-policy.maxAgeDays).toSecsSinceEpoch();
+        m_pruneAge.addBindValue(feedUrl);
+        m_pruneAge.addBindValue(cutoff);
+        m_pruneAge.addBindValue(cutoff);
+        if (m_pruneAge.exec()) {
+            removed += m_pruneAge.numRowsAffected();
+        }
+    }
+
+    if (policy.maxItemsPerFeed > 0) {
+        m_pruneCount.addBindValue(feedUrl);
+        m_pruneCount.addBindValue(policy.maxItemsPerFeed);
+        if (m_pruneCount.exec()) {
+            removed += m_pruneCount.numRowsAffected();
+        }
+    }
+
+    // Tombstones outlive the items in any upstream feed
+    m_pruneTombstones.addBindValue(QDateTime::currentDateTime().addDays(-TombstoneDays).toSecsSinceEpoch());
+    m_pruneTombstones.exec();
+
+    // Stories no feed refers to any more
+    if (removed > 0 && m_pruneStories.exec() && m_pruneStories.numRowsAffected() > 0) {
+        m_storyIndexLoaded = false;
+    }
+
+    if (!m_db.commit()) {
+        qWarning() << "Could not prune article store:" << m_db.lastError().text();
+        m_db.rollback();
+        m_storyIndexLoaded = false;
+        return 0;
+    }
+
+    // Global size cap: drop the oldest rows a batch at a time
+    if (policy.maxTotalBytes > 0) {
+        while (usedBytes() > policy.maxTotalBytes) {
+            m_pruneOldest.addBindValue(PruneBatchSize);
+            if (!m_pruneOldest.exec() || m_pruneOldest.numRowsAffected() <= 0) {
+                break;
+            }
+            removed += m_pruneOldest.numRowsAffected();
+            // The bodies are in the story rows
+            m_pruneStories.exec();
+            m_storyIndexLoaded = false;
+        }
+    }
+
+    if (removed > 0) {
+        // Logged by the articles_evicted trigger
+        if (evicted && m_selectEvicted.exec()) {
+            while (m_selectEvicted.next()) {
+                ArticleKey key;
+                key.feedUrl = m_selectEvicted.value(0).toString();
+                key.guid = m_selectEvicted.value(1).toString().toUtf8();
+                evicted->append(key);
+            }
+            m_selectEvicted.finish();
+        }
+        m_clearEvicted.exec();
+        
+        exec("PRAGMA incremental_vacuum");
+        exec("PRAGMA wal_checkpoint(TRUNCATE)");
+    }
+
+    return removed;
+}
+
+qint64 ArticleStore::usedBytes()
+{
+    if (!isOpen()) {
+        return 0;
+    }
+    return (pragmaValue("page_count") - pragmaValue("freelist_count")) * pragmaValue("page_size");
+}
+
+QList<QByteArray> ArticleStore::sampleDescriptions(int limit)
+{
+    QList<QByteArray> descriptions;
+    if (!isOpen()) {
+        return descriptions;
+    }
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT description FROM stories WHERE description <> '' ORDER BY id DESC LIMIT ?");
+    query.addBindValue(limit);
+    if (query.exec()) {
+        while (query.next()) {
+            descriptions.append(query.value(0).toString().toUtf8());
+        }
+    }
+    return descriptions;
+}
+
+qint64 ArticleStore::fileBytes() const
+{
+    QString path = m_db.databaseName();
+    return QFileInfo(path).size() + QFileInfo(path + "-wal").size();
+}
+
+bool ArticleStore::setRead(const QString &feedUrl, const QString &guid, bool read)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    m_updateRead.addBindValue(read ? 1 : 0);
+    m_updateRead.addBindValue(feedUrl);
+    m_updateRead.addBindValue(guid);
+    return m_updateRead.exec();
+}
+
+bool ArticleStore::setRead(const QList<ArticleKey> &articles, bool read)
+{
+    if (!isOpen() || articles.isEmpty()) {
+        return false;
+    }
+
+    if (!m_db.transaction()) {
+        qWarning() << "Could not update read state:" << m_db.lastError().text();
+        return false;
+    }
+
+    for (const ArticleKey &article : articles) {
+        m_updateRead.addBindValue(read ? 1 : 0);
+        m_updateRead.addBindValue(article.feedUrl);
+        m_updateRead.addBindValue(QString::fromUtf8(article.guid));
+        if (!m_updateRead.exec()) {
+            qWarning() << "Could not update read state:" << m_updateRead.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+    }
+
+    if (!m_db.commit()) {
+        qWarning() << "Could not update read state:" << m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    return true;
+}
+
+int ArticleStore::itemCount(const QString &feedUrl)
+{
+    if (!isOpen()) {
+        return 0;
+    }
+
+    int count = 0;
+    m_countItems.addBindValue(feedUrl);
+    if (m_countItems.exec() && m_countItems.next()) {
+        count = m_countItems.value(0).toInt();
+    }
+    m_countItems.finish();
+    return count;
+}
+
+QHash<QString, int> ArticleStore::unreadCounts()
+{
+    QHash<QString, int> counts;
+    if (!isOpen()) {
+        return counts;
+    }
+
+    if (m_selectUnread.exec()) {
+        while (m_selectUnread.next()) {
+            counts.insert(m_selectUnread.value(0).toString(), m_selectUnread.value(1).toInt());
+        }
+    }
+    m_selectUnread.finish();
+    return counts;
+}
+
+void ArticleStore::ensureFeed(const QString &feedUrl)
+{
+    m_ensureFeed.addBindValue(feedUrl);
+    m_ensureFeed.exec();
+}
+
+FeedMeta ArticleStore::feedMeta(const QString &feedUrl)
+{
+    FeedMeta meta;
+    if (!isOpen()) {
+        return meta;
+    }
+
+    m_selectMeta.addBindValue(feedUrl);
+    if (m_selectMeta.exec() && m_selectMeta.next()) {
+        meta.etag = m_selectMeta.value(0).toString();
+        meta.lastModified = m_selectMeta.value(1).toString();
+        if (!m_selectMeta.value(2).isNull()) {
+            meta.lastUpdate = QDateTime::fromSecsSinceEpoch(m_selectMeta.value(2).toLongLong());
+        }
+    }
+    m_selectMeta.finish();
+    return meta;
+}
+
+void ArticleStore::setValidators(const QString &feedUrl, const QString &etag, const QString &lastModified)
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    ensureFeed(feedUrl);
+    m_updateValidators.addBindValue(etag);
+    m_updateValidators.addBindValue(lastModified);
+    m_updateValidators.addBindValue(feedUrl);
+    m_updateValidators.exec();
+}
+
+void ArticleStore::setLastUpdate(const QString &feedUrl, const QDateTime &when)
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    ensureFeed(feedUrl);
+    m_updateLastUpdate.addBindValue(when.toSecsSinceEpoch());
+    m_updateLastUpdate.addBindValue(feedUrl);
+    m_updateLastUpdate.exec();
+}
+
+bool ArticleStore::importLegacyCache(const QString &feedUrl, const QString &jsonPath)
+{
+    QFile file(jsonPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    QList<FeedItem> items;
+    for (const QJsonValue &value : doc.array()) {
+        QJsonObject obj = value.toObject();
+        FeedItem item;
+        item.title = obj["title"].toString();
+        item.setLink(obj["link"].toString());
+        item.setDescription(obj["description"].toString());
+        item.pubDate = obj["pubDate"].toString();
+        item.setImageUrl(obj["imageUrl"].toString());
+        item.addCategory(obj["category"].toString());
+        item.setGuid(obj["guid"].toString());
+        item.isRead = obj["isRead"].toBool();
+
+        QDateTime fetched = QDateTime::fromString(obj["fetchTime"].toString(), Qt::ISODate);
+        item.fetchTime = fetched.isValid() ? fetched.toSecsSinceEpoch() : QDateTime::currentSecsSinceEpoch();
+
+        if (!item.guidKey().isEmpty()) {
+            items.append(item);
+        }
+    }
+
+    if (!items.isEmpty() && !insertItems(feedUrl, items)) {
+        return false;
+    }
+
+    // Move the validators out of QSettings as well
+    QSettings settings;
+    QString etagKey = "etag_" + feedUrl;
+    QString lastModifiedKey = "lastModified_" + feedUrl;
+    QString lastUpdateKey = "lastCacheUpdate_" + feedUrl;
+
+    if (settings.contains(etagKey) || settings.contains(lastModifiedKey)) {
+        setValidators(feedUrl, settings.value(etagKey).toString(), settings.value(lastModifiedKey).toString());
+    }
+    if (settings.contains(lastUpdateKey)) {
+        setLastUpdate(feedUrl, QDateTime::fromString(settings.value(lastUpdateKey).toString(), Qt::ISODate));
+    }
+
+    settings.remove(etagKey);
+    settings.remove(lastModifiedKey);
+    settings.remove(lastUpdateKey);
+
+    QFile::remove(jsonPath);
+    return true;
+}
+
+bool ArticleStore::clear()
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    if (!m_db.transaction()) {
+        qWarning() << "Could not clear article store:" << m_db.lastError().text();
+        return false;
+    }
+    bool ok = exec("DELETE FROM articles");
+    ok = ok && exec("DELETE FROM stories");
+    ok = ok && exec("DELETE FROM feeds");
+    ok = ok && exec("DELETE FROM evicted_guids"); // a cleared cache starts over
+    ok = ok && exec("DELETE FROM evicted_articles");
+    if (!ok || !m_db.commit()) {
+        qWarning() << "Could not clear article store:" << m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    m_storyIndex.clear();
+    return true;
+}
+
+qint64 ArticleStore::parsePubTime(const QString &pubDate)
+{
+    QDateTime dateTime = QDateTime::fromString(pubDate.trimmed(), Qt::RFC2822Date);
+    if (!dateTime.isValid()) {
+        dateTime = QDateTime::fromString(pubDate.trimmed(), Qt::ISODate);
+    }
+    return dateTime.isValid() ? dateTime.toSecsSinceEpoch() : 0;
+}
\ No newline at end of file
@@ -0,0 +1,189 @@
+#ifndef ARTICLESTORE_H
+#define ARTICLESTORE_H
+
+#include <QString>
+#include <QList>
+#include <QSet>
+#include <QHash>
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include <limits>
+
+#include "feeditem.h"
+#include "storycluster.h"
+
+// Per-feed HTTP validators and refresh bookkeeping
+struct FeedMeta {
+    QString etag;
+    QString lastModified;
+    QDateTime lastUpdate;
+};
+
+// Limits applied to stored and resident items
+struct RetentionPolicy {
+    int maxAgeDays = 90;                      // 0 keeps items forever
+    int maxItemsPerFeed = 500;                // 0 means no limit
+    qint64 maxTotalBytes = 200 * 1024 * 1024; // 0 means no limit
+
+    bool operator==(const RetentionPolicy &other) const
+    {
+        return maxAgeDays == other.maxAgeDays && maxItemsPerFeed == other.maxItemsPerFeed
+            && maxTotalBytes == other.maxTotalBytes;
+    }
+    bool operator!=(const RetentionPolicy &other) const { return !(*this == other); }
+};
+
+// Identity of one stored article
+struct ArticleKey {
+    QString feedUrl;
+    QByteArray guid;
+};
+
+// Position in a feed's items ordered newest first, for keyset paging
+struct ItemCursor {
+    qint64 pubTime = std::numeric_limits<qint64>::max();
+    qint64 id = std::numeric_limits<qint64>::max();
+    bool atEnd = true;
+};
+
+// Local SQLite article database (WAL mode) holding every feed's items,
+// read state and HTTP validators. Statements are prepared once on open
+// and batch writes run in a single transaction.
+//
+// Articles that several feeds publish share one story row, found by
+// canonical URL or a near-identical title, which holds the body once.
+class ArticleStore
+{
+public:
+    ArticleStore();
+    ~ArticleStore();
+
+    bool open(const QString &path = defaultPath());
+    bool isOpen() const { return m_db.isOpen(); }
+    static QString defaultPath();
+
+    // Articles
+    bool insertItems(const QString &feedUrl, const QList<FeedItem> &items);
+    // With a limit, the newest rows in insertion order; cursor then points past the oldest
+    QList<FeedItem> loadItems(const QString &feedUrl, int limit = 0, ItemCursor *cursor = nullptr);
+    // The next rows older than the cursor, newest first
+    QList<FeedItem> loadItemsBefore(const QString &feedUrl, ItemCursor *cursor, int limit);
+    // Stored items and items evicted by retention within TombstoneDays, so
+    // an evicted item still listed upstream does not come back as new
+    bool containsItem(const QString &feedUrl, const QString &guid);
+    
+    // Rows of the given articles, in the same order, skipping any no longer stored
+    QList<FeedItem> loadArticles(const QList<ArticleKey> &articles);
+    
+    // Item rows are loaded without their description; bodies are paged in here
+    QString loadDescription(const QString &feedUrl, const QString &guid);
+    
+    // Feeds that carry the same story as this item, the item's own included
+    QStringList storySources(const QString &feedUrl, const QString &guid);
+    
+    // Articles of the same story, which share their read state
+    QList<ArticleKey> storyArticles(const QString &feedUrl, const QString &guid);
+    
+    // GUIDs of items whose title, description or category contains the text
+    QSet<QByteArray> searchItems(const QString &feedUrl, const QString &text);
+    
+    // Items of one feed, or of every feed when the URL is empty, whose title,
+    // description or category contains the text; newest first, no bodies.
+    // An empty text matches every item; a negative limit means no limit.
+    QList<FeedItem> searchArticles(const QString &feedUrl, const QString &text, int limit = -1);
+    bool setRead(const QString &feedUrl, const QString &guid, bool read = true);
+    // Many articles in one transaction, with their stories
+    bool setRead(const QList<ArticleKey> &articles, bool read = true);
+    int itemCount(const QString &feedUrl);
+    
+    // Unread articles per feed URL, feeds without any left out. Triggers keep
+    // the per-feed counters current on insert, read changes and deletes, so
+    // this reads one row per feed and never counts articles.
+    QHash<QString, int> unreadCounts();
+    
+    // Apply the policy to one feed, plus the global size cap. Returns rows
+    // removed; evicted receives every removed article, of any feed.
+    int prune(const QString &feedUrl, const RetentionPolicy &policy, QList<ArticleKey> *evicted = nullptr);
+    
+    // Stored story bodies, newest first, for benchmarking the scanners
+    QList<QByteArray> sampleDescriptions(int limit);
+    
+    // Bytes in use inside the database and on disk (including the WAL)
+    qint64 usedBytes();
+    qint64 fileBytes() const;
+
+    // Feed metadata
+    FeedMeta feedMeta(const QString &feedUrl);
+    void setValidators(const QString &feedUrl, const QString &etag, const QString &lastModified);
+    void setLastUpdate(const QString &feedUrl, const QDateTime &when);
+
+    // Import a per-feed JSON cache file and its QSettings keys, then remove them
+    bool importLegacyCache(const QString &feedUrl, const QString &jsonPath);
+
+    // Removes every article, story, feed and tombstone; false leaves them all
+    bool clear();
+
+    // Publish time in seconds since epoch, 0 if the date cannot be parsed
+    static qint64 parsePubTime(const QString &pubDate);
+
+private:
+    static const int SchemaVersion = 6;
+    static const int PruneBatchSize = 200;
+    static const int TombstoneDays = 90; // longer than feeds list an item
+
+    QString m_connectionName;
+    QSqlDatabase m_db;
+
+    QSqlQuery m_insertItem;
+    QSqlQuery m_attachStory;
+    QSqlQuery m_selectItems;
+    QSqlQuery m_selectRecentItems;
+    QSqlQuery m_selectOlderItems;
+    QSqlQuery m_containsItem;
+    QSqlQuery m_selectArticle;
+    QSqlQuery m_selectDescription;
+    QSqlQuery m_selectSources;
+    QSqlQuery m_selectStoryArticles;
+    QSqlQuery m_findStory;
+    QSqlQuery m_insertStory;
+    QSqlQuery m_fillStory;
+    QSqlQuery m_pruneStories;
+    QSqlQuery m_searchItems;
+    QSqlQuery m_searchCandidates;
+    QSqlQuery m_pruneAge;
+    QSqlQuery m_pruneCount;
+    QSqlQuery m_pruneOldest;
+    QSqlQuery m_pruneTombstones;
+    QSqlQuery m_selectEvicted;
+    QSqlQuery m_clearEvicted;
+    QSqlQuery m_updateRead;
+    QSqlQuery m_countItems;
+    QSqlQuery m_selectUnread;
+    QSqlQuery m_selectMeta;
+    QSqlQuery m_ensureFeed;
+    QSqlQuery m_updateValidators;
+    QSqlQuery m_updateLastUpdate;
+    
+    StoryIndex m_storyIndex;
+    bool m_storyIndexLoaded = false;
+
+    bool exec(const QString &sql);
+    static QString likePattern(const QString &text);
+    static bool isAsciiText(const QString &text);
+    static bool matchesText(const QSqlQuery &query, const QList<int> &columns, const QString &text);
+    qint64 pragmaValue(const QString &pragma);
+    FeedItem readItem(const QSqlQuery &query) const;
+    bool migrate();
+    bool createEvictionLog();
+    bool backfillHtmlSummaries();
+    bool clusterExistingArticles();
+    bool prepareStatements();
+    bool prepareStoryStatements();
+    qint64 assignStory(const FeedItem &item);
+    void loadStoryIndex();
+    void ensureFeed(const QString &feedUrl);
+};
+
+#endif // ARTICLESTORE_H
\ No newline at end of file
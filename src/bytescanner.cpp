@@ -0,0 +1,170 @@
+#include "bytescanner.h"
+
+#include <QtAlgorithms>
+
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BYTESCANNER_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 is compiled per function and only called after a CPU check
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BYTESCANNER_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const char *findScalar(const char *p, const char *end, char a, char b, char c, char d)
+{
+    for (; p < end; ++p) {
+        char x = *p;
+        if (x == a || x == b || x == c || x == d) {
+            return p;
+        }
+    }
+    return end;
+}
+
+#ifdef BYTESCANNER_SSE2
+const char *findSse2(const char *p, const char *end, char a, char b, char c, char d)
+{
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    const __m128i vd = _mm_set1_epi8(d);
+
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)),
+                                    _mm_or_si128(_mm_cmpeq_epi8(chunk, vc), _mm_cmpeq_epi8(chunk, vd)));
+        quint32 mask = quint32(_mm_movemask_epi8(hits));
+        if (mask) {
+            return p + qCountTrailingZeroBits(mask);
+        }
+        p += 16;
+    }
+    return findScalar(p, end, a, b, c, d);
+}
+#endif
+
+#ifdef BYTESCANNER_AVX2
+__attribute__((target("avx2")))
+const char *findAvx2(const char *p, const char *end, char a, char b, char c, char d)
+{
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    const __m256i vc = _mm256_set1_epi8(c);
+    const __m256i vd = _mm256_set1_epi8(d);
+
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb)),
+                                       _mm256_or_si256(_mm256_cmpeq_epi8(chunk, vc), _mm256_cmpeq_epi8(chunk, vd)));
+        quint32 mask = quint32(_mm256_movemask_epi8(hits));
+        if (mask) {
+            return p + qCountTrailingZeroBits(mask);
+        }
+        p += 32;
+    }
+    return findScalar(p, end, a, b, c, d);
+}
+#endif
+
+std::atomic<int> &activeKernel()
+{
+    static std::atomic<int> kernel(ByteScanner::bestKernel());
+    return kernel;
+}
+
+} // namespace
+
+const char *ByteScanner::findFirstOf(const char *p, const char *end, char a, char b)
+{
+    return findFirstOf(p, end, a, b, a, b);
+}
+
+const char *ByteScanner::findFirstOf(const char *p, const char *end, char a, char b, char c)
+{
+    return findFirstOf(p, end, a, b, c, c);
+}
+
+const char *ByteScanner::findFirstOf(const char *p, const char *end, char a, char b, char c, char d)
+{
+    // Short runs are cheaper without the vector setup
+    if (end - p < 16) {
+        return findScalar(p, end, a, b, c, d);
+    }
+
+    switch (activeKernel().load(std::memory_order_relaxed)) {
+#ifdef BYTESCANNER_AVX2
+    case Avx2:
+        return findAvx2(p, end, a, b, c, d);
+#endif
+#ifdef BYTESCANNER_SSE2
+    case Sse2:
+        return findSse2(p, end, a, b, c, d);
+#endif
+    default:
+        return findScalar(p, end, a, b, c, d);
+    }
+}
+
+bool ByteScanner::isSupported(Kernel kernel)
+{
+    switch (kernel) {
+    case Scalar:
+        return true;
+    case Sse2:
+#ifdef BYTESCANNER_SSE2
+        return true;
+#else
+        return false;
+#endif
+    case Avx2:
+#ifdef BYTESCANNER_AVX2
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+ByteScanner::Kernel ByteScanner::bestKernel()
+{
+    if (isSupported(Avx2)) {
+        return Avx2;
+    }
+    if (isSupported(Sse2)) {
+        return Sse2;
+    }
+    return Scalar;
+}
+
+ByteScanner::Kernel ByteScanner::kernel()
+{
+    return Kernel(activeKernel().load(std::memory_order_relaxed));
+}
+
+void ByteScanner::setKernel(Kernel kernel)
+{
+    if (isSupported(kernel)) {
+        activeKernel().store(kernel, std::memory_order_relaxed);
+    }
+}
+
+QString ByteScanner::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Scalar:
+        return QStringLiteral("scalar");
+    case Sse2:
+        return QStringLiteral("SSE2");
+    case Avx2:
+        return QStringLiteral("AVX2");
+    }
+    return QString();
+}
\ No newline at end of file
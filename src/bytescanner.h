@@ -0,0 +1,32 @@
+#ifndef BYTESCANNER_H
+#define BYTESCANNER_H
+
+#include <QString>
+
+// Finds the first of a few byte values in a UTF-8 buffer. The kernel is
+// picked at runtime from what the CPU supports: AVX2, SSE2 or a portable
+// scalar loop, so the same binary runs everywhere.
+class ByteScanner
+{
+public:
+    enum Kernel {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    // First byte equal to one of the needles, or end if there is none
+    static const char *findFirstOf(const char *p, const char *end, char a, char b);
+    static const char *findFirstOf(const char *p, const char *end, char a, char b, char c);
+    static const char *findFirstOf(const char *p, const char *end, char a, char b, char c, char d);
+
+    // The active kernel; setKernel is meant for benchmarks and ignores
+    // kernels the CPU cannot run
+    static Kernel kernel();
+    static void setKernel(Kernel kernel);
+    static bool isSupported(Kernel kernel);
+    static Kernel bestKernel();
+    static QString kernelName(Kernel kernel);
+};
+
+#endif // BYTESCANNER_H
\ No newline at end of file
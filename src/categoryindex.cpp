@@ -0,0 +1,101 @@
+#include "categoryindex.h"
+#include "feeditem.h"
+
+namespace {
+
+struct Series {
+    const char *name;
+    QStringList aliases;
+};
+
+// Same groups as the category logos
+const QVector<Series> &seriesTable()
+{
+    static const QVector<Series> table = {
+        { "Formula 1", { "F1", "Formula1", "Formula One" } },
+        { "MotoGP", { "Moto GP" } },
+        { "WRC", { "World Rally Championship", "Rally" } },
+        { "NASCAR", { "NASCAR Cup" } },
+        { "IndyCar", { "Indy Car", "IndyCar Series" } },
+        { "WEC", { "World Endurance Championship", "Endurance", "Le Mans" } },
+        { "Formula E", { "FormulaE" } },
+        { "DTM", { "Touring Car" } },
+        { "Super GT", {} },
+        { "IMSA", {} },
+        { "Super Formula", {} }
+    };
+    return table;
+}
+
+} // namespace
+
+CategoryIndex::CategoryIndex()
+    : m_nextBit(0)
+{
+    for (const Series &series : seriesTable()) {
+        quint16 id = registerName(QString::fromLatin1(series.name));
+        for (const QString &alias : series.aliases) {
+            m_folded.insert(fold(alias), id);
+        }
+        bit(id);
+    }
+}
+
+CategoryIndex &CategoryIndex::instance()
+{
+    static CategoryIndex index;
+    return index;
+}
+
+quint16 CategoryIndex::normalize(const QString &name)
+{
+    return normalize(QStringRef(&name));
+}
+
+quint16 CategoryIndex::normalize(const QStringRef &name)
+{
+    const QStringRef trimmed = name.trimmed();
+    if (trimmed.isEmpty()) {
+        return 0;
+    }
+    
+    // Feeds repeat their spellings, so the exact lookup borrows the buffer
+    const QString key = QString::fromRawData(trimmed.unicode(), trimmed.size());
+    auto it = m_spellings.constFind(key);
+    if (it != m_spellings.constEnd()) {
+        return it.value();
+    }
+    
+    const QString spelling = trimmed.toString();
+    quint16 id = m_folded.value(fold(spelling));
+    if (id == 0) {
+        id = registerName(spelling.simplified());
+    }
+    m_spellings.insert(spelling, id);
+    return id;
+}
+
+quint16 CategoryIndex::find(const QString &name) const
+{
+    return m_folded.value(fold(name));
+}
+
+int CategoryIndex::bit(quint16 id)
+{
+    // IDs come from the shared intern table, so the vector is sparse
+    if (id >= m_bits.size()) {
+        m_bits.insert(m_bits.size(), id + 1 - m_bits.size(), qint8(-1));
+    }
+    qint8 &bit = m_bits[id];
+    if (bit < 0) {
+        bit = qint8(m_nextBit < OverflowBit ? m_nextBit++ : OverflowBit);
+    }
+    return bit;
+}
+
+quint16 CategoryIndex::registerName(const QString &name)
+{
+    quint16 id = InternTable::categories().intern(name);
+    m_folded.insert(fold(name), id);
+    return id;
+}
\ No newline at end of file
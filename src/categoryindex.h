@@ -0,0 +1,44 @@
+#ifndef CATEGORYINDEX_H
+#define CATEGORYINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+// Normalizes item categories and gives each distinct one a bit in a 64-bit
+// mask. Spellings are folded case-insensitively and series aliases ("F1",
+// "Formula One") map to one canonical name, interned in
+// InternTable::categories(). The series get fixed bits; other categories
+// take bits in order of appearance, and past 63 they share OverflowBit.
+// Used from the GUI thread only.
+class CategoryIndex
+{
+public:
+    static const int OverflowBit = 63;
+
+    static CategoryIndex &instance();
+
+    // Interned ID of the canonical name, registering it if new; 0 if empty
+    quint16 normalize(const QString &name);
+    quint16 normalize(const QStringRef &name);
+
+    // Interned ID of the canonical name without registering it; 0 if unknown
+    quint16 find(const QString &name) const;
+
+    int bit(quint16 id);
+    quint64 mask(quint16 id) { return id == 0 ? 0 : quint64(1) << bit(id); }
+
+private:
+    CategoryIndex();
+
+    QHash<QString, quint16> m_spellings; // exact spelling seen -> ID
+    QHash<QString, quint16> m_folded;    // lower-cased, simplified name or alias -> ID
+    QVector<qint8> m_bits;               // ID -> bit, -1 if not assigned yet
+    int m_nextBit;
+
+    static QString fold(const QString &name) { return name.simplified().toLower(); }
+    quint16 registerName(const QString &name);
+};
+
+#endif // CATEGORYINDEX_H
\ No newline at end of file
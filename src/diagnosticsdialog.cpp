@@ -0,0 +1,460 @@
+#include "diagnosticsdialog.h"
+#include "feedmetrics.h"
+#include "stallwatchdog.h"
+#include "rssparser.h"
+#include "bytescanner.h"
+#include "htmlscanner.h"
+#include "newsfeedwidget.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QFileDialog>
+#include <QFile>
+#include <QDir>
+#include <QMessageBox>
+#include <QLocale>
+#include <QElapsedTimer>
+#include <QApplication>
+
+#include <algorithm>
+
+DiagnosticsDialog::DiagnosticsDialog(StallWatchdog *watchdog, RssParser *parser, NewsFeedWidget *feedWidget,
+                                     QWidget *parent)
+    : QDialog(parent),
+      m_watchdog(watchdog),
+      m_parser(parser),
+      m_feedWidget(feedWidget)
+{
+    setupUi();
+    setWindowTitle(tr("Diagnostics"));
+    resize(760, 480);
+    refresh();
+}
+
+void DiagnosticsDialog::setupUi()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    m_tabs = new QTabWidget(this);
+    m_tabs->addTab(createMetricsTab(), tr("Metrics"));
+    m_tabs->addTab(createStallsTab(), tr("Stalls"));
+    m_tabs->addTab(createMemoryTab(), tr("Memory"));
+    m_tabs->addTab(createScannerTab(), tr("Scanner"));
+    mainLayout->addWidget(m_tabs);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    m_refreshButton = new QPushButton(tr("Refresh"), this);
+    m_resetButton = new QPushButton(tr("Reset"), this);
+    QPushButton *closeButton = new QPushButton(tr("Close"), this);
+
+    buttonLayout->addWidget(m_refreshButton);
+    buttonLayout->addWidget(m_resetButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(m_refreshButton, &QPushButton::clicked, this, &DiagnosticsDialog::refresh);
+    connect(m_resetButton, &QPushButton::clicked, this, &DiagnosticsDialog::onResetClicked);
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::accept);
+}
+
+QWidget *DiagnosticsDialog::createMetricsTab()
+{
+    QWidget *tab = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(tab);
+
+    m_metricsTree = new QTreeWidget(tab);
+    m_metricsTree->setColumnCount(6);
+    m_metricsTree->setHeaderLabels(QStringList() << tr("Feed / Metric") << tr("Count")
+                                   << tr("Avg (ms)") << tr("p50 (ms)") << tr("p95 (ms)") << tr("Max (ms)"));
+    m_metricsTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_metricsTree->setRootIsDecorated(true);
+    layout->addWidget(m_metricsTree);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    m_exportJsonButton = new QPushButton(tr("Export JSON..."), tab);
+    m_exportPrometheusButton = new QPushButton(tr("Export Prometheus..."), tab);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_exportJsonButton);
+    buttonLayout->addWidget(m_exportPrometheusButton);
+    layout->addLayout(buttonLayout);
+
+    connect(m_exportJsonButton, &QPushButton::clicked, this, &DiagnosticsDialog::onExportJsonClicked);
+    connect(m_exportPrometheusButton, &QPushButton::clicked, this, &DiagnosticsDialog::onExportPrometheusClicked);
+
+    return tab;
+}
+
+QWidget *DiagnosticsDialog::createStallsTab()
+{
+    QWidget *tab = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(tab);
+
+    QHBoxLayout *settingsLayout = new QHBoxLayout();
+    m_watchdogCheck = new QCheckBox(tr("Enable stall watchdog"), tab);
+    m_watchdogCheck->setChecked(m_watchdog->isEnabled());
+
+    m_thresholdSpin = new QSpinBox(tab);
+    m_thresholdSpin->setRange(50, 5000);
+    m_thresholdSpin->setSingleStep(50);
+    m_thresholdSpin->setSuffix(tr(" ms"));
+    m_thresholdSpin->setValue(m_watchdog->thresholdMs());
+
+    settingsLayout->addWidget(m_watchdogCheck);
+    settingsLayout->addStretch();
+    settingsLayout->addWidget(new QLabel(tr("Threshold:"), tab));
+    settingsLayout->addWidget(m_thresholdSpin);
+    layout->addLayout(settingsLayout);
+
+    m_stallsTree = new QTreeWidget(tab);
+    m_stallsTree->setColumnCount(3);
+    m_stallsTree->setHeaderLabels(QStringList() << tr("Scope / Samples") << tr("Duration (ms)") << tr("When"));
+    m_stallsTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    layout->addWidget(m_stallsTree);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    m_exportStallsButton = new QPushButton(tr("Export JSON..."), tab);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_exportStallsButton);
+    layout->addLayout(buttonLayout);
+
+    connect(m_watchdogCheck, &QCheckBox::toggled, this, &DiagnosticsDialog::onWatchdogToggled);
+    connect(m_thresholdSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &DiagnosticsDialog::onThresholdChanged);
+    connect(m_exportStallsButton, &QPushButton::clicked, this, &DiagnosticsDialog::onExportStallsClicked);
+
+    return tab;
+}
+
+QWidget *DiagnosticsDialog::createMemoryTab()
+{
+    QWidget *tab = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(tab);
+
+    m_memoryTree = new QTreeWidget(tab);
+    m_memoryTree->setColumnCount(3);
+    m_memoryTree->setHeaderLabels(QStringList() << tr("Component") << tr("Entries") << tr("Size"));
+    m_memoryTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_memoryTree->setRootIsDecorated(false);
+    layout->addWidget(m_memoryTree);
+
+    return tab;
+}
+
+QWidget *DiagnosticsDialog::createScannerTab()
+{
+    QWidget *tab = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(tab);
+
+    m_kernelLabel = new QLabel(tr("Active byte scan kernel: %1")
+                               .arg(ByteScanner::kernelName(ByteScanner::kernel())), tab);
+    layout->addWidget(m_kernelLabel);
+
+    m_benchmarkTree = new QTreeWidget(tab);
+    m_benchmarkTree->setColumnCount(4);
+    m_benchmarkTree->setHeaderLabels(QStringList() << tr("Kernel") << tr("Throughput (MB/s)")
+                                     << tr("Per body (us)") << tr("Speedup"));
+    m_benchmarkTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_benchmarkTree->setRootIsDecorated(false);
+    layout->addWidget(m_benchmarkTree);
+
+    m_paintBenchmarkLabel = new QLabel(tr("Paint benchmark: not run"), tab);
+    layout->addWidget(m_paintBenchmarkLabel);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    m_paintBenchmarkButton = new QPushButton(tr("Run Paint Benchmark"), tab);
+    m_paintBenchmarkButton->setToolTip(tr("Hover down the article list and time every repaint"));
+    m_benchmarkButton = new QPushButton(tr("Run Benchmark"), tab);
+    m_benchmarkButton->setToolTip(tr("Scan the most recent stored article bodies with every supported kernel"));
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_paintBenchmarkButton);
+    buttonLayout->addWidget(m_benchmarkButton);
+    layout->addLayout(buttonLayout);
+
+    connect(m_benchmarkButton, &QPushButton::clicked, this, &DiagnosticsDialog::onBenchmarkClicked);
+    connect(m_paintBenchmarkButton, &QPushButton::clicked, this, &DiagnosticsDialog::onPaintBenchmarkClicked);
+
+    return tab;
+}
+
+void DiagnosticsDialog::onBenchmarkClicked()
+{
+    // Real captures: the bodies already stored from the configured feeds
+    QList<QByteArray> samples = m_parser->sampleDescriptions(500);
+    if (samples.isEmpty()) {
+        QMessageBox::information(this, tr("Benchmark"), tr("There are no stored articles to benchmark yet."));
+        return;
+    }
+
+    qint64 sampleBytes = 0;
+    for (const QByteArray &sample : samples) {
+        sampleBytes += sample.size();
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    m_benchmarkTree->clear();
+
+    const ByteScanner::Kernel original = ByteScanner::kernel();
+    const ByteScanner::Kernel kernels[] = { ByteScanner::Scalar, ByteScanner::Sse2, ByteScanner::Avx2 };
+    double scalarRate = 0.0;
+
+    for (ByteScanner::Kernel kernel : kernels) {
+        if (!ByteScanner::isSupported(kernel)) {
+            continue;
+        }
+        ByteScanner::setKernel(kernel);
+
+        // Warm up once, then repeat for at least 300 ms
+        for (const QByteArray &sample : samples) {
+            HtmlScanner::scan(sample);
+        }
+        QElapsedTimer timer;
+        timer.start();
+        int passes = 0;
+        do {
+            for (const QByteArray &sample : samples) {
+                HtmlScanner::scan(sample);
+            }
+            ++passes;
+        } while (timer.elapsed() < 300);
+
+        double seconds = timer.nsecsElapsed() / 1e9;
+        double rate = sampleBytes * passes / seconds / (1024.0 * 1024.0);
+        if (kernel == ByteScanner::Scalar) {
+            scalarRate = rate;
+        }
+
+        new QTreeWidgetItem(m_benchmarkTree, QStringList()
+                            << ByteScanner::kernelName(kernel)
+                            << QString::number(rate, 'f', 1)
+                            << QString::number(seconds * 1e6 / (passes * samples.size()), 'f', 2)
+                            << (scalarRate > 0 ? QString("%1x").arg(rate / scalarRate, 0, 'f', 2) : QString("-")));
+    }
+
+    ByteScanner::setKernel(original);
+    QApplication::restoreOverrideCursor();
+
+    m_kernelLabel->setText(tr("Active byte scan kernel: %1 - benchmark over %2 stored bodies (%3)")
+                           .arg(ByteScanner::kernelName(original))
+                           .arg(samples.size())
+                           .arg(QLocale().formattedDataSize(sampleBytes)));
+    for (int i = 1; i < m_benchmarkTree->columnCount(); ++i) {
+        m_benchmarkTree->resizeColumnToContents(i);
+    }
+}
+
+void DiagnosticsDialog::onPaintBenchmarkClicked()
+{
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    NewsFeedWidget::PaintBenchmark result = m_feedWidget->benchmarkHoverSweep(5);
+    QApplication::restoreOverrideCursor();
+
+    if (result.frames == 0) {
+        m_paintBenchmarkLabel->setText(tr("Paint benchmark: the article list is empty or hidden"));
+        return;
+    }
+
+    m_paintBenchmarkLabel->setText(tr("Paint benchmark: %1 frames, %2 ms first frame, %3 ms cached, %4 ms worst")
+                                   .arg(result.frames)
+                                   .arg(result.coldMs, 0, 'f', 2)
+                                   .arg(result.warmMs, 0, 'f', 2)
+                                   .arg(result.worstMs, 0, 'f', 2));
+}
+
+void DiagnosticsDialog::refresh()
+{
+    refreshMetrics();
+    refreshStalls();
+    refreshMemory();
+}
+
+void DiagnosticsDialog::refreshMemory()
+{
+    m_memoryTree->clear();
+
+    RssParser::MemoryReport report = m_parser->memoryReport();
+    QLocale locale;
+
+    new QTreeWidgetItem(m_memoryTree, QStringList()
+                        << tr("Resident feed items")
+                        << QString::number(report.itemCount)
+                        << locale.formattedDataSize(report.itemBytes));
+    new QTreeWidgetItem(m_memoryTree, QStringList()
+                        << tr("Bytes per item")
+                        << QString()
+                        << (report.itemCount > 0
+                            ? locale.formattedDataSize(report.itemBytes / report.itemCount)
+                            : QString("-")));
+    new QTreeWidgetItem(m_memoryTree, QStringList()
+                        << tr("Bytes per item (previous layout)")
+                        << QString()
+                        << (report.itemCount > 0
+                            ? locale.formattedDataSize(report.legacyItemBytes / report.itemCount)
+                            : QString("-")));
+    new QTreeWidgetItem(m_memoryTree, QStringList()
+                        << tr("Interned strings")
+                        << QString::number(report.internCount)
+                        << locale.formattedDataSize(report.internBytes));
+    
+    // Scale the measured per-item averages; the intern tables are paid once
+    if (report.itemCount > 0) {
+        const qint64 projected = 10000;
+        new QTreeWidgetItem(m_memoryTree, QStringList()
+                            << tr("Projected items (compact layout)")
+                            << QString::number(projected)
+                            << locale.formattedDataSize(report.itemBytes * projected / report.itemCount
+                                                        + report.internBytes));
+        new QTreeWidgetItem(m_memoryTree, QStringList()
+                            << tr("Projected items (previous layout)")
+                            << QString::number(projected)
+                            << locale.formattedDataSize(report.legacyItemBytes * projected / report.itemCount));
+    }
+    new QTreeWidgetItem(m_memoryTree, QStringList()
+                        << tr("Description cache")
+                        << QString::number(report.descriptionCacheCount)
+                        << locale.formattedDataSize(report.descriptionCacheBytes));
+    new QTreeWidgetItem(m_memoryTree, QStringList()
+                        << tr("Processed GUID index")
+                        << QString::number(report.guidCount)
+                        << locale.formattedDataSize(report.guidBytes));
+    new QTreeWidgetItem(m_memoryTree, QStringList()
+                        << tr("Article store (in use)")
+                        << QString()
+                        << locale.formattedDataSize(report.storeUsedBytes));
+    new QTreeWidgetItem(m_memoryTree, QStringList()
+                        << tr("Article store (on disk)")
+                        << QString()
+                        << locale.formattedDataSize(report.storeFileBytes));
+
+    m_memoryTree->resizeColumnToContents(1);
+    m_memoryTree->resizeColumnToContents(2);
+}
+
+void DiagnosticsDialog::refreshMetrics()
+{
+    m_metricsTree->clear();
+
+    QHash<QString, FeedStats> feeds = FeedMetrics::instance().snapshot();
+    QStringList feedNames = feeds.keys();
+    feedNames.sort(Qt::CaseInsensitive);
+
+    for (const QString &feed : feedNames) {
+        const FeedStats &stats = feeds[feed];
+        QTreeWidgetItem *feedItem = new QTreeWidgetItem(m_metricsTree, QStringList() << feed);
+
+        QStringList stageNames = stats.stages.keys();
+        stageNames.sort();
+        for (const QString &stage : stageNames) {
+            const LatencyHistogram &h = stats.stages[stage];
+            new QTreeWidgetItem(feedItem, QStringList()
+                                << stage
+                                << QString::number(h.count)
+                                << QString::number(h.average(), 'f', 1)
+                                << QString::number(h.percentile(0.5), 'f', 1)
+                                << QString::number(h.percentile(0.95), 'f', 1)
+                                << QString::number(h.max, 'f', 1));
+        }
+
+        QStringList counterNames = stats.counters.keys();
+        counterNames.sort();
+        for (const QString &counter : counterNames) {
+            new QTreeWidgetItem(feedItem, QStringList()
+                                << counter
+                                << QString::number(stats.counters.value(counter)));
+        }
+    }
+
+    m_metricsTree->expandAll();
+    for (int i = 1; i < m_metricsTree->columnCount(); ++i) {
+        m_metricsTree->resizeColumnToContents(i);
+    }
+}
+
+void DiagnosticsDialog::refreshStalls()
+{
+    m_stallsTree->clear();
+
+    for (const StallRecord &record : m_watchdog->worstStalls()) {
+        QTreeWidgetItem *stallItem = new QTreeWidgetItem(m_stallsTree, QStringList()
+                                                         << record.scope
+                                                         << QString::number(record.durationMs, 'f', 0)
+                                                         << record.when.toString("hh:mm:ss.zzz"));
+
+        // Hotspots, most sampled first
+        QList<QPair<int, QString>> hotspots;
+        for (auto it = record.samples.constBegin(); it != record.samples.constEnd(); ++it) {
+            hotspots.append(qMakePair(it.value(), it.key()));
+        }
+        std::sort(hotspots.begin(), hotspots.end(), [](const QPair<int, QString> &a, const QPair<int, QString> &b) {
+            return a.first > b.first;
+        });
+
+        for (const QPair<int, QString> &hotspot : hotspots) {
+            new QTreeWidgetItem(stallItem, QStringList()
+                                << tr("%1 (%2 samples)").arg(hotspot.second).arg(hotspot.first));
+        }
+    }
+
+    m_stallsTree->resizeColumnToContents(1);
+    m_stallsTree->resizeColumnToContents(2);
+}
+
+void DiagnosticsDialog::onExportJsonClicked()
+{
+    exportToFile(tr("JSON Files (*.json)"), "json", FeedMetrics::instance().toJson());
+}
+
+void DiagnosticsDialog::onExportPrometheusClicked()
+{
+    exportToFile(tr("Prometheus Text (*.prom);;Text Files (*.txt)"), "prom",
+                 FeedMetrics::instance().toPrometheus());
+}
+
+void DiagnosticsDialog::onExportStallsClicked()
+{
+    exportToFile(tr("JSON Files (*.json)"), "json", m_watchdog->toJson());
+}
+
+void DiagnosticsDialog::onResetClicked()
+{
+    if (m_tabs->currentIndex() == 0) {
+        FeedMetrics::instance().reset();
+    } else if (m_tabs->currentIndex() == 1) {
+        m_watchdog->clear();
+    }
+    refresh();
+}
+
+void DiagnosticsDialog::onWatchdogToggled(bool enabled)
+{
+    m_watchdog->setEnabled(enabled);
+    m_watchdog->saveSettings();
+}
+
+void DiagnosticsDialog::onThresholdChanged(int ms)
+{
+    m_watchdog->setThresholdMs(ms);
+    m_watchdog->saveSettings();
+}
+
+void DiagnosticsDialog::exportToFile(const QString &filter, const QString &suffix, const QByteArray &data)
+{
+    QString fileName = QFileDialog::getSaveFileName(this,
+        tr("Export Diagnostics"),
+        QDir::homePath() + "/motorsportrss-diagnostics." + suffix,
+        filter);
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QFile file(fileName);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(data);
+        file.close();
+    } else {
+        QMessageBox::warning(this, tr("Export Error"), tr("Could not write %1").arg(fileName));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QTreeWidget>
+#include <QPushButton>
+#include <QTabWidget>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QLabel>
+
+class StallWatchdog;
+class RssParser;
+class NewsFeedWidget;
+
+// Shows the FeedMetrics registry, the stall watchdog and memory accounting
+class DiagnosticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    DiagnosticsDialog(StallWatchdog *watchdog, RssParser *parser, NewsFeedWidget *feedWidget,
+                      QWidget *parent = nullptr);
+
+private slots:
+    void refresh();
+    void onExportJsonClicked();
+    void onExportPrometheusClicked();
+    void onResetClicked();
+    void onWatchdogToggled(bool enabled);
+    void onThresholdChanged(int ms);
+    void onExportStallsClicked();
+    void onBenchmarkClicked();
+    void onPaintBenchmarkClicked();
+
+private:
+    StallWatchdog *m_watchdog;
+    RssParser *m_parser;
+    NewsFeedWidget *m_feedWidget;
+
+    QTabWidget *m_tabs;
+
+    // Metrics tab
+    QTreeWidget *m_metricsTree;
+    QPushButton *m_exportJsonButton;
+    QPushButton *m_exportPrometheusButton;
+
+    // Stalls tab
+    QTreeWidget *m_stallsTree;
+    QCheckBox *m_watchdogCheck;
+    QSpinBox *m_thresholdSpin;
+    QPushButton *m_exportStallsButton;
+
+    // Memory tab
+    QTreeWidget *m_memoryTree;
+    
+    // Scanner tab
+    QLabel *m_kernelLabel;
+    QTreeWidget *m_benchmarkTree;
+    QPushButton *m_benchmarkButton;
+    QLabel *m_paintBenchmarkLabel;
+    QPushButton *m_paintBenchmarkButton;
+
+    QPushButton *m_refreshButton;
+    QPushButton *m_resetButton;
+
+    void setupUi();
+    QWidget *createMetricsTab();
+    QWidget *createStallsTab();
+    QWidget *createMemoryTab();
+    QWidget *createScannerTab();
+    void refreshMetrics();
+    void refreshStalls();
+    void refreshMemory();
+    void exportToFile(const QString &filter, const QString &suffix, const QByteArray &data);
+};
+
+#endif // DIAGNOSTICSDIALOG_H
\ No newline at end of file
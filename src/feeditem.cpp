@@ -0,0 +1,196 @@
+#include "feeditem.h"
+#include "categoryindex.h"
+
+#include <QDebug>
+
+InternTable::InternTable()
+{
+    m_values.append(QString());
+}
+
+quint16 InternTable::intern(const QString &value)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+    
+    auto it = m_ids.constFind(value);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+    
+    if (isFull()) {
+        qWarning() << "Intern table full, dropping" << value;
+        return 0;
+    }
+    
+    quint16 id = quint16(m_values.size());
+    m_values.append(value);
+    m_ids.insert(value, id);
+    return id;
+}
+
+quint16 InternTable::intern(const QStringRef &value)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+    
+    // Look up through a key that borrows the parser's buffer
+    const QString key = QString::fromRawData(value.unicode(), value.size());
+    auto it = m_ids.constFind(key);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+    return intern(value.toString());
+}
+
+const QString &InternTable::value(quint16 id) const
+{
+    return id < m_values.size() ? m_values.at(id) : m_values.at(0);
+}
+
+qint64 InternTable::memoryFootprint() const
+{
+    qint64 bytes = qint64(m_values.capacity()) * qint64(sizeof(QString));
+    for (const QString &value : m_values) {
+        if (!value.isNull()) {
+            bytes += qint64(sizeof(QArrayData)) + (value.capacity() + 1) * qint64(sizeof(QChar));
+        }
+    }
+    // Hash node per entry, the key shares the string data
+    bytes += qint64(m_ids.size()) * (3 * qint64(sizeof(void *)) + qint64(sizeof(quint16)));
+    return bytes;
+}
+
+InternTable &InternTable::categories()
+{
+    static InternTable table;
+    return table;
+}
+
+InternTable &InternTable::feeds()
+{
+    static InternTable table;
+    return table;
+}
+
+InternTable &InternTable::urlPrefixes()
+{
+    static InternTable table;
+    return table;
+}
+
+void CompactUrl::assign(const QString &url)
+{
+    assign(QStringRef(&url));
+}
+
+void CompactUrl::assign(const QStringRef &url)
+{
+    // Intern everything up to the first '/' after the scheme
+    int hostStart = url.indexOf(QLatin1String("://"));
+    int pathStart = hostStart > 0 ? url.indexOf(QLatin1Char('/'), hostStart + 3) : -1;
+    if (hostStart > 0 && pathStart < 0) {
+        pathStart = url.size();
+    }
+    
+    InternTable &prefixes = InternTable::urlPrefixes();
+    if (pathStart > 0 && !prefixes.isFull()) {
+        prefixId = prefixes.intern(url.left(pathStart));
+        rest = url.mid(pathStart).toUtf8();
+    } else {
+        prefixId = 0;
+        rest = url.toUtf8();
+    }
+}
+
+QString CompactUrl::toString() const
+{
+    if (prefixId == 0) {
+        return QString::fromUtf8(rest);
+    }
+    return InternTable::urlPrefixes().value(prefixId) + QString::fromUtf8(rest);
+}
+
+QStringList FeedItem::categories() const
+{
+    QStringList names;
+    if (categoryId != 0) {
+        names.append(category());
+    }
+    for (quint16 id : m_moreCategories) {
+        names.append(InternTable::categories().value(id));
+    }
+    return names;
+}
+
+void FeedItem::addCategory(const QString &category)
+{
+    addCategoryId(CategoryIndex::instance().normalize(category));
+}
+
+void FeedItem::addCategory(const QStringRef &category)
+{
+    addCategoryId(CategoryIndex::instance().normalize(category));
+}
+
+void FeedItem::setCategories(const QStringList &categories)
+{
+    categoryId = 0;
+    categoryMask = 0;
+    m_moreCategories.clear();
+    for (const QString &category : categories) {
+        addCategory(category);
+    }
+}
+
+void FeedItem::addCategoryId(quint16 id)
+{
+    if (id == 0 || id == categoryId || m_moreCategories.contains(id)) {
+        return;
+    }
+    if (categoryId == 0) {
+        categoryId = id;
+    } else {
+        m_moreCategories.append(id);
+    }
+    categoryMask |= CategoryIndex::instance().mask(id);
+}
+
+bool FeedItem::hasCategory(quint16 id) const
+{
+    CategoryIndex &index = CategoryIndex::instance();
+    if (!(categoryMask & index.mask(id))) {
+        return false;
+    }
+    // Past the first 63 categories bits are shared, so compare the IDs
+    return index.bit(id) != CategoryIndex::OverflowBit || id == categoryId || m_moreCategories.contains(id);
+}
+
+qint64 FeedItem::memoryFootprint() const
+{
+    auto stringBytes = [](const QString &s) -> qint64 {
+        return s.isNull() ? 0 : qint64(sizeof(QArrayData)) + (s.capacity() + 1) * qint64(sizeof(QChar));
+    };
+    auto bytes = [](const QByteArray &b) -> qint64 {
+        return b.isNull() ? 0 : qint64(sizeof(QArrayData)) + b.capacity() + 1;
+    };
+    return qint64(sizeof(FeedItem)) + stringBytes(title) + stringBytes(pubDate)
+         + bytes(m_link.rest) + bytes(m_imageUrl.rest) + bytes(m_guid) + bytes(m_description)
+         + bytes(m_snippet) + bytes(m_links)
+         + (m_moreCategories.isEmpty() ? 0 : qint64(m_moreCategories.capacity()) * qint64(sizeof(quint16)));
+}
+
+qint64 FeedItem::legacyFootprint() const
+{
+    auto utf16Bytes = [](int length) -> qint64 {
+        return length == 0 ? 0 : qint64(sizeof(QArrayData)) + (length + 1) * qint64(sizeof(QChar));
+    };
+    // Seven QString handles, the read flag, a QDateTime with its private data and pubTime
+    qint64 layout = 7 * qint64(sizeof(QString)) + qint64(sizeof(void *)) + qint64(sizeof(void *)) + 16
+                  + qint64(sizeof(qint64));
+    return layout + utf16Bytes(title.size()) + utf16Bytes(link().size()) + utf16Bytes(description().size())
+         + utf16Bytes(pubDate.size()) + utf16Bytes(imageUrl().size()) + utf16Bytes(category().size())
+         + utf16Bytes(guid().size());
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#ifndef FEEDITEM_H
+#define FEEDITEM_H
+
+#include <QString>
+#include <QByteArray>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+// Append-only table mapping repeated strings to small integer IDs.
+// ID 0 is always the empty string. Used from the GUI thread only.
+class InternTable
+{
+public:
+    InternTable();
+
+    quint16 intern(const QString &value);
+    quint16 intern(const QStringRef &value); // copies only when the value is new
+    const QString &value(quint16 id) const;
+    int size() const { return m_values.size(); }
+    bool isFull() const { return m_values.size() > 0xFFFF; }
+
+    // Approximate heap footprint of the table
+    qint64 memoryFootprint() const;
+
+    static InternTable &categories();
+    static InternTable &feeds();
+    static InternTable &urlPrefixes();
+
+private:
+    QVector<QString> m_values;
+    QHash<QString, quint16> m_ids;
+};
+
+// URL split into an interned scheme://host prefix and a UTF-8 remainder
+struct CompactUrl {
+    quint16 prefixId = 0;
+    QByteArray rest;
+
+    void assign(const QString &url);
+    void assign(const QStringRef &url);
+    QString toString() const;
+    bool isEmpty() const { return prefixId == 0 && rest.isEmpty(); }
+};
+
+struct FeedItem {
+    QString title;
+    QString pubDate;
+    qint64 pubTime = 0;      // pubDate in seconds since epoch, 0 if unknown
+    qint64 fetchTime = 0;    // seconds since epoch
+    quint16 categoryId = 0;  // first category, InternTable::categories()
+    quint64 categoryMask = 0; // every category, CategoryIndex bits
+    quint16 feedId = 0;      // InternTable::feeds()
+    bool isRead = false;
+    quint32 wordCount = 0;   // words in the body, from HtmlScanner
+    
+    // Rarely displayed fields are kept as UTF-8 and converted on access
+    QString link() const { return m_link.toString(); }
+    void setLink(const QString &link) { m_link.assign(link); }
+    void setLink(const QStringRef &link) { m_link.assign(link); }
+    bool hasLink() const { return !m_link.isEmpty(); }
+    const CompactUrl &compactLink() const { return m_link; }
+    
+    QString imageUrl() const { return m_imageUrl.toString(); }
+    void setImageUrl(const QString &url) { m_imageUrl.assign(url); }
+    void setImageUrl(const QStringRef &url) { m_imageUrl.assign(url); }
+    bool hasImageUrl() const { return !m_imageUrl.isEmpty(); }
+    
+    QString guid() const { return QString::fromUtf8(m_guid); }
+    const QByteArray &guidKey() const { return m_guid; }
+    void setGuid(const QString &guid) { m_guid = guid.toUtf8(); }
+    void setGuid(const QStringRef &guid) { m_guid = guid.toUtf8(); }
+    void setGuidKey(const QByteArray &guid) { m_guid = guid; }
+    
+    // The description is only materialized as a QString when asked for
+    QString description() const { return QString::fromUtf8(m_description); }
+    const QByteArray &descriptionUtf8() const { return m_description; }
+    void setDescription(const QString &description) { m_description = description.toUtf8(); }
+    void setDescription(const QStringRef &description) { m_description = description.toUtf8(); }
+    
+    // Plain-text lead of the body, from HtmlScanner
+    QString snippet() const { return QString::fromUtf8(m_snippet); }
+    void setSnippet(const QString &snippet) { m_snippet = snippet.toUtf8(); }
+    
+    // Outbound links of the body; only kept until the item is stored
+    QStringList links() const
+    {
+        return m_links.isEmpty() ? QStringList() : QString::fromUtf8(m_links).split(QLatin1Char('\n'));
+    }
+    void setLinks(const QStringList &links) { m_links = links.join(QLatin1Char('\n')).toUtf8(); }
+    
+    // Drops the body and links once they are stored, keeping the row metadata
+    void releaseBody() { m_description.clear(); m_links.clear(); }
+    
+    // Categories are normalized through CategoryIndex; the first is displayed
+    QString category() const { return InternTable::categories().value(categoryId); }
+    QStringList categories() const;
+    void addCategory(const QString &category);
+    void addCategory(const QStringRef &category);
+    void setCategories(const QStringList &categories);
+    bool hasCategory(quint16 id) const;
+    const QVector<quint16> &moreCategoryIds() const { return m_moreCategories; }
+    
+    QString feedUrl() const { return InternTable::feeds().value(feedId); }
+    void setFeedUrl(const QString &url) { feedId = InternTable::feeds().intern(url); }
+    
+    // Time used for retention decisions
+    qint64 ageTime() const { return pubTime > 0 ? pubTime : fetchTime; }
+    
+    // Approximate heap footprint of this item, excluding the shared intern tables
+    qint64 memoryFootprint() const;
+    
+    // Footprint the same item had with seven QStrings and a QDateTime
+    qint64 legacyFootprint() const;
+
+private:
+    CompactUrl m_link;
+    CompactUrl m_imageUrl;
+    QByteArray m_guid;
+    QByteArray m_description;
+    QByteArray m_snippet;
+    QByteArray m_links; // newline separated
+    QVector<quint16> m_moreCategories; // categories after the first
+    
+    void addCategoryId(quint16 id);
+};
+
+#endif // FEEDITEM_H
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "feeditemdelegate.h"
+#include "rssfeedmodel.h"
+#include "thememanager.h"
+
+#include <QPainter>
+#include <QPixmapCache>
+#include <QDateTime>
+#include <QFontMetrics>
+
+FeedItemDelegate::FeedItemDelegate(RssFeedModel *model, QObject *parent)
+    : QStyledItemDelegate(parent), m_model(model)
+{
+    // Theme colours are read on paint, but fonts and metrics may change too
+    connect(&ThemeManager::instance(), &ThemeManager::themeChanged, this, [this]() { invalidateCache(); });
+}
+
+void FeedItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                             const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return;
+    
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    
+    // Text, icon and read state laid out on the first paint of the row
+    const RowText *text = rowText(index, opt);
+    bool isRead = text->isRead;
+    const ThemeManager &theme = ThemeManager::instance();
+    
+    // Background
+    if (opt.state & QStyle::State_Selected) {
+        painter->fillRect(opt.rect, opt.palette.highlight());
+        painter->setPen(opt.palette.highlightedText().color());
+    } else {
+        painter->fillRect(opt.rect, opt.state & QStyle::State_MouseOver 
+                         ? theme.hoverColor() : opt.palette.color(QPalette::Base));
+        painter->setPen(opt.palette.color(QPalette::Text));
+    }
+    
+    int padding = Padding;
+    int iconSize = IconSize;
+    
+    // Draw unread indicator
+    if (!isRead) {
+        QRect indicator(opt.rect.left() + 2, opt.rect.top() + (opt.rect.height() - 8) / 2, 4, 8);
+        painter->fillRect(indicator, theme.accentColor()); // Blue indicator for unread
+    }
+    
+    // Draw category icon
+    if (!text->icon.isNull()) {
+        QRect iconRect = QRect(opt.rect.left() + padding + (isRead ? 0 : 4), 
+                              opt.rect.top() + padding,
+                              iconSize, iconSize);
+        painter->drawPixmap(iconRect.topLeft(), text->icon);
+    }
+    
+    // Draw title
+    int leftMargin = padding + iconSize + padding + (isRead ? 0 : 4);
+    QPoint textPos = opt.rect.topLeft() + QPoint(leftMargin, padding);
+    painter->setFont(isRead ? m_readTitleFont : m_titleFont);
+    painter->drawStaticText(textPos, text->title);
+    
+    // Draw date and category
+    QColor dateColor = opt.state & QStyle::State_Selected 
+                     ? opt.palette.highlightedText().color() 
+                     : theme.mutedTextColor();
+    painter->setPen(dateColor);
+    painter->setFont(m_detailFont);
+    painter->drawStaticText(textPos + QPoint(0, text->titleHeight + 4), text->details);
+}
+
+QSize FeedItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const
+{
+    return QSize(option.rect.width(), RowHeight);
+}
+
+void FeedItemDelegate::prefetch(const QModelIndex &index) const
+{
+    categoryPixmap(index.data(RssFeedModel::CategoryRole).toString());
+    formattedDate(index);
+}
+
+void FeedItemDelegate::trackModel(QAbstractItemModel *model)
+{
+    connect(model, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+            m_rows.remove(row);
+        }
+    });
+    connect(model, &QAbstractItemModel::rowsInserted, this,
+            [this](const QModelIndex &, int first) { dropRowsFrom(first); });
+    connect(model, &QAbstractItemModel::rowsRemoved, this,
+            [this](const QModelIndex &, int first) { dropRowsFrom(first); });
+    connect(model, &QAbstractItemModel::rowsMoved, this, [this]() { m_rows.clear(); });
+    connect(model, &QAbstractItemModel::layoutChanged, this, [this]() { m_rows.clear(); });
+    connect(model, &QAbstractItemModel::modelReset, this, [this]() { m_rows.clear(); });
+}
+
+void FeedItemDelegate::invalidateCache()
+{
+    m_rows.clear();
+    m_fontValid = false;
+}
+
+const FeedItemDelegate::RowText *FeedItemDelegate::rowText(const QModelIndex &index,
+                                                             const QStyleOptionViewItem &opt) const
+{
+    if (!m_fontValid || opt.font != m_font) {
+        setFonts(opt.font);
+    }
+    
+    const int width = opt.rect.width();
+    RowText *text = m_rows.object(index.row());
+    if (text && text->width == width) {
+        return text;
+    }
+    
+    // Only a cache miss reads the row's strings and measures them
+    QString title = index.data(RssFeedModel::TitleRole).toString();
+    QString category = index.data(RssFeedModel::CategoryRole).toString();
+    
+    text = new RowText;
+    text->width = width;
+    text->isRead = index.data(RssFeedModel::IsReadRole).toBool();
+    text->icon = categoryPixmap(category);
+    
+    int leftMargin = Padding + IconSize + Padding + (text->isRead ? 0 : 4);
+    int textWidth = qMax(0, width - leftMargin - Padding);
+    
+    QFontMetrics titleMetrics(text->isRead ? m_readTitleFont : m_titleFont);
+    text->titleHeight = titleMetrics.height();
+    text->title = staticText(titleMetrics.elidedText(title, Qt::ElideRight, textWidth),
+                             text->isRead ? m_readTitleFont : m_titleFont);
+    
+    QString catText = category.isEmpty() ? "" : " | " + category;
+    QString dateCategory = formattedDate(index) + catText;
+    text->details = staticText(QFontMetrics(m_detailFont).elidedText(dateCategory, Qt::ElideRight, textWidth),
+                               m_detailFont);
+    
+    m_rows.insert(index.row(), text);
+    return text;
+}
+
+QStaticText FeedItemDelegate::staticText(const QString &value, const QFont &font)
+{
+    QStaticText text(value);
+    text.setTextFormat(Qt::PlainText);
+    text.setPerformanceHint(QStaticText::AggressiveCaching);
+    text.prepare(QTransform(), font);
+    return text;
+}
+
+void FeedItemDelegate::setFonts(const QFont &font) const
+{
+    m_font = font;
+    m_fontValid = true;
+    m_titleFont = font;
+    m_titleFont.setPointSize(10);
+    m_readTitleFont = m_titleFont;
+    m_titleFont.setBold(true);
+    m_detailFont = font;
+    m_detailFont.setPointSize(8);
+    m_rows.clear();
+}
+
+void FeedItemDelegate::dropRowsFrom(int first) const
+{
+    // Rows after an insertion or removal have shifted
+    for (int row : m_rows.keys()) {
+        if (row >= first) {
+            m_rows.remove(row);
+        }
+    }
+}
+
+QPixmap FeedItemDelegate::categoryPixmap(const QString &category) const
+{
+    auto it = m_iconPaths.constFind(category);
+    if (it == m_iconPaths.constEnd()) {
+        it = m_iconPaths.insert(category, m_model ? m_model->getCategoryIcon(category) : QString());
+    }
+    
+    // Decoding and smooth scaling dominated the cost of a paint
+    const QString key = QStringLiteral("feeditem-icon:") + it.value();
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap)) {
+        pixmap = QPixmap(it.value());
+        if (!pixmap.isNull()) {
+            pixmap = pixmap.scaled(IconSize, IconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+        QPixmapCache::insert(key, pixmap);
+    }
+    return pixmap;
+}
+
+QString FeedItemDelegate::formattedDate(const QModelIndex &index) const
+{
+    // The publish time is parsed once at ingest
+    qint64 pubTime = index.data(RssFeedModel::PubTimeRole).toLongLong();
+    if (pubTime <= 0) {
+        return index.data(RssFeedModel::PubDateRole).toString();
+    }
+    if (QString *cached = m_dates.object(pubTime)) {
+        return *cached;
+    }
+    QString text = QDateTime::fromSecsSinceEpoch(pubTime).toString("dd MMM yyyy - hh:mm");
+    m_dates.insert(pubTime, new QString(text));
+    return text;
+}
\ No newline at end of file
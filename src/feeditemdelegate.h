@@ -0,0 +1,73 @@
+#ifndef FEEDITEMDELEGATE_H
+#define FEEDITEMDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QStaticText>
+#include <QPixmap>
+#include <QCache>
+#include <QHash>
+#include <QFont>
+
+class RssFeedModel;
+
+// Paints a feed item as an icon, a title and a date line. The laid-out text
+// of a row is kept as QStaticText, so scrolling and hover repaints only draw.
+class FeedItemDelegate : public QStyledItemDelegate
+{
+public:
+    // The model maps categories to icons; without one rows have no icon
+    explicit FeedItemDelegate(RssFeedModel *model, QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const override;
+
+    // Computes the derived data of a row ahead of its first paint
+    void prefetch(const QModelIndex &index) const;
+
+    // Laid-out rows belong to the rows of the view's model; they are dropped
+    // when a row changes or rows move, and rebuilt when the width changes
+    void trackModel(QAbstractItemModel *model);
+
+    // Drops all laid-out rows; a theme change does this by itself, a font
+    // change is noticed on paint
+    void invalidateCache();
+
+    bool isRowCached(int row) const { return m_rows.contains(row); }
+
+    static const int RowHeight = 70;
+
+private:
+    static const int IconSize = 40;
+    static const int Padding = 10;
+    static const int DateCacheSize = 1024;
+    static const int RowCacheSize = 256; // several screens of rows
+
+    struct RowText {
+        QStaticText title;
+        QStaticText details; // date and category
+        QPixmap icon;
+        int titleHeight = 0;
+        int width = 0;
+        bool isRead = false;
+    };
+
+    RssFeedModel *m_model;
+    mutable QHash<QString, QString> m_iconPaths; // category -> resource
+    mutable QCache<qint64, QString> m_dates{DateCacheSize}; // pubTime -> display text
+    mutable QCache<int, RowText> m_rows{RowCacheSize}; // view row -> laid-out text
+    mutable QFont m_font; // view font the fonts below derive from
+    mutable bool m_fontValid = false;
+    mutable QFont m_titleFont;
+    mutable QFont m_readTitleFont;
+    mutable QFont m_detailFont;
+
+    const RowText *rowText(const QModelIndex &index, const QStyleOptionViewItem &opt) const;
+    static QStaticText staticText(const QString &value, const QFont &font);
+    void setFonts(const QFont &font) const;
+    void dropRowsFrom(int first) const;
+    QPixmap categoryPixmap(const QString &category) const;
+    QString formattedDate(const QModelIndex &index) const;
+};
+
+#endif // FEEDITEMDELEGATE_H
\ No newline at end of file
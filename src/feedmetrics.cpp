@@ -0,0 +1,218 @@
+#include "feedmetrics.h"
+
+#include <QMutexLocker>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QStringList>
+
+const double LatencyHistogram::BucketBounds[LatencyHistogram::BucketCount - 1] = {
+    1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000
+};
+
+void LatencyHistogram::record(double ms)
+{
+    int bucket = 0;
+    while (bucket < BucketCount - 1 && ms > BucketBounds[bucket]) {
+        ++bucket;
+    }
+
+    buckets[bucket]++;
+    count++;
+    sum += ms;
+    if (ms > max) {
+        max = ms;
+    }
+}
+
+double LatencyHistogram::percentile(double p) const
+{
+    if (count == 0) {
+        return 0.0;
+    }
+
+    // Report the upper bound of the bucket holding the requested rank
+    quint64 rank = quint64(p * count + 0.5);
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount - 1; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return qMin(BucketBounds[i], max);
+        }
+    }
+
+    return max;
+}
+
+const QString FeedMetrics::AppScope = QStringLiteral("app");
+
+const QString FeedMetrics::StageConnect = QStringLiteral("connect");
+const QString FeedMetrics::StageTtfb = QStringLiteral("ttfb");
+const QString FeedMetrics::StageDownload = QStringLiteral("download");
+const QString FeedMetrics::StageParse = QStringLiteral("parse");
+const QString FeedMetrics::StageCacheLoad = QStringLiteral("cache_load");
+const QString FeedMetrics::StageCacheWrite = QStringLiteral("cache_write");
+const QString FeedMetrics::StageGuiStall = QStringLiteral("gui_stall");
+const QString FeedMetrics::StageStartup = QStringLiteral("startup");
+const QString FeedMetrics::StageThemeApply = QStringLiteral("theme_apply");
+
+const QString FeedMetrics::CounterFetches = QStringLiteral("fetches");
+const QString FeedMetrics::CounterBytes = QStringLiteral("bytes_downloaded");
+const QString FeedMetrics::CounterConditionalHits = QStringLiteral("conditional_hits");
+const QString FeedMetrics::CounterNetworkErrors = QStringLiteral("network_errors");
+const QString FeedMetrics::CounterParseErrors = QStringLiteral("parse_errors");
+const QString FeedMetrics::CounterItems = QStringLiteral("items_parsed");
+const QString FeedMetrics::CounterRecoveries = QStringLiteral("recoveries");
+
+FeedMetrics &FeedMetrics::instance()
+{
+    static FeedMetrics metrics;
+    return metrics;
+}
+
+void FeedMetrics::recordDuration(const QString &feed, const QString &stage, double ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_feeds[feed].stages[stage].record(ms);
+}
+
+void FeedMetrics::increment(const QString &feed, const QString &counter, quint64 amount)
+{
+    QMutexLocker locker(&m_mutex);
+    m_feeds[feed].counters[counter] += amount;
+}
+
+QHash<QString, FeedStats> FeedMetrics::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_feeds;
+}
+
+void FeedMetrics::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_feeds.clear();
+}
+
+QByteArray FeedMetrics::toJson() const
+{
+    QHash<QString, FeedStats> feeds = snapshot();
+
+    QJsonObject feedsObject;
+    for (auto it = feeds.constBegin(); it != feeds.constEnd(); ++it) {
+        QJsonObject stagesObject;
+        for (auto st = it.value().stages.constBegin(); st != it.value().stages.constEnd(); ++st) {
+            const LatencyHistogram &h = st.value();
+
+            QJsonArray buckets;
+            for (int i = 0; i < LatencyHistogram::BucketCount; ++i) {
+                buckets.append(double(h.buckets[i]));
+            }
+
+            QJsonObject stageObject;
+            stageObject["count"] = double(h.count);
+            stageObject["sum_ms"] = h.sum;
+            stageObject["avg_ms"] = h.average();
+            stageObject["p50_ms"] = h.percentile(0.5);
+            stageObject["p95_ms"] = h.percentile(0.95);
+            stageObject["max_ms"] = h.max;
+            stageObject["buckets"] = buckets;
+            stagesObject[st.key()] = stageObject;
+        }
+
+        QJsonObject countersObject;
+        for (auto ct = it.value().counters.constBegin(); ct != it.value().counters.constEnd(); ++ct) {
+            countersObject[ct.key()] = double(ct.value());
+        }
+
+        QJsonObject feedObject;
+        feedObject["stages"] = stagesObject;
+        feedObject["counters"] = countersObject;
+        feedsObject[it.key()] = feedObject;
+    }
+
+    QJsonArray bounds;
+    for (int i = 0; i < LatencyHistogram::BucketCount - 1; ++i) {
+        bounds.append(LatencyHistogram::BucketBounds[i]);
+    }
+
+    QJsonObject root;
+    root["generated"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["bucketBoundsMs"] = bounds;
+    root["feeds"] = feedsObject;
+
+    return QJsonDocument(root).toJson();
+}
+
+// Escape a Prometheus label value
+static QString promLabel(const QString &value)
+{
+    QString escaped = value;
+    escaped.replace("\\", "\\\\");
+    escaped.replace("\"", "\\\"");
+    escaped.replace("\n", "\\n");
+    return escaped;
+}
+
+QByteArray FeedMetrics::toPrometheus() const
+{
+    QHash<QString, FeedStats> feeds = snapshot();
+
+    // Sort for stable output between scrapes
+    QStringList feedNames = feeds.keys();
+    feedNames.sort();
+
+    QString out;
+    out += "# HELP motorsportrss_stage_duration_ms Feed processing stage latency in milliseconds\n";
+    out += "# TYPE motorsportrss_stage_duration_ms histogram\n";
+
+    for (const QString &feed : feedNames) {
+        const FeedStats &stats = feeds[feed];
+        QStringList stageNames = stats.stages.keys();
+        stageNames.sort();
+
+        for (const QString &stage : stageNames) {
+            const LatencyHistogram &h = stats.stages[stage];
+            QString labels = QString("feed=\"%1\",stage=\"%2\"").arg(promLabel(feed), promLabel(stage));
+
+            quint64 cumulative = 0;
+            for (int i = 0; i < LatencyHistogram::BucketCount; ++i) {
+                cumulative += h.buckets[i];
+                QString le = i < LatencyHistogram::BucketCount - 1
+                           ? QString::number(LatencyHistogram::BucketBounds[i])
+                           : QString("+Inf");
+                out += QString("motorsportrss_stage_duration_ms_bucket{%1,le=\"%2\"} %3\n")
+                       .arg(labels, le).arg(cumulative);
+            }
+            out += QString("motorsportrss_stage_duration_ms_sum{%1} %2\n").arg(labels).arg(h.sum, 0, 'f', 3);
+            out += QString("motorsportrss_stage_duration_ms_count{%1} %2\n").arg(labels).arg(h.count);
+        }
+    }
+
+    // Counters are grouped by metric name as required by the text format
+    QStringList counterNames;
+    for (const FeedStats &stats : feeds) {
+        for (auto ct = stats.counters.constBegin(); ct != stats.counters.constEnd(); ++ct) {
+            if (!counterNames.contains(ct.key())) {
+                counterNames.append(ct.key());
+            }
+        }
+    }
+    counterNames.sort();
+
+    for (const QString &counter : counterNames) {
+        QString metric = "motorsportrss_" + counter + "_total";
+        out += QString("# TYPE %1 counter\n").arg(metric);
+        for (const QString &feed : feedNames) {
+            const FeedStats &stats = feeds[feed];
+            if (stats.counters.contains(counter)) {
+                out += QString("%1{feed=\"%2\"} %3\n")
+                       .arg(metric, promLabel(feed))
+                       .arg(stats.counters.value(counter));
+            }
+        }
+    }
+
+    return out.toUtf8();
+}
\ No newline at end of file
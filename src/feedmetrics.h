@@ -0,0 +1,76 @@
+#ifndef FEEDMETRICS_H
+#define FEEDMETRICS_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QByteArray>
+
+// Fixed-bucket latency histogram, values in milliseconds
+struct LatencyHistogram {
+    static const int BucketCount = 14;
+    static const double BucketBounds[BucketCount - 1]; // Upper bounds, last bucket is +Inf
+
+    quint64 buckets[BucketCount] = {};
+    quint64 count = 0;
+    double sum = 0.0;
+    double max = 0.0;
+
+    void record(double ms);
+    double average() const { return count > 0 ? sum / count : 0.0; }
+    double percentile(double p) const;
+};
+
+struct FeedStats {
+    QHash<QString, LatencyHistogram> stages; // stage -> latency histogram
+    QHash<QString, quint64> counters;        // counter -> value
+};
+
+// Process-wide registry of per-feed timings and counters. Thread safe.
+class FeedMetrics
+{
+public:
+    static FeedMetrics &instance();
+
+    // Scope used for metrics that do not belong to a particular feed
+    static const QString AppScope;
+
+    // Stage names
+    static const QString StageConnect;    // request start -> TLS established (includes DNS/TCP)
+    static const QString StageTtfb;       // request start -> response headers
+    static const QString StageDownload;   // response headers -> body complete
+    static const QString StageParse;
+    static const QString StageCacheLoad;
+    static const QString StageCacheWrite;
+    static const QString StageGuiStall;
+    static const QString StageStartup;     // application start -> main window constructed
+    static const QString StageThemeApply;  // theme switch -> event loop settled
+
+    // Counter names
+    static const QString CounterFetches;
+    static const QString CounterBytes;
+    static const QString CounterConditionalHits;
+    static const QString CounterNetworkErrors;
+    static const QString CounterParseErrors;
+    static const QString CounterItems;
+    static const QString CounterRecoveries;  // malformed payloads repaired by FeedRecovery
+
+    void recordDuration(const QString &feed, const QString &stage, double ms);
+    void increment(const QString &feed, const QString &counter, quint64 amount = 1);
+
+    QHash<QString, FeedStats> snapshot() const;
+    void reset();
+
+    // Export formats
+    QByteArray toJson() const;
+    QByteArray toPrometheus() const;
+
+private:
+    FeedMetrics() {}
+    Q_DISABLE_COPY(FeedMetrics)
+
+    mutable QMutex m_mutex;
+    QHash<QString, FeedStats> m_feeds;
+};
+
+#endif // FEEDMETRICS_H
\ No newline at end of file
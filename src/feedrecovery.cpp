@@ -0,0 +1,387 @@
+#include "feedrecovery.h"
+#include "htmlscanner.h"
+
+#include <QTextCodec>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+namespace {
+
+// Elements whose content is text, where feeds often embed unescaped HTML.
+// content:encoded must come before content for the prefix match.
+const char *const TextElements[] = { "title", "description", "summary", "content:encoded", "content" };
+
+void note(QStringList *fixes, const QString &fix)
+{
+    if (fixes && !fixes->contains(fix)) {
+        fixes->append(fix);
+    }
+}
+
+bool isNameEnd(char c)
+{
+    return c == '>' || c == '/' || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isAlnum(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+bool isHexDigit(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// Length of the CDATA section or comment starting at pos, 0 if there is none
+int skipLength(const QByteArray &data, int pos)
+{
+    static const QByteArray cdataStart("<![CDATA[");
+    static const QByteArray commentStart("<!--");
+
+    if (data.mid(pos, cdataStart.size()) == cdataStart) {
+        int end = data.indexOf("]]>", pos + cdataStart.size());
+        return end < 0 ? data.size() - pos : end + 3 - pos;
+    }
+    if (data.mid(pos, commentStart.size()) == commentStart) {
+        int end = data.indexOf("-->", pos + commentStart.size());
+        return end < 0 ? data.size() - pos : end + 3 - pos;
+    }
+    return 0;
+}
+
+// True if the text holds markup outside CDATA sections
+bool containsRawMarkup(const QByteArray &text)
+{
+    int pos = 0;
+    while ((pos = text.indexOf('<', pos)) >= 0) {
+        int skip = skipLength(text, pos);
+        if (skip == 0) {
+            return true;
+        }
+        pos += skip;
+    }
+    return false;
+}
+
+} // namespace
+
+QByteArray FeedRecovery::repair(const QByteArray &payload, const QByteArray &contentType, QStringList *fixes)
+{
+    QByteArray data = toUtf8(payload, contentType, fixes);
+    data = stripControlCharacters(data, fixes);
+    data = trimToDocument(data, fixes);
+    data = closeCdataSections(data, fixes);
+    data = wrapMarkup(data, fixes);
+    data = escapeAmpersands(data, fixes);
+    return data;
+}
+
+QByteArray FeedRecovery::toUtf8(const QByteArray &payload, const QByteArray &contentType, QStringList *fixes)
+{
+    QTextCodec *utf8 = QTextCodec::codecForName("UTF-8");
+    QTextCodec *codec = QTextCodec::codecForUtfText(payload, nullptr);
+    bool relabel = false;
+
+    if (codec) {
+        // A byte order mark decides the encoding outright; toUnicode drops it
+        note(fixes, QStringLiteral("byte order mark"));
+        relabel = codec != utf8;
+    } else {
+        // Declared encoding, then the HTTP charset, then UTF-8
+        QByteArray declared;
+        QRegularExpressionMatch match = QRegularExpression(QStringLiteral("^\\s*<\\?xml[^>]*encoding\\s*=\\s*[\"']([A-Za-z0-9._:-]+)[\"']"))
+                                            .match(QString::fromLatin1(payload.left(256)));
+        if (match.hasMatch()) {
+            declared = match.captured(1).toLatin1();
+        } else {
+            match = QRegularExpression(QStringLiteral("charset\\s*=\\s*\"?([A-Za-z0-9._:-]+)"),
+                                       QRegularExpression::CaseInsensitiveOption)
+                        .match(QString::fromLatin1(contentType));
+            if (match.hasMatch()) {
+                declared = match.captured(1).toLatin1();
+            }
+        }
+
+        codec = declared.isEmpty() ? nullptr : QTextCodec::codecForName(declared);
+        if (!codec) {
+            codec = utf8;
+        }
+    }
+
+    QTextCodec::ConverterState state;
+    QString text = codec->toUnicode(payload.constData(), payload.size(), &state);
+
+    if (state.invalidChars > 0) {
+        // Mislabelled: Windows-1252 served as UTF-8, or UTF-8 labelled as something else
+        QTextCodec *fallback = codec == utf8 ? QTextCodec::codecForName("Windows-1252") : utf8;
+        QTextCodec::ConverterState fallbackState;
+        QString fallbackText = fallback->toUnicode(payload.constData(), payload.size(), &fallbackState);
+        if (fallbackState.invalidChars < state.invalidChars) {
+            note(fixes, QStringLiteral("encoding %1 instead of %2")
+                            .arg(QString::fromLatin1(fallback->name()), QString::fromLatin1(codec->name())));
+            text = fallbackText;
+            codec = fallback;
+        } else {
+            note(fixes, QStringLiteral("invalid %1 sequences").arg(QString::fromLatin1(codec->name())));
+        }
+    }
+    relabel = relabel || codec != utf8;
+
+    QByteArray data = text.toUtf8();
+
+    // The declaration must match the bytes we now hand to the parser
+    if (relabel && data.startsWith("<?xml")) {
+        int end = data.indexOf("?>");
+        if (end > 0) {
+            data.replace(0, end + 2, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+        }
+    }
+    return data;
+}
+
+QByteArray FeedRecovery::stripControlCharacters(const QByteArray &data, QStringList *fixes)
+{
+    auto isInvalid = [](uchar c) {
+        return c < 0x20 && c != '\t' && c != '\n' && c != '\r';
+    };
+
+    const char *begin = data.constData();
+    const char *end = begin + data.size();
+    const char *first = std::find_if(begin, end, [&](char c) { return isInvalid(uchar(c)); });
+    if (first == end) {
+        return data;
+    }
+
+    note(fixes, QStringLiteral("control characters"));
+    QByteArray out;
+    out.reserve(data.size());
+    out.append(begin, int(first - begin));
+    for (const char *p = first; p != end; ++p) {
+        if (!isInvalid(uchar(*p))) {
+            out.append(*p);
+        }
+    }
+    return out;
+}
+
+QByteArray FeedRecovery::trimToDocument(const QByteArray &data, QStringList *fixes)
+{
+    // Leading output such as server warnings before the first tag
+    int start = data.indexOf('<');
+    if (start < 0) {
+        return data;
+    }
+
+    // Anything after the root element is closed
+    int end = data.size();
+    static const char *const rootCloseTags[] = { "</rss>", "</feed>", "</rdf:RDF>" };
+    for (const char *tag : rootCloseTags) {
+        int close = data.lastIndexOf(tag);
+        if (close >= 0) {
+            end = close + int(qstrlen(tag));
+            break;
+        }
+    }
+
+    // Even whitespace is an error before the XML declaration
+    bool leading = start > 0;
+    bool trailing = !data.mid(end).trimmed().isEmpty();
+    if (!leading && !trailing) {
+        return data;
+    }
+
+    note(fixes, QStringLiteral("content outside the document"));
+    return data.mid(start, end - start);
+}
+
+QByteArray FeedRecovery::closeCdataSections(const QByteArray &data, QStringList *fixes)
+{
+    static const QByteArray cdataStart("<![CDATA[");
+
+    QByteArray out;
+    int pos = 0;
+    int scan = 0;
+
+    while ((scan = data.indexOf(cdataStart, scan)) >= 0) {
+        const int contentStart = scan + cdataStart.size();
+        const int end = data.indexOf("]]>", contentStart);
+
+        // A section belongs to the element whose start tag precedes it and
+        // must end before that element does
+        int close = -1;
+        QByteArray closeTag;
+        const int tagStart = scan > 0 ? data.lastIndexOf('<', scan - 1) : -1;
+        if (tagStart >= 0 && isAlnum(data.at(tagStart + 1))) {
+            int nameEnd = tagStart + 1;
+            while (nameEnd < scan && !isNameEnd(data.at(nameEnd))) {
+                ++nameEnd;
+            }
+            closeTag = "</" + data.mid(tagStart + 1, nameEnd - tagStart - 1) + ">";
+            close = data.indexOf(closeTag, contentStart);
+        }
+
+        if (close >= 0 && (end < 0 || end > close)) {
+            note(fixes, QStringLiteral("unclosed CDATA sections"));
+            out.append(data.constData() + pos, close - pos);
+            out.append("]]>");
+            pos = close;
+            scan = close + closeTag.size();
+        } else {
+            scan = end < 0 ? data.size() : end + 3;
+        }
+    }
+
+    if (pos == 0) {
+        return data;
+    }
+    out.append(data.constData() + pos, data.size() - pos);
+    return out;
+}
+
+QByteArray FeedRecovery::wrapMarkup(const QByteArray &data, QStringList *fixes)
+{
+    QByteArray out;
+    out.reserve(data.size() + 1024);
+    int pos = 0;
+    int scan = 0;
+
+    while (scan < data.size()) {
+        int lt = data.indexOf('<', scan);
+        if (lt < 0) {
+            break;
+        }
+
+        int skip = skipLength(data, lt);
+        if (skip > 0) {
+            scan = lt + skip;
+            continue;
+        }
+
+        // Opening tag of a text element?
+        const char *name = nullptr;
+        int nameLength = 0;
+        for (const char *candidate : TextElements) {
+            int length = int(qstrlen(candidate));
+            if (lt + 1 + length < data.size()
+                && qstrncmp(data.constData() + lt + 1, candidate, uint(length)) == 0
+                && isNameEnd(data.at(lt + 1 + length))) {
+                name = candidate;
+                nameLength = length;
+                break;
+            }
+        }
+
+        int tagEnd = data.indexOf('>', lt);
+        if (tagEnd < 0) {
+            break;
+        }
+        if (!name || data.at(tagEnd - 1) == '/') {
+            scan = tagEnd + 1;
+            continue;
+        }
+
+        QByteArray closeTag = "</" + QByteArray(name, nameLength) + ">";
+        int close = data.indexOf(closeTag, tagEnd + 1);
+        if (close < 0) {
+            scan = tagEnd + 1;
+            continue;
+        }
+
+        QByteArray inner = data.mid(tagEnd + 1, close - tagEnd - 1);
+        if (containsRawMarkup(inner)) {
+            note(fixes, QStringLiteral("unescaped HTML"));
+            out.append(data.constData() + pos, tagEnd + 1 - pos);
+            out.append("<![CDATA[");
+            out.append(inner.replace("]]>", "]]]]><![CDATA[>"));
+            out.append("]]>");
+            pos = close;
+        }
+        scan = close + closeTag.size();
+    }
+
+    if (pos == 0) {
+        return data;
+    }
+    out.append(data.constData() + pos, data.size() - pos);
+    return out;
+}
+
+QByteArray FeedRecovery::escapeAmpersands(const QByteArray &data, QStringList *fixes)
+{
+    QByteArray out;
+    out.reserve(data.size() + 256);
+    int pos = 0;
+    int scan = 0;
+
+    // One forward pass; CDATA sections and comments are stepped over whole,
+    // so markup inside them never looks like the end of the section
+    while (scan < data.size()) {
+        const char c = data.at(scan);
+        if (c == '<') {
+            const int skip = scan + 1 < data.size() && data.at(scan + 1) == '!' ? skipLength(data, scan) : 0;
+            scan += skip > 0 ? skip : 1;
+            continue;
+        }
+        if (c != '&') {
+            ++scan;
+            continue;
+        }
+
+        const int amp = scan;
+        int p = amp + 1;
+        bool valid = false;
+        QByteArray replacement;
+
+        if (p < data.size() && data.at(p) == '#') {
+            // Numeric reference
+            ++p;
+            bool hex = p < data.size() && (data.at(p) == 'x' || data.at(p) == 'X');
+            if (hex) {
+                ++p;
+            }
+            int digits = p;
+            while (p < data.size() && (hex ? isHexDigit(data.at(p)) : (data.at(p) >= '0' && data.at(p) <= '9'))) {
+                ++p;
+            }
+            valid = p > digits && p < data.size() && data.at(p) == ';';
+        } else {
+            while (p < data.size() && isAlnum(data.at(p)) && p - amp <= 10) {
+                ++p;
+            }
+            if (p > amp + 1 && p < data.size() && data.at(p) == ';') {
+                QByteArray entity = data.mid(amp + 1, p - amp - 1);
+                if (entity == "amp" || entity == "lt" || entity == "gt" || entity == "quot" || entity == "apos") {
+                    valid = true;
+                } else if (HtmlScanner::entityCodePoint(entity) >= 0) {
+                    // HTML entities are undefined in XML, use the code point
+                    replacement = "&#" + QByteArray::number(HtmlScanner::entityCodePoint(entity)) + ";";
+                    note(fixes, QStringLiteral("HTML entities"));
+                }
+            }
+        }
+
+        if (valid) {
+            scan = p + 1;
+            continue;
+        }
+
+        out.append(data.constData() + pos, amp - pos);
+        if (!replacement.isEmpty()) {
+            out.append(replacement);
+            pos = p + 1;
+        } else {
+            note(fixes, QStringLiteral("unescaped ampersands"));
+            out.append("&amp;");
+            pos = amp + 1;
+        }
+        scan = pos;
+    }
+
+    if (pos == 0) {
+        return data;
+    }
+    out.append(data.constData() + pos, data.size() - pos);
+    return out;
+}
\ No newline at end of file
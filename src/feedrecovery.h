@@ -0,0 +1,28 @@
+#ifndef FEEDRECOVERY_H
+#define FEEDRECOVERY_H
+
+#include <QByteArray>
+#include <QStringList>
+
+// Repairs the usual ways real-world feeds break XML so the normal parser can
+// read them: byte order marks, mislabelled encodings, control characters,
+// raw HTML inside text elements, unclosed CDATA sections, unescaped
+// ampersands and junk around the document. Works on the already downloaded
+// bytes.
+class FeedRecovery
+{
+public:
+    // Returns a UTF-8 document; fixes, if given, lists what was changed
+    static QByteArray repair(const QByteArray &payload, const QByteArray &contentType,
+                             QStringList *fixes = nullptr);
+
+private:
+    static QByteArray toUtf8(const QByteArray &payload, const QByteArray &contentType, QStringList *fixes);
+    static QByteArray stripControlCharacters(const QByteArray &data, QStringList *fixes);
+    static QByteArray closeCdataSections(const QByteArray &data, QStringList *fixes);
+    static QByteArray wrapMarkup(const QByteArray &data, QStringList *fixes);
+    static QByteArray escapeAmpersands(const QByteArray &data, QStringList *fixes);
+    static QByteArray trimToDocument(const QByteArray &data, QStringList *fixes);
+};
+
+#endif // FEEDRECOVERY_H
\ No newline at end of file
@@ -0,0 +1,566 @@
+#include "htmlscanner.h"
+#include "bytescanner.h"
+
+#include <QHash>
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+struct Attribute {
+    QByteArray name;  // lower case
+    QByteArray value; // entities decoded
+};
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+bool isAlpha(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool isNameChar(char c)
+{
+    return isAlpha(c) || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == ':';
+}
+
+char toLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+// Case-insensitive compare of [begin, end) against a lower case name
+bool nameIs(const char *begin, const char *end, const char *name)
+{
+    size_t length = std::strlen(name);
+    if (size_t(end - begin) != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        if (toLower(begin[i]) != name[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool startsWith(const char *p, const char *end, const char *prefix)
+{
+    size_t length = std::strlen(prefix);
+    return size_t(end - p) >= length && std::memcmp(p, prefix, length) == 0;
+}
+
+const char *find(const char *p, const char *end, const char *needle)
+{
+    size_t length = std::strlen(needle);
+    while (size_t(end - p) >= length) {
+        const char *hit = static_cast<const char *>(std::memchr(p, needle[0], size_t(end - p)));
+        if (!hit || size_t(end - hit) < length) {
+            return nullptr;
+        }
+        if (std::memcmp(hit, needle, length) == 0) {
+            return hit;
+        }
+        p = hit + 1;
+    }
+    return nullptr;
+}
+
+// Elements that separate text, rendered as a line break in plain text
+bool isBlock(const char *begin, const char *end)
+{
+    static const char *const blocks[] = {
+        "p", "br", "div", "li", "ul", "ol", "tr", "table", "blockquote", "section", "article",
+        "h1", "h2", "h3", "h4", "h5", "h6", "hr", "figure", "figcaption", "pre"
+    };
+    for (const char *block : blocks) {
+        if (nameIs(begin, end, block)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int encodeUtf8(uint cp, char *out)
+{
+    if (cp < 0x80) {
+        out[0] = char(cp);
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = char(0xC0 | (cp >> 6));
+        out[1] = char(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = char(0xE0 | (cp >> 12));
+        out[1] = char(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = char(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = char(0xF0 | (cp >> 18));
+    out[1] = char(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = char(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = char(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Decodes the entity at p ('&'), returns the bytes consumed or 0 if there is none
+int decodeEntity(const char *p, const char *end, uint *cp)
+{
+    const char *q = p + 1;
+    if (q < end && *q == '#') {
+        ++q;
+        bool hex = q < end && (*q == 'x' || *q == 'X');
+        if (hex) {
+            ++q;
+        }
+        const char *digits = q;
+        uint value = 0;
+        while (q < end && q - digits < 8) {
+            char c = *q;
+            int digit = (c >= '0' && c <= '9') ? c - '0'
+                      : (hex && c >= 'a' && c <= 'f') ? c - 'a' + 10
+                      : (hex && c >= 'A' && c <= 'F') ? c - 'A' + 10
+                      : -1;
+            if (digit < 0) {
+                break;
+            }
+            value = value * (hex ? 16 : 10) + uint(digit);
+            ++q;
+        }
+        if (q == digits || q >= end || *q != ';') {
+            return 0;
+        }
+        bool valid = value > 0 && value <= 0x10FFFF && (value < 0xD800 || value > 0xDFFF);
+        *cp = valid ? value : 0xFFFD;
+        return int(q + 1 - p);
+    }
+
+    const char *name = q;
+    while (q < end && q - name <= 10 && ((*q >= 'a' && *q <= 'z') || (*q >= 'A' && *q <= 'Z') || (*q >= '0' && *q <= '9'))) {
+        ++q;
+    }
+    if (q == name || q >= end || *q != ';') {
+        return 0;
+    }
+    int value = HtmlScanner::entityCodePoint(QByteArray::fromRawData(name, int(q - name)));
+    if (value < 0) {
+        return 0;
+    }
+    *cp = uint(value);
+    return int(q + 1 - p);
+}
+
+QByteArray decodeEntities(const char *p, const char *end)
+{
+    const char *amp = static_cast<const char *>(std::memchr(p, '&', size_t(end - p)));
+    if (!amp) {
+        return QByteArray(p, int(end - p));
+    }
+
+    // Copy the runs between entities in bulk
+    QByteArray out;
+    out.reserve(int(end - p));
+    while (amp) {
+        out.append(p, int(amp - p));
+        uint cp;
+        int length = decodeEntity(amp, end, &cp);
+        if (length > 0) {
+            char buffer[4];
+            out.append(buffer, encodeUtf8(cp, buffer));
+            p = amp + length;
+        } else {
+            out.append('&');
+            p = amp + 1;
+        }
+        amp = static_cast<const char *>(std::memchr(p, '&', size_t(end - p)));
+    }
+    out.append(p, int(end - p));
+    return out;
+}
+
+// End of the tag starting before p, skipping '>' inside quoted values
+const char *findTagEnd(const char *p, const char *end)
+{
+    while ((p = ByteScanner::findFirstOf(p, end, '>', '"', '\'')) < end) {
+        if (*p == '>') {
+            return p;
+        }
+        const char *close = static_cast<const char *>(std::memchr(p + 1, *p, size_t(end - p - 1)));
+        if (!close) {
+            return end;
+        }
+        p = close + 1;
+    }
+    return end;
+}
+
+QVector<Attribute> parseAttributes(const char *p, const char *end)
+{
+    QVector<Attribute> attributes;
+    while (p < end) {
+        while (p < end && (isSpace(*p) || *p == '/')) {
+            ++p;
+        }
+        const char *nameStart = p;
+        while (p < end && !isSpace(*p) && *p != '=' && *p != '/') {
+            ++p;
+        }
+        if (p == nameStart) {
+            break;
+        }
+
+        Attribute attribute;
+        attribute.name.reserve(int(p - nameStart));
+        for (const char *c = nameStart; c < p; ++c) {
+            attribute.name.append(toLower(*c));
+        }
+
+        while (p < end && isSpace(*p)) {
+            ++p;
+        }
+        if (p < end && *p == '=') {
+            ++p;
+            while (p < end && isSpace(*p)) {
+                ++p;
+            }
+            const char *valueStart = p;
+            const char *valueEnd;
+            if (p < end && (*p == '"' || *p == '\'')) {
+                char quote = *p++;
+                valueStart = p;
+                while (p < end && *p != quote) {
+                    ++p;
+                }
+                valueEnd = p;
+                if (p < end) {
+                    ++p;
+                }
+            } else {
+                while (p < end && !isSpace(*p)) {
+                    ++p;
+                }
+                valueEnd = p;
+            }
+            attribute.value = decodeEntities(valueStart, valueEnd).trimmed();
+        }
+        attributes.append(attribute);
+    }
+    return attributes;
+}
+
+QByteArray attributeValue(const QVector<Attribute> &attributes, const char *name)
+{
+    for (const Attribute &attribute : attributes) {
+        if (attribute.name == name) {
+            return attribute.value;
+        }
+    }
+    return QByteArray();
+}
+
+// Leading digits only, so "300px" reads as 300
+int leadingNumber(const QByteArray &value)
+{
+    int number = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') {
+            break;
+        }
+        number = number * 10 + (c - '0');
+    }
+    return number;
+}
+
+// Largest candidate of a srcset, by width or pixel density
+QByteArray bestSrcsetCandidate(const QByteArray &srcset)
+{
+    QByteArray best;
+    int bestSize = -1;
+    for (const QByteArray &candidate : srcset.split(',')) {
+        QList<QByteArray> parts = candidate.simplified().split(' ');
+        if (parts.isEmpty() || parts.first().isEmpty()) {
+            continue;
+        }
+        int size = 1;
+        if (parts.size() > 1) {
+            const QByteArray &descriptor = parts.at(1);
+            size = descriptor.endsWith('x') ? int(descriptor.chopped(1).toDouble() * 1000) : leadingNumber(descriptor);
+        }
+        if (size > bestSize) {
+            best = parts.first();
+            bestSize = size;
+        }
+    }
+    return best;
+}
+
+// Keeps the most plausible lead image of the body
+struct ImagePicker {
+    QByteArray best;
+    int bestScore = -1;
+
+    void consider(const QVector<Attribute> &attributes)
+    {
+        int width = leadingNumber(attributeValue(attributes, "width"));
+        int height = leadingNumber(attributeValue(attributes, "height"));
+        if ((width > 0 && width <= 2) || (height > 0 && height <= 2)) {
+            return; // tracking pixel
+        }
+
+        // Lazy loaders keep the real image in data-* and a placeholder in src
+        QByteArray url;
+        static const char *const lazyAttributes[] = { "data-src", "data-lazy-src", "data-original" };
+        for (const char *name : lazyAttributes) {
+            url = attributeValue(attributes, name);
+            if (!url.isEmpty() && !url.startsWith("data:")) {
+                break;
+            }
+            url.clear();
+        }
+        if (url.isEmpty()) {
+            url = bestSrcsetCandidate(attributeValue(attributes, "data-srcset"));
+        }
+        if (url.isEmpty()) {
+            url = bestSrcsetCandidate(attributeValue(attributes, "srcset"));
+        }
+        if (url.isEmpty()) {
+            url = attributeValue(attributes, "src");
+        }
+        if (url.isEmpty() || url.startsWith("data:")) {
+            return;
+        }
+
+        // Earlier images win unless a later one is declared larger
+        int score = width > 0 ? width : 300;
+        if (score > bestScore) {
+            best = url;
+            bestScore = score;
+        }
+    }
+};
+
+// Collects text with collapsed whitespace and counts words
+class TextSink
+{
+public:
+    TextSink(int byteLimit, bool keepLines) : m_limit(byteLimit), m_keepLines(keepLines) {}
+
+    void append(const char *p, int length)
+    {
+        const char *end = p + length;
+        while (p < end) {
+            // Whole words at a time, whitespace runs collapse to one separator
+            const char *space = ByteScanner::findFirstOf(p, end, ' ', '\n', '\t', '\r');
+            if (space > p) {
+                put(p, int(space - p));
+            }
+            p = space;
+            while (p < end && isSpace(*p)) {
+                separate(false);
+                ++p;
+            }
+        }
+    }
+
+    void appendCodePoint(uint cp)
+    {
+        if (cp == ' ' || cp == 0xA0 || cp < 0x20) {
+            separate(false);
+        } else {
+            char buffer[4];
+            put(buffer, encodeUtf8(cp, buffer));
+        }
+    }
+
+    void breakLine() { separate(true); }
+
+    int words = 0;
+    QByteArray text;
+
+private:
+    int m_limit;
+    bool m_keepLines;
+    bool m_inWord = false;
+    char m_pending = 0;
+
+    void separate(bool line)
+    {
+        m_inWord = false;
+        if (line && m_keepLines) {
+            m_pending = '\n';
+        } else if (m_pending != '\n') {
+            m_pending = ' ';
+        }
+    }
+
+    void put(const char *p, int length)
+    {
+        if (!m_inWord) {
+            ++words;
+            m_inWord = true;
+        }
+        if (m_limit >= 0 && text.size() >= m_limit) {
+            return;
+        }
+        if (m_pending && !text.isEmpty()) {
+            text.append(m_pending);
+        }
+        m_pending = 0;
+        text.append(p, m_limit >= 0 ? qMin(length, m_limit - text.size()) : length);
+    }
+};
+
+void scanHtml(const QByteArray &html, TextSink &sink, QStringList *links, ImagePicker *images)
+{
+    const char *p = html.constData();
+    const char *end = p + html.size();
+
+    while (p < end) {
+        if (*p == '&') {
+            uint cp;
+            int length = decodeEntity(p, end, &cp);
+            if (length > 0) {
+                sink.appendCodePoint(cp);
+                p += length;
+            } else {
+                sink.append(p++, 1);
+            }
+            continue;
+        }
+
+        if (*p != '<') {
+            // Plain run up to the next markup character
+            const char *q = ByteScanner::findFirstOf(p, end, '<', '&');
+            sink.append(p, int(q - p));
+            p = q;
+            continue;
+        }
+
+        if (startsWith(p, end, "<!--")) {
+            const char *close = find(p + 4, end, "-->");
+            p = close ? close + 3 : end;
+            continue;
+        }
+        if (startsWith(p, end, "<![CDATA[")) {
+            const char *close = find(p + 9, end, "]]>");
+            const char *textEnd = close ? close : end;
+            sink.append(p + 9, int(textEnd - p - 9));
+            p = close ? close + 3 : end;
+            continue;
+        }
+
+        bool closing = p + 1 < end && p[1] == '/';
+        const char *nameStart = p + 1 + (closing ? 1 : 0);
+        if (nameStart >= end || !isAlpha(*nameStart)) {
+            if (nameStart < end && (*nameStart == '!' || *nameStart == '?')) {
+                // Doctype or processing instruction
+                const char *close = findTagEnd(nameStart, end);
+                p = close < end ? close + 1 : end;
+            } else {
+                sink.append(p++, 1); // a literal '<'
+            }
+            continue;
+        }
+
+        const char *nameEnd = nameStart;
+        while (nameEnd < end && isNameChar(*nameEnd)) {
+            ++nameEnd;
+        }
+        const char *tagEnd = findTagEnd(nameEnd, end);
+
+        if (!closing) {
+            if (nameIs(nameStart, nameEnd, "script") || nameIs(nameStart, nameEnd, "style")) {
+                // Skip the body up to the matching close tag
+                const char *closeName = nameIs(nameStart, nameEnd, "script") ? "script" : "style";
+                const char *nameLimit = nullptr;
+                const char *q = tagEnd;
+                const char *close = nullptr;
+                while (q < end && (q = static_cast<const char *>(std::memchr(q, '<', size_t(end - q))))) {
+                    nameLimit = std::min(q + 2 + std::strlen(closeName), end);
+                    if (q + 1 < end && q[1] == '/' && nameIs(q + 2, nameLimit, closeName)) {
+                        close = findTagEnd(q, end);
+                        break;
+                    }
+                    ++q;
+                }
+                sink.breakLine();
+                p = close && close < end ? close + 1 : end;
+                continue;
+            }
+
+            if (images && nameIs(nameStart, nameEnd, "img")) {
+                images->consider(parseAttributes(nameEnd, tagEnd));
+            } else if (links && links->size() < HtmlScanner::MaxLinks && nameIs(nameStart, nameEnd, "a")) {
+                QByteArray href = attributeValue(parseAttributes(nameEnd, tagEnd), "href");
+                QByteArray scheme = href.left(8).toLower();
+                if (scheme.startsWith("http://") || scheme.startsWith("https://")) {
+                    QString link = QString::fromUtf8(href);
+                    if (!links->contains(link)) {
+                        links->append(link);
+                    }
+                }
+            }
+        }
+
+        if (isBlock(nameStart, nameEnd)) {
+            sink.breakLine();
+        }
+        p = tagEnd < end ? tagEnd + 1 : end;
+    }
+}
+
+} // namespace
+
+HtmlSummary HtmlScanner::scan(const QByteArray &html)
+{
+    HtmlSummary summary;
+    if (html.isEmpty()) {
+        return summary;
+    }
+
+    // Enough bytes for SnippetLength characters plus one to detect truncation
+    TextSink sink((SnippetLength + 1) * 4, false);
+    ImagePicker images;
+    scanHtml(html, sink, &summary.links, &images);
+
+    summary.wordCount = sink.words;
+    summary.imageUrl = QString::fromUtf8(images.best);
+
+    QString text = QString::fromUtf8(sink.text);
+    if (text.size() > SnippetLength) {
+        int cut = text.lastIndexOf(QLatin1Char(' '), SnippetLength);
+        text = text.left(cut > SnippetLength / 2 ? cut : SnippetLength) + QChar(0x2026);
+    }
+    summary.snippet = text;
+    return summary;
+}
+
+QString HtmlScanner::toPlainText(const QString &html)
+{
+    TextSink sink(-1, true);
+    scanHtml(html.toUtf8(), sink, nullptr, nullptr);
+    return QString::fromUtf8(sink.text);
+}
+
+int HtmlScanner::entityCodePoint(const QByteArray &name)
+{
+    static const QHash<QByteArray, int> entities = {
+        { "amp", '&' }, { "lt", '<' }, { "gt", '>' }, { "quot", '"' }, { "apos", '\'' },
+        { "nbsp", 160 }, { "iexcl", 161 }, { "pound", 163 }, { "copy", 169 }, { "laquo", 171 },
+        { "reg", 174 }, { "deg", 176 }, { "middot", 183 }, { "raquo", 187 }, { "times", 215 },
+        { "szlig", 223 }, { "agrave", 224 }, { "aacute", 225 }, { "auml", 228 }, { "ccedil", 231 },
+        { "egrave", 232 }, { "eacute", 233 }, { "iacute", 237 }, { "ntilde", 241 }, { "oacute", 243 },
+        { "ouml", 246 }, { "uacute", 250 }, { "uuml", 252 }, { "Auml", 196 }, { "Eacute", 201 },
+        { "Ouml", 214 }, { "Uuml", 220 }, { "ndash", 8211 }, { "mdash", 8212 }, { "lsquo", 8216 },
+        { "rsquo", 8217 }, { "sbquo", 8218 }, { "ldquo", 8220 }, { "rdquo", 8221 }, { "bdquo", 8222 },
+        { "bull", 8226 }, { "hellip", 8230 }, { "prime", 8242 }, { "euro", 8364 }, { "trade", 8482 }
+    };
+    return entities.value(name, -1);
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef HTMLSCANNER_H
+#define HTMLSCANNER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+// What ingest keeps from an item's HTML body
+struct HtmlSummary {
+    QString imageUrl;   // best lead image candidate, empty if none
+    QString snippet;    // leading plain text, whitespace collapsed
+    int wordCount = 0;
+    QStringList links;  // absolute outbound http(s) links, in document order
+};
+
+// Single-pass, tolerant scanner over UTF-8 HTML fragments. It never builds a
+// DOM: tags are tokenized in place, script and style bodies are skipped and
+// entities are decoded as text is emitted.
+class HtmlScanner
+{
+public:
+    static const int SnippetLength = 280;
+    static const int MaxLinks = 32;
+
+    static HtmlSummary scan(const QByteArray &html);
+    static HtmlSummary scan(const QString &html) { return scan(html.toUtf8()); }
+
+    // Full text with block elements on their own lines
+    static QString toPlainText(const QString &html);
+
+    // Code point of a named HTML entity, -1 if unknown
+    static int entityCodePoint(const QByteArray &name);
+};
+
+#endif // HTMLSCANNER_H
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include "jsonfeedreader.h"
+#include "bytescanner.h"
+
+#include <cstring>
+
+namespace {
+
+const int MaxDepth = 64;
+
+} // namespace
+
+JsonFeedReader::JsonFeedReader(const QByteArray &data)
+    : m_begin(data.constData()),
+      m_pos(data.constData()),
+      m_end(data.constData() + data.size())
+{
+}
+
+bool JsonFeedReader::readItems(const std::function<void(FeedItem &)> &onItem)
+{
+    // Tolerate a UTF-8 byte order mark
+    if (m_end - m_pos >= 3 && std::memcmp(m_pos, "\xEF\xBB\xBF", 3) == 0) {
+        m_pos += 3;
+    }
+
+    if (!expect('{')) {
+        return false;
+    }
+
+    bool sawItems = false;
+    if (!consume('}')) {
+        do {
+            QByteArray key;
+            if (!readKey(&key) || !expect(':')) {
+                return false;
+            }
+
+            if (key == "items") {
+                if (!expect('[')) {
+                    return false;
+                }
+                sawItems = true;
+                if (!consume(']')) {
+                    do {
+                        FeedItem item;
+                        if (!readItem(item)) {
+                            return false;
+                        }
+                        onItem(item);
+                    } while (consume(','));
+
+                    if (!expect(']')) {
+                        return false;
+                    }
+                }
+            } else if (!skipValue()) {
+                return false;
+            }
+        } while (consume(','));
+
+        if (!expect('}')) {
+            return false;
+        }
+    }
+
+    if (!sawItems) {
+        return fail(QStringLiteral("not a JSON Feed, no items array"));
+    }
+    return true;
+}
+
+bool JsonFeedReader::readItem(FeedItem &item)
+{
+    if (!expect('{')) {
+        return false;
+    }
+
+    QString id, url, externalUrl, title, contentHtml, contentText, summary, image, bannerImage;
+    QString published, modified;
+    QStringList tags;
+
+    if (!consume('}')) {
+        do {
+            QByteArray key;
+            if (!readKey(&key) || !expect(':')) {
+                return false;
+            }
+
+            bool ok;
+            if (key == "id") {
+                ok = readScalar(&id); // should be a string, numbers are common
+            } else if (key == "url") {
+                ok = readScalar(&url);
+            } else if (key == "external_url") {
+                ok = readScalar(&externalUrl);
+            } else if (key == "title") {
+                ok = readScalar(&title);
+            } else if (key == "content_html") {
+                ok = readScalar(&contentHtml);
+            } else if (key == "content_text") {
+                ok = readScalar(&contentText);
+            } else if (key == "summary") {
+                ok = readScalar(&summary);
+            } else if (key == "image") {
+                ok = readScalar(&image);
+            } else if (key == "banner_image") {
+                ok = readScalar(&bannerImage);
+            } else if (key == "date_published") {
+                ok = readScalar(&published);
+            } else if (key == "date_modified") {
+                ok = readScalar(&modified);
+            } else if (key == "tags") {
+                ok = readTags(&tags);
+            } else {
+                ok = skipValue();
+            }
+
+            if (!ok) {
+                return false;
+            }
+        } while (consume(','));
+
+        if (!expect('}')) {
+            return false;
+        }
+    }
+
+    // Map onto the RSS shaped item; the body is always HTML
+    QString description = contentHtml;
+    if (description.isEmpty() && !contentText.isEmpty()) {
+        description = "<p>" + contentText.toHtmlEscaped().replace('\n', "<br>") + "</p>";
+    }
+    if (description.isEmpty() && !summary.isEmpty()) {
+        description = "<p>" + summary.toHtmlEscaped() + "</p>";
+    }
+
+    // Titles are optional in JSON Feed, microblog items only have text
+    if (title.isEmpty()) {
+        QString text = !summary.isEmpty() ? summary : contentText;
+        title = text.simplified().left(80);
+    }
+
+    item.title = title;
+    item.setGuid(id);
+    item.setLink(!url.isEmpty() ? url : externalUrl);
+    item.setDescription(description);
+    item.setImageUrl(!image.isEmpty() ? image : bannerImage);
+    item.pubDate = !published.isEmpty() ? published : modified;
+    for (const QString &tag : tags) {
+        item.addCategory(tag);
+    }
+    return true;
+}
+
+bool JsonFeedReader::readTags(QStringList *tags)
+{
+    if (peek() != '[') {
+        return skipValue();
+    }
+    expect('[');
+    if (consume(']')) {
+        return true;
+    }
+
+    do {
+        QString tag;
+        if (!readScalar(&tag)) {
+            return false;
+        }
+        tags->append(tag);
+    } while (consume(','));
+
+    return expect(']');
+}
+
+void JsonFeedReader::skipWhitespace()
+{
+    while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' || *m_pos == '\t')) {
+        ++m_pos;
+    }
+}
+
+char JsonFeedReader::peek()
+{
+    skipWhitespace();
+    return m_pos < m_end ? *m_pos : '\0';
+}
+
+bool JsonFeedReader::consume(char c)
+{
+    if (peek() == c) {
+        ++m_pos;
+        return true;
+    }
+    return false;
+}
+
+bool JsonFeedReader::expect(char c)
+{
+    if (consume(c)) {
+        return true;
+    }
+    return fail(QStringLiteral("expected '%1'").arg(QLatin1Char(c)));
+}
+
+bool JsonFeedReader::readString(QString *out)
+{
+    if (!expect('"')) {
+        return false;
+    }
+
+    // Fast path: no escapes, decode the run straight from the buffer
+    const char *stop = ByteScanner::findFirstOf(m_pos, m_end, '"', '\\');
+    if (stop < m_end && *stop == '"') {
+        *out = QString::fromUtf8(m_pos, int(stop - m_pos));
+        m_pos = stop + 1;
+        return true;
+    }
+
+    QByteArray buffer;
+    buffer.reserve(int(stop - m_pos) + 64);
+    while (stop < m_end) {
+        buffer.append(m_pos, int(stop - m_pos));
+        m_pos = stop;
+        if (*m_pos == '"') {
+            ++m_pos;
+            *out = QString::fromUtf8(buffer);
+            return true;
+        }
+
+        // Escape sequence
+        if (m_end - m_pos < 2) {
+            break;
+        }
+        char escaped = m_pos[1];
+        m_pos += 2;
+        switch (escaped) {
+        case '"': buffer.append('"'); break;
+        case '\\': buffer.append('\\'); break;
+        case '/': buffer.append('/'); break;
+        case 'b': buffer.append('\b'); break;
+        case 'f': buffer.append('\f'); break;
+        case 'n': buffer.append('\n'); break;
+        case 'r': buffer.append('\r'); break;
+        case 't': buffer.append('\t'); break;
+        case 'u': {
+            auto readHex = [this](uint *value) {
+                if (m_end - m_pos < 4) {
+                    return false;
+                }
+                bool ok;
+                *value = QByteArray(m_pos, 4).toUInt(&ok, 16);
+                m_pos += 4;
+                return ok;
+            };
+            uint cp;
+            if (!readHex(&cp)) {
+                return fail(QStringLiteral("bad \\u escape"));
+            }
+            // Surrogate pair
+            if (cp >= 0xD800 && cp <= 0xDBFF && m_end - m_pos >= 6 && m_pos[0] == '\\' && m_pos[1] == 'u') {
+                m_pos += 2;
+                uint low;
+                if (!readHex(&low)) {
+                    return fail(QStringLiteral("bad \\u escape"));
+                }
+                cp = (low >= 0xDC00 && low <= 0xDFFF) ? 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00) : 0xFFFD;
+            } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+                cp = 0xFFFD;
+            }
+            buffer.append(QString::fromUcs4(&cp, 1).toUtf8());
+            break;
+        }
+        default:
+            return fail(QStringLiteral("bad escape"));
+        }
+
+        stop = ByteScanner::findFirstOf(m_pos, m_end, '"', '\\');
+    }
+
+    return fail(QStringLiteral("unterminated string"));
+}
+
+bool JsonFeedReader::readKey(QByteArray *key)
+{
+    QString value;
+    if (peek() != '"') {
+        return fail(QStringLiteral("expected a key"));
+    }
+    // Keys are short ASCII; avoid the QString round trip when unescaped
+    const char *start = m_pos + 1;
+    const char *stop = ByteScanner::findFirstOf(start, m_end, '"', '\\');
+    if (stop < m_end && *stop == '"') {
+        *key = QByteArray(start, int(stop - start));
+        m_pos = stop + 1;
+        return true;
+    }
+    if (!readString(&value)) {
+        return false;
+    }
+    *key = value.toUtf8();
+    return true;
+}
+
+bool JsonFeedReader::readScalar(QString *out)
+{
+    char c = peek();
+    if (c == '"') {
+        return readString(out);
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        const char *start = m_pos;
+        while (m_pos < m_end && std::strchr("+-0123456789.eE", *m_pos)) {
+            ++m_pos;
+        }
+        *out = QString::fromLatin1(start, int(m_pos - start));
+        return true;
+    }
+    // null, booleans, objects and arrays carry nothing we keep
+    out->clear();
+    return skipValue();
+}
+
+bool JsonFeedReader::skipString()
+{
+    if (!expect('"')) {
+        return false;
+    }
+    while (m_pos < m_end) {
+        const char *stop = ByteScanner::findFirstOf(m_pos, m_end, '"', '\\');
+        if (stop >= m_end) {
+            break;
+        }
+        if (*stop == '"') {
+            m_pos = stop + 1;
+            return true;
+        }
+        m_pos = stop + 2;
+    }
+    return fail(QStringLiteral("unterminated string"));
+}
+
+bool JsonFeedReader::skipValue()
+{
+    // Iterative, with a stack of open containers
+    char stack[MaxDepth];
+    int depth = 0;
+
+    do {
+        char c = peek();
+        if (c == '"') {
+            if (!skipString()) {
+                return false;
+            }
+        } else if (c == '{' || c == '[') {
+            if (depth == MaxDepth) {
+                return fail(QStringLiteral("nesting too deep"));
+            }
+            stack[depth++] = c == '{' ? '}' : ']';
+            ++m_pos;
+            if (consume(stack[depth - 1])) {
+                --depth;
+            } else {
+                if (c == '{' && (!skipString() || !expect(':'))) {
+                    return false;
+                }
+                continue;
+            }
+        } else if (c == 't' || c == 'f' || c == 'n') {
+            const char *literal = c == 't' ? "true" : c == 'f' ? "false" : "null";
+            size_t length = std::strlen(literal);
+            if (size_t(m_end - m_pos) < length || std::memcmp(m_pos, literal, length) != 0) {
+                return fail(QStringLiteral("bad literal"));
+            }
+            m_pos += length;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            while (m_pos < m_end && std::strchr("+-0123456789.eE", *m_pos)) {
+                ++m_pos;
+            }
+        } else {
+            return fail(QStringLiteral("unexpected character"));
+        }
+
+        // After a value: next member, or close containers
+        while (depth > 0) {
+            if (consume(',')) {
+                if (stack[depth - 1] == '}' && (!skipString() || !expect(':'))) {
+                    return false;
+                }
+                break;
+            }
+            if (!expect(stack[depth - 1])) {
+                return false;
+            }
+            --depth;
+        }
+    } while (depth > 0);
+
+    return true;
+}
+
+bool JsonFeedReader::fail(const QString &message)
+{
+    if (m_error.isEmpty()) {
+        m_error = QStringLiteral("%1 at offset %2").arg(message).arg(m_pos - m_begin);
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef JSONFEEDREADER_H
+#define JSONFEEDREADER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+
+#include "feeditem.h"
+
+// Pull reader for JSON Feed 1.0/1.1 (https://jsonfeed.org). Walks the
+// buffer once and hands each item to a callback as soon as it is complete;
+// no QJsonDocument is built and values of unknown keys are skipped without
+// being decoded.
+class JsonFeedReader
+{
+public:
+    explicit JsonFeedReader(const QByteArray &data);
+
+    // Returns false if the document is not well-formed JSON Feed. Items
+    // delivered before an error are not taken back.
+    bool readItems(const std::function<void(FeedItem &)> &onItem);
+
+    QString errorString() const { return m_error; }
+
+private:
+    const char *m_begin;
+    const char *m_pos;
+    const char *m_end;
+    QString m_error;
+
+    bool readItem(FeedItem &item);
+    bool readTags(QStringList *tags);
+
+    // Tokenizer
+    void skipWhitespace();
+    bool consume(char c);
+    bool expect(char c);
+    char peek();
+    bool readString(QString *out);
+    bool readKey(QByteArray *key);
+    bool readScalar(QString *out);
+    bool skipValue();
+    bool skipString();
+    bool fail(const QString &message);
+};
+
+#endif // JSONFEEDREADER_H
\ No newline at end of file
@@ -0,0 +1,559 @@
+#include "localapiserver.h"
+#include "rssparser.h"
+
+#include <QSettings>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QUrl>
+#include <QDebug>
+
+#include <algorithm>
+
+LocalApiServer::LocalApiServer(RssParser *parser, QObject *parent)
+    : QObject(parent)
+    , m_parser(parser)
+    , m_enabled(false)
+    , m_port(DefaultPort)
+    , m_revision(1)
+    , m_ticks(0)
+    , m_bodies(4096) // KiB
+{
+    m_server = new QTcpServer(this);
+    connect(m_server, &QTcpServer::newConnection, this, &LocalApiServer::onNewConnection);
+
+    // A refresh of every feed stores one batch per feed; clients hear about it once
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(250);
+    connect(m_flushTimer, &QTimer::timeout, this, &LocalApiServer::flushChanges);
+
+    m_tickTimer = new QTimer(this);
+    m_tickTimer->setInterval(1000);
+    connect(m_tickTimer, &QTimer::timeout, this, &LocalApiServer::onTick);
+
+    connect(m_parser, &RssParser::storeChanged, this, &LocalApiServer::onStoreChanged);
+    connect(m_parser, &RssParser::itemsStored, this, &LocalApiServer::onItemsStored);
+}
+
+LocalApiServer::~LocalApiServer()
+{
+    stop();
+}
+
+bool LocalApiServer::setEnabled(bool enabled, quint16 port)
+{
+    m_enabled = enabled;
+    if (!enabled) {
+        stop();
+        m_port = port;
+        return true;
+    }
+    return start(port);
+}
+
+bool LocalApiServer::start(quint16 port)
+{
+    if (m_server->isListening() && port == m_port) {
+        return true;
+    }
+    stop();
+    m_port = port;
+
+    // Never reachable from other machines
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "Local API could not listen on port" << port << "-" << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+void LocalApiServer::stop()
+{
+    m_server->close();
+    m_tickTimer->stop();
+
+    // Aborting disconnects, which edits the lists; work on copies
+    const QList<QTcpSocket*> pending = m_buffers.keys();
+    const QList<Waiter> waiters = m_waiters;
+    const QList<QPointer<QTcpSocket>> streams = m_streams;
+    m_buffers.clear();
+    m_waiters.clear();
+    m_streams.clear();
+    m_pendingEvents.clear();
+
+    for (QTcpSocket *socket : pending) {
+        socket->abort();
+    }
+    for (const Waiter &waiter : waiters) {
+        if (waiter.socket) {
+            waiter.socket->abort();
+        }
+    }
+    for (const QPointer<QTcpSocket> &stream : streams) {
+        if (stream) {
+            stream->abort();
+        }
+    }
+}
+
+void LocalApiServer::loadSettings()
+{
+    QSettings settings;
+    quint16 port = quint16(settings.value("api/port", DefaultPort).toUInt());
+    m_allowedOrigins = settings.value("api/allowedOrigins").toStringList();
+    setEnabled(settings.value("api/enabled", false).toBool(), port);
+}
+
+void LocalApiServer::saveSettings() const
+{
+    QSettings settings;
+    settings.setValue("api/enabled", m_enabled);
+    settings.setValue("api/port", m_port);
+    settings.setValue("api/allowedOrigins", m_allowedOrigins);
+}
+
+void LocalApiServer::setAllowedOrigins(const QStringList &origins)
+{
+    m_allowedOrigins.clear();
+    for (const QString &origin : origins) {
+        const QString trimmed = origin.trimmed();
+        if (!trimmed.isEmpty() && !m_allowedOrigins.contains(trimmed)) {
+            m_allowedOrigins.append(trimmed);
+        }
+    }
+}
+
+void LocalApiServer::onNewConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QTcpSocket *socket = m_server->nextPendingConnection();
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        if (clientCount() >= MaxClients) {
+            respondError(socket, 503, QStringLiteral("Too many clients"));
+            continue;
+        }
+        connect(socket, &QTcpSocket::readyRead, this, &LocalApiServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, &LocalApiServer::onDisconnected);
+
+        // A client that never finishes its headers must not hold a slot
+        m_buffers.insert(socket, QByteArray());
+        QTimer::singleShot(HeaderTimeoutSecs * 1000, socket, [this, socket]() {
+            if (m_buffers.remove(socket)) {
+                socket->abort();
+                socket->deleteLater();
+            }
+        });
+    }
+}
+
+int LocalApiServer::clientCount() const
+{
+    return m_buffers.size() + m_waiters.size() + m_streams.size();
+}
+
+void LocalApiServer::onReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) {
+        return;
+    }
+
+    auto it = m_buffers.find(socket);
+    if (it == m_buffers.end()) {
+        return;
+    }
+    QByteArray &buffer = it.value();
+    buffer += socket->readAll();
+    const int end = buffer.indexOf("\r\n\r\n");
+    if (end < 0) {
+        if (buffer.size() > MaxHeaderBytes) {
+            m_buffers.remove(socket);
+            respondError(socket, 431, QStringLiteral("Request header too large"));
+        }
+        return;
+    }
+
+    // One request per connection; anything after the headers is ignored
+    const QByteArray head = buffer.left(end);
+    m_buffers.remove(socket);
+    disconnect(socket, &QTcpSocket::readyRead, this, &LocalApiServer::onReadyRead);
+
+    Request request;
+    if (!parseRequest(head, &request)) {
+        respondError(socket, 400, QStringLiteral("Malformed request"));
+        return;
+    }
+    handle(socket, request);
+}
+
+void LocalApiServer::onDisconnected()
+{
+    QTcpSocket *socket = static_cast<QTcpSocket*>(sender());
+    m_buffers.remove(socket);
+    m_streams.removeAll(socket);
+    for (int i = m_waiters.size() - 1; i >= 0; --i) {
+        if (m_waiters.at(i).socket == socket) {
+            m_waiters.removeAt(i);
+        }
+    }
+}
+
+bool LocalApiServer::parseRequest(const QByteArray &head, Request *request) const
+{
+    const QList<QByteArray> lines = head.split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3 || !requestLine.at(2).startsWith("HTTP/1.")) {
+        return false;
+    }
+
+    const QUrl url(QString::fromLatin1(requestLine.at(1)));
+    if (!url.isValid() || !url.isRelative()) {
+        return false;
+    }
+    request->method = requestLine.at(0);
+    request->path = url.path(QUrl::FullyDecoded);
+    request->query = QUrlQuery(url);
+    request->target = QString::fromLatin1(requestLine.at(1));
+
+    for (int i = 1; i < lines.size(); ++i) {
+        const QByteArray line = lines.at(i).trimmed();
+        const int colon = line.indexOf(':');
+        if (colon <= 0) {
+            continue;
+        }
+        const QByteArray name = line.left(colon).trimmed().toLower();
+        const QByteArray value = line.mid(colon + 1).trimmed();
+        if (name == "if-none-match") {
+            for (const QByteArray &tag : value.split(',')) {
+                request->ifNoneMatch.append(tag.trimmed());
+            }
+        } else if (name == "host") {
+            request->host = value.toLower();
+        } else if (name == "origin") {
+            request->origin = value;
+        }
+    }
+    return true;
+}
+
+bool LocalApiServer::isAllowedHost(const QByteArray &host) const
+{
+    // A page on a rebound DNS name reaches 127.0.0.1 with its own name here
+    const QByteArray port = ':' + QByteArray::number(m_port);
+    return host == "127.0.0.1" + port || host == "localhost" + port;
+}
+
+QByteArray LocalApiServer::corsHeaders(QTcpSocket *socket) const
+{
+    const QByteArray origin = socket->property("allowedOrigin").toByteArray();
+    if (origin.isEmpty()) {
+        return QByteArray();
+    }
+    return "Access-Control-Allow-Origin: " + origin + "\r\n"
+           "Vary: Origin\r\n";
+}
+
+void LocalApiServer::handle(QTcpSocket *socket, const Request &request)
+{
+    if (!isAllowedHost(request.host)) {
+        respondError(socket, 403, QStringLiteral("Host not allowed"));
+        return;
+    }
+    if (!request.origin.isEmpty() && m_allowedOrigins.contains(QString::fromLatin1(request.origin))) {
+        socket->setProperty("allowedOrigin", request.origin);
+    }
+
+    if (request.method != "GET") {
+        respondError(socket, 405, QStringLiteral("Only GET is supported"));
+        return;
+    }
+
+    if (request.path == QLatin1String("/api/events")) {
+        startStream(socket);
+        return;
+    }
+
+    // Unchanged since the client's copy: hold the request or answer 304
+    const QByteArray tag = etag();
+    if (request.ifNoneMatch.contains(tag) || request.ifNoneMatch.contains("*")) {
+        const int wait = qMin(request.query.queryItemValue(QStringLiteral("wait")).toInt(), int(MaxWaitSecs));
+        if (wait > 0 && clientCount() < MaxClients) {
+            Waiter waiter;
+            waiter.socket = socket;
+            waiter.request = request;
+            waiter.deadline = QDateTime::currentMSecsSinceEpoch() + wait * 1000;
+            m_waiters.append(waiter);
+            ensureTicking();
+        } else {
+            respond(socket, 304);
+        }
+        return;
+    }
+
+    int status = 200;
+    const QByteArray json = body(request, &status);
+    if (status == 200) {
+        respond(socket, status, json);
+    } else {
+        respondError(socket, status, status == 400 ? QStringLiteral("Missing search text")
+                                                   : QStringLiteral("Not found"));
+    }
+}
+
+QByteArray LocalApiServer::body(const Request &request, int *status)
+{
+    // Every display asks for the same few URLs; serialize each once per revision
+    if (QByteArray *cached = m_bodies.object(request.target)) {
+        return *cached;
+    }
+
+    const QString &path = request.path;
+    const QLatin1String feedsPrefix("/api/feeds/");
+    QJsonObject json;
+
+    if (path == QLatin1String("/api/feeds")) {
+        QHash<QString, QPair<QString, QString>> feeds = m_parser->getFeeds();
+        QStringList names = feeds.keys();
+        std::sort(names.begin(), names.end());
+
+        QJsonArray array;
+        for (const QString &name : names) {
+            const QString url = feeds.value(name).first;
+            QJsonObject feed;
+            feed.insert(QStringLiteral("name"), name);
+            feed.insert(QStringLiteral("url"), url);
+            feed.insert(QStringLiteral("category"), feeds.value(name).second);
+            feed.insert(QStringLiteral("unread"), m_parser->unreadCount(url));
+            array.append(feed);
+        }
+        json.insert(QStringLiteral("feeds"), array);
+        json.insert(QStringLiteral("unread"), m_parser->totalUnread());
+    } else if (path == QLatin1String("/api/river")) {
+        json = itemsJson(m_parser->storedItems(QString(), QString(), limit(request.query)));
+    } else if (path.startsWith(feedsPrefix)) {
+        const QString url = feedUrl(path.mid(feedsPrefix.size()));
+        if (url.isEmpty()) {
+            *status = 404;
+            return QByteArray();
+        }
+        json = itemsJson(m_parser->storedItems(url, QString(), limit(request.query)));
+    } else if (path == QLatin1String("/api/search")) {
+        const QString text = request.query.queryItemValue(QStringLiteral("q"), QUrl::FullyDecoded).trimmed();
+        const QString feed = request.query.queryItemValue(QStringLiteral("feed"), QUrl::FullyDecoded);
+        const QString url = feed.isEmpty() ? QString() : feedUrl(feed);
+        if (text.isEmpty() || (!feed.isEmpty() && url.isEmpty())) {
+            *status = text.isEmpty() ? 400 : 404;
+            return QByteArray();
+        }
+        json = itemsJson(m_parser->storedItems(url, text, limit(request.query)));
+    } else {
+        *status = 404;
+        return QByteArray();
+    }
+
+    json.insert(QStringLiteral("revision"), QString::number(m_revision));
+    QByteArray *serialized = new QByteArray(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    const QByteArray result = *serialized;
+    m_bodies.insert(request.target, serialized, serialized->size() / 1024 + 1);
+    return result;
+}
+
+QByteArray LocalApiServer::etag() const
+{
+    // Every response reflects the whole store, so one revision tags them all
+    return '"' + QByteArray::number(m_revision) + '"';
+}
+
+void LocalApiServer::respond(QTcpSocket *socket, int status, const QByteArray &body)
+{
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasonPhrase(status) + "\r\n";
+    if (!body.isEmpty()) {
+        response += "Content-Type: application/json; charset=utf-8\r\n";
+    }
+    if (status == 200 || status == 304) {
+        response += "ETag: " + etag() + "\r\n";
+    }
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                "Cache-Control: no-cache\r\n";
+    const QByteArray cors = corsHeaders(socket);
+    if (!cors.isEmpty()) {
+        response += cors + "Access-Control-Expose-Headers: ETag\r\n";
+    }
+    response += "Connection: close\r\n\r\n";
+    response += body;
+
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+void LocalApiServer::respondError(QTcpSocket *socket, int status, const QString &message)
+{
+    QJsonObject json;
+    json.insert(QStringLiteral("error"), message);
+    respond(socket, status, QJsonDocument(json).toJson(QJsonDocument::Compact));
+}
+
+void LocalApiServer::startStream(QTcpSocket *socket)
+{
+    if (clientCount() >= MaxClients) {
+        respondError(socket, 503, QStringLiteral("Too many clients"));
+        return;
+    }
+
+    socket->write("HTTP/1.1 200 OK\r\n"
+                  "Content-Type: text/event-stream\r\n"
+                  "Cache-Control: no-cache\r\n"
+                  + corsHeaders(socket) +
+                  "Connection: keep-alive\r\n\r\n"
+                  "retry: 5000\n\n");
+    m_streams.append(socket);
+    ensureTicking();
+}
+
+void LocalApiServer::ensureTicking()
+{
+    if (!m_tickTimer->isActive()) {
+        m_ticks = 0;
+        m_tickTimer->start();
+    }
+}
+
+void LocalApiServer::onStoreChanged()
+{
+    ++m_revision;
+    m_bodies.clear();
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void LocalApiServer::onItemsStored(const QString &feedUrl, const QList<FeedItem> &items)
+{
+    Q_UNUSED(feedUrl);
+    if (!m_streams.isEmpty()) {
+        m_pendingEvents.append(items);
+    }
+}
+
+void LocalApiServer::flushChanges()
+{
+    // Held requests are answered with the new state
+    const QList<Waiter> waiters = m_waiters;
+    m_waiters.clear();
+    for (const Waiter &waiter : waiters) {
+        if (waiter.socket) {
+            handle(waiter.socket, waiter.request);
+        }
+    }
+
+    if (m_pendingEvents.isEmpty()) {
+        return;
+    }
+
+    // One event per flush, the newest items first
+    std::sort(m_pendingEvents.begin(), m_pendingEvents.end(), [](const FeedItem &a, const FeedItem &b) {
+        return a.ageTime() > b.ageTime();
+    });
+    if (m_pendingEvents.size() > MaxLimit) {
+        m_pendingEvents = m_pendingEvents.mid(0, MaxLimit);
+    }
+    QJsonObject json = itemsJson(m_pendingEvents);
+    json.insert(QStringLiteral("revision"), QString::number(m_revision));
+    m_pendingEvents.clear();
+
+    const QByteArray event = "id: " + QByteArray::number(m_revision) + "\n"
+                             "event: items\n"
+                             "data: " + QJsonDocument(json).toJson(QJsonDocument::Compact) + "\n\n";
+    for (const QPointer<QTcpSocket> &stream : m_streams) {
+        if (stream) {
+            stream->write(event);
+        }
+    }
+}
+
+void LocalApiServer::onTick()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int i = m_waiters.size() - 1; i >= 0; --i) {
+        if (!m_waiters.at(i).socket) {
+            m_waiters.removeAt(i);
+        } else if (m_waiters.at(i).deadline <= now) {
+            QTcpSocket *socket = m_waiters.at(i).socket;
+            m_waiters.removeAt(i);
+            respond(socket, 304);
+        }
+    }
+
+    // A comment line keeps proxies and idle timeouts from closing the streams
+    m_streams.removeAll(QPointer<QTcpSocket>());
+    if (++m_ticks % KeepAliveSecs == 0) {
+        for (const QPointer<QTcpSocket> &stream : m_streams) {
+            stream->write(":\n\n");
+        }
+    }
+
+    if (m_waiters.isEmpty() && m_streams.isEmpty()) {
+        m_tickTimer->stop();
+    }
+}
+
+QJsonObject LocalApiServer::itemsJson(const QList<FeedItem> &items) const
+{
+    QJsonArray array;
+    for (const FeedItem &item : items) {
+        array.append(itemJson(item));
+    }
+    QJsonObject json;
+    json.insert(QStringLiteral("items"), array);
+    return json;
+}
+
+QJsonObject LocalApiServer::itemJson(const FeedItem &item) const
+{
+    const QString url = item.feedUrl();
+    QJsonObject json;
+    json.insert(QStringLiteral("guid"), item.guid());
+    json.insert(QStringLiteral("title"), item.title);
+    json.insert(QStringLiteral("link"), item.link());
+    json.insert(QStringLiteral("feed"), m_parser->feedLabel(url));
+    json.insert(QStringLiteral("feedUrl"), url);
+    json.insert(QStringLiteral("categories"), QJsonArray::fromStringList(item.categories()));
+    json.insert(QStringLiteral("published"), item.pubTime > 0
+                ? QDateTime::fromSecsSinceEpoch(item.pubTime, Qt::UTC).toString(Qt::ISODate)
+                : item.pubDate);
+    json.insert(QStringLiteral("fetched"), QDateTime::fromSecsSinceEpoch(item.fetchTime, Qt::UTC).toString(Qt::ISODate));
+    json.insert(QStringLiteral("read"), item.isRead);
+    json.insert(QStringLiteral("snippet"), item.snippet());
+    if (item.hasImageUrl()) {
+        json.insert(QStringLiteral("image"), item.imageUrl());
+    }
+    return json;
+}
+
+QString LocalApiServer::feedUrl(const QString &name) const
+{
+    return m_parser->getFeeds().value(name).first;
+}
+
+int LocalApiServer::limit(const QUrlQuery &query)
+{
+    bool ok = false;
+    const int value = query.queryItemValue(QStringLiteral("limit")).toInt(&ok);
+    return ok && value > 0 ? qMin(value, int(MaxLimit)) : int(DefaultLimit);
+}
+
+QByteArray LocalApiServer::reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 431: return "Request Header Fields Too Large";
+    case 503: return "Service Unavailable";
+    default: return "Error";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#ifndef LOCALAPISERVER_H
+#define LOCALAPISERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include <QStringList>
+#include <QCache>
+#include <QPointer>
+#include <QTimer>
+#include <QUrlQuery>
+#include <QJsonObject>
+
+#include "feeditem.h"
+
+class RssParser;
+
+// Read-only HTTP/JSON view of the article store for wallboards and scripts.
+// Off unless enabled, and bound to localhost only. Requests must name the
+// server as 127.0.0.1:<port> or localhost:<port> in their Host header, so a
+// rebound DNS name cannot reach it, and browsers may only read responses
+// from the origins listed in the allowed-origins setting.
+//
+//   GET /api/feeds                  feeds with their unread counts
+//   GET /api/river?limit=N          newest articles of every feed
+//   GET /api/feeds/<name>?limit=N   newest articles of one feed
+//   GET /api/search?q=text&feed=<name>&limit=N
+//   GET /api/events                 server-sent events, one per stored batch
+//
+// JSON responses carry an ETag that changes with the store. A request whose
+// If-None-Match is current and that asks for ?wait=<seconds> is held until
+// the store changes (long-poll), or answered 304 when the wait runs out.
+class LocalApiServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LocalApiServer(RssParser *parser, QObject *parent = nullptr);
+    ~LocalApiServer();
+
+    static const quint16 DefaultPort = 8787;
+
+    bool isEnabled() const { return m_enabled; }
+    bool isListening() const { return m_server->isListening(); }
+    quint16 port() const { return m_port; }
+    QString errorString() const { return m_server->errorString(); }
+    QStringList allowedOrigins() const { return m_allowedOrigins; }
+    void setAllowedOrigins(const QStringList &origins);
+
+    // Starts or stops listening; returns false if the port cannot be bound
+    bool setEnabled(bool enabled, quint16 port);
+
+    // QSettings persistence
+    void loadSettings();
+    void saveSettings() const;
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+    void onStoreChanged();
+    void onItemsStored(const QString &feedUrl, const QList<FeedItem> &items);
+    void flushChanges();
+    void onTick();
+
+private:
+    struct Request {
+        QByteArray method;
+        QString path;
+        QUrlQuery query;
+        QString target; // path and query, the key of the response cache
+        QList<QByteArray> ifNoneMatch;
+        QByteArray host;
+        QByteArray origin;
+    };
+
+    struct Waiter {
+        QPointer<QTcpSocket> socket;
+        Request request;
+        qint64 deadline; // msecs since epoch
+    };
+
+    RssParser *m_parser;
+    QTcpServer *m_server;
+    bool m_enabled;
+    quint16 m_port;
+    quint64 m_revision;
+    int m_ticks;
+    QStringList m_allowedOrigins;             // origins granted CORS access, none by default
+
+    QHash<QTcpSocket*, QByteArray> m_buffers; // connections still sending their headers
+    QList<Waiter> m_waiters;                  // held long-poll requests
+    QList<QPointer<QTcpSocket>> m_streams;    // event-stream clients
+    QList<FeedItem> m_pendingEvents;          // stored since the last flush
+    QCache<QString, QByteArray> m_bodies;     // target -> JSON body, valid for m_revision
+    QTimer *m_flushTimer;                     // coalesces bursts of store changes
+    QTimer *m_tickTimer;                      // long-poll deadlines and keep-alives
+
+    static const int MaxHeaderBytes = 8192;
+    static const int MaxClients = 64;         // pending, held and streaming connections
+    static const int HeaderTimeoutSecs = 10;  // to send a complete request head
+    static const int DefaultLimit = 50;
+    static const int MaxLimit = 500;
+    static const int MaxWaitSecs = 60;
+    static const int KeepAliveSecs = 15;
+
+    bool start(quint16 port);
+    void stop();
+    int clientCount() const;
+    bool parseRequest(const QByteArray &head, Request *request) const;
+    bool isAllowedHost(const QByteArray &host) const;
+    QByteArray corsHeaders(QTcpSocket *socket) const;
+    void handle(QTcpSocket *socket, const Request &request);
+    QByteArray body(const Request &request, int *status);
+    QByteArray etag() const;
+    void respond(QTcpSocket *socket, int status, const QByteArray &body = QByteArray());
+    void respondError(QTcpSocket *socket, int status, const QString &message);
+    void startStream(QTcpSocket *socket);
+    void ensureTicking();
+    QJsonObject itemsJson(const QList<FeedItem> &items) const;
+    QJsonObject itemJson(const FeedItem &item) const;
+    QString feedUrl(const QString &name) const;
+    static int limit(const QUrlQuery &query);
+    static QByteArray reasonPhrase(int status);
+};
+
+#endif // LOCALAPISERVER_H
\ No newline at end of file
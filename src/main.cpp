@@ -1,4 +1,6 @@
 #include "mainwindow.h"
+#include "feedmetrics.h"
+#include "singleinstance.h"
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QDir>
@@ -6,9 +8,14 @@
 #include <QPixmap>
 #include <QTimer>
 #include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+    
     QApplication app(argc, argv);
     app.setApplicationName("MotorsportRSS");
     app.setApplicationVersion("1.0.0");
@@ -16,6 +23,20 @@ int main(int argc, char *argv[])
     app.setOrganizationDomain("motorsportrss.example.com");
     app.setWindowIcon(QIcon(":/icons/logo.png"));
     
+    QCommandLineParser parser;
+    MainWindow::setupCommandLine(parser);
+    parser.process(app);
+    
+    // A second launch hands its command line to the running instance
+    SingleInstance instance;
+    if (!instance.isPrimary()) {
+        if (instance.sendArguments(app.arguments())) {
+            return 0;
+        }
+        qWarning() << "Another instance holds the data directory but does not answer";
+        return 1;
+    }
+    
     // Show splash screen
     QPixmap splashPixmap(":/icons/logo.png");
     QSplashScreen splash(splashPixmap.scaled(400, 400, Qt::KeepAspectRatio, Qt::SmoothTransformation));
@@ -25,15 +46,13 @@ int main(int argc, char *argv[])
     // Simulate loading time
     splash.showMessage("Loading application...", Qt::AlignBottom | Qt::AlignHCenter, Qt::white);
     
-    // Command line parser for future extensions
-    QCommandLineParser parser;
-    parser.setApplicationDescription("Motorsport RSS Reader");
-    parser.addHelpOption();
-    parser.addVersionOption();
-    parser.process(app);
-    
     // Create main window but don't show it immediately
     MainWindow w;
+    QObject::connect(&instance, &SingleInstance::argumentsReceived, &w, &MainWindow::handleCommandLine);
+    
+    // Measured before the splash delay, which is not work
+    const double startupMs = startupTimer.nsecsElapsed() / 1000000.0;
+    FeedMetrics::instance().recordDuration(FeedMetrics::AppScope, FeedMetrics::StageStartup, startupMs);
     
     // Allow splash to be visible for at least 1.5 seconds
     QThread::msleep(1500);
@@ -42,5 +61,12 @@ int main(int argc, char *argv[])
     w.show();
     splash.finish(&w);
     
+    // This launch's own options, then those of later launches, including
+    // any that arrived while starting up
+    if (parser.isSet("feed") || parser.isSet("refresh")) {
+        w.handleCommandLine(app.arguments());
+    }
+    instance.startDelivery();
+    
     return app.exec();
 } 
\ No newline at end of file
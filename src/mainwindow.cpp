@@ -1,12 +1,13 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "diagnosticsdialog.h"
+#include "thememanager.h"
 
 #include <QMenu>
 #include <QMenuBar>
 #include <QToolBar>
 #include <QStatusBar>
 #include <QMessageBox>
-#include <QFile>
 #include <QApplication>
 #include <QStyle>
 #include <QDateTime>
@@ -15,21 +16,27 @@
 #include <QSettings>
 #include <QSplashScreen>
 #include <QTimer>
+#include <QDebug>
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
+    m_feedWidget(nullptr),
     m_darkThemeEnabled(true) // Default to dark theme
 {
     ui->setupUi(this);
     
+    // Start the heartbeat first so stalls during startup are visible
+    m_stallWatchdog = new StallWatchdog(this);
+    m_stallWatchdog->loadSettings();
+    
     // Set window properties
     setWindowTitle(tr("Motorsport RSS Reader"));
     setWindowIcon(QIcon(":/icons/logo.png"));
     resize(1024, 768);
     
     // Apply dark theme by default
-    loadStyleSheet(":/styles/dark.qss");
+    applyTheme();
     
     // Create central widget
     m_feedWidget = new NewsFeedWidget(this);
@@ -53,6 +60,67 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+void MainWindow::setupCommandLine(QCommandLineParser &parser)
+{
+    parser.setApplicationDescription("Motorsport RSS Reader");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption(QCommandLineOption("feed", tr("Open the feed or saved search with this name or URL."), tr("feed")));
+    parser.addOption(QCommandLineOption("refresh", tr("Refresh every feed.")));
+}
+
+void MainWindow::handleCommandLine(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    setupCommandLine(parser);
+    if (!parser.parse(arguments)) {
+        qWarning() << "Ignoring command line:" << parser.errorText();
+        return;
+    }
+    
+    // Bring the window back from the tray or the taskbar
+    setWindowState(windowState() & ~Qt::WindowMinimized);
+    show();
+    raise();
+    activateWindow();
+    
+    if (parser.isSet("feed") && !m_feedWidget->openFeed(parser.value("feed"))) {
+        updateStatusMessage(tr("Unknown feed: %1").arg(parser.value("feed")));
+    }
+    if (parser.isSet("refresh")) {
+        m_feedWidget->refreshAllFeeds();
+    }
+}
+
+void MainWindow::showEvent(QShowEvent *event)
+{
+    QMainWindow::showEvent(event);
+    updateViewSuspension();
+}
+
+void MainWindow::hideEvent(QHideEvent *event)
+{
+    QMainWindow::hideEvent(event);
+    updateViewSuspension();
+}
+
+void MainWindow::changeEvent(QEvent *event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange) {
+        updateViewSuspension();
+    }
+}
+
+void MainWindow::updateViewSuspension()
+{
+    // Hidden to the tray or minimized, refreshes only touch the parser
+    if (!m_feedWidget) {
+        return;
+    }
+    m_feedWidget->getFeedModel()->setViewUpdatesSuspended(!isVisible() || isMinimized());
+}
+
 void MainWindow::setupActions()
 {
     // File menu
@@ -86,6 +154,11 @@ void MainWindow::setupActions()
                           QApplication::style()->standardIcon(QStyle::SP_FileDialogDetailedView)));
     connect(settingsAction, &QAction::triggered, m_feedWidget, &NewsFeedWidget::onSettingsClicked);
     
+    QAction *diagnosticsAction = toolsMenu->addAction(tr("&Diagnostics..."));
+    diagnosticsAction->setIcon(QIcon::fromTheme("utilities-system-monitor",
+                          QApplication::style()->standardIcon(QStyle::SP_MessageBoxInformation)));
+    connect(diagnosticsAction, &QAction::triggered, this, &MainWindow::onDiagnostics);
+    
     // Help menu
     QMenu *helpMenu = menuBar()->addMenu(tr("&Help"));
     
@@ -130,24 +203,23 @@ void MainWindow::onAboutApp()
     aboutBox.exec();
 }
 
+void MainWindow::onDiagnostics()
+{
+    DiagnosticsDialog dialog(m_stallWatchdog, m_feedWidget->getFeedModel()->parser(), m_feedWidget, this);
+    dialog.exec();
+}
+
 void MainWindow::onThemeChange()
 {
     m_darkThemeEnabled = !m_darkThemeEnabled;
-    
-    if (m_darkThemeEnabled) {
-        loadStyleSheet(":/styles/dark.qss");
-    } else {
-        qApp->setStyleSheet("");
-    }
+    applyTheme();
 }
 
-void MainWindow::loadStyleSheet(const QString &fileName)
+void MainWindow::applyTheme()
 {
-    QFile file(fileName);
-    if (file.open(QFile::ReadOnly | QFile::Text)) {
-        qApp->setStyleSheet(file.readAll());
-        file.close();
-    }
+    ThemeManager &theme = ThemeManager::instance();
+    theme.apply(m_darkThemeEnabled ? ThemeManager::DarkTheme : ThemeManager::LightTheme);
+    statusBar()->setStyleSheet(theme.statusBarStyleSheet());
 }
 
 void MainWindow::updateStatusMessage(const QString &message)
@@ -181,10 +253,6 @@ void MainWindow::loadSettings()
     // Load theme setting
     if (settings.contains("mainWindow/darkThemeEnabled")) {
         m_darkThemeEnabled = settings.value("mainWindow/darkThemeEnabled").toBool();
-        if (m_darkThemeEnabled) {
-            loadStyleSheet(":/styles/dark.qss");
-        } else {
-            qApp->setStyleSheet("");
-        }
+        applyTheme();
     }
 } 
\ No newline at end of file
@@ -4,8 +4,10 @@
 #include <QMainWindow>
 #include <QAction>
 #include <QLabel>
+#include <QCommandLineParser>
 
 #include "newsfeedwidget.h"
+#include "stallwatchdog.h"
 
 namespace Ui {
 class MainWindow;
@@ -18,10 +20,24 @@ class MainWindow : public QMainWindow
 public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
-
+    
+    // Options understood at launch and when forwarded by a second launch
+    static void setupCommandLine(QCommandLineParser &parser);
+    
+public slots:
+    // Raises the window and acts on --feed and --refresh
+    void handleCommandLine(const QStringList &arguments);
+
+protected:
+    // The feed list is only kept current while the window can be seen
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    
 private slots:
     void onAboutApp();
     void onThemeChange();
+    void onDiagnostics();
     void updateStatusMessage(const QString &message);
 
 private:
@@ -29,9 +45,12 @@ private:
     NewsFeedWidget *m_feedWidget;
     bool m_darkThemeEnabled;
     
+    StallWatchdog *m_stallWatchdog;
+    
     void setupActions();
     void setupStatusBar();
-    void loadStyleSheet(const QString &fileName);
+    void updateViewSuspension();
+    void applyTheme();
     void saveSettings();
     void loadSettings();
 };
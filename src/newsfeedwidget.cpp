@@ -1,9 +1,13 @@
 #include "newsfeedwidget.h"
+#include "stallwatchdog.h"
+#include "htmlscanner.h"
+#include "thememanager.h"
+#include "localapiserver.h"
+#include "feeditemdelegate.h"
+#include "qtcompat.h"
 
 #include <QDesktopServices>
 #include <QUrl>
-#include <QStyledItemDelegate>
-#include <QPainter>
 #include <QDateTime>
 #include <QSortFilterProxyModel>
 #include <QApplication>
@@ -16,7 +20,11 @@
 #include <QDialogButtonBox>
 #include <QBuffer>
 #include <QPixmap>
+#include <QScrollBar>
 #include <QScreen>
+#include <QPlainTextEdit>
+#include <QHoverEvent>
+#include <QElapsedTimer>
 
 // Add Feed Dialog Implementation
 AddFeedDialog::AddFeedDialog(QWidget *parent)
@@ -78,113 +86,6 @@ QString AddFeedDialog::feedCategory() const
     return m_categoryCombo->currentText().trimmed();
 }
 
-// Custom delegate to display the feed items in a more attractive way
-class FeedItemDelegate : public QStyledItemDelegate
-{
-public:
-    explicit FeedItemDelegate(RssFeedModel *model, QObject *parent = nullptr)
-        : QStyledItemDelegate(parent), m_model(model) {}
-    
-    void paint(QPainter *painter, const QStyleOptionViewItem &option,
-               const QModelIndex &index) const override
-    {
-        if (!index.isValid())
-            return;
-        
-        QStyleOptionViewItem opt = option;
-        initStyleOption(&opt, index);
-        
-        // Get data from model
-        QString title = index.data(RssFeedModel::TitleRole).toString();
-        QString pubDate = index.data(RssFeedModel::PubDateRole).toString();
-        QString category = index.data(RssFeedModel::CategoryRole).toString();
-        QString imageUrl = index.data(RssFeedModel::ImageUrlRole).toString();
-        bool isRead = index.data(RssFeedModel::IsReadRole).toBool();
-        
-        // Get category icon
-        QString categoryIconPath = m_model->getCategoryIcon(category);
-        QPixmap categoryIcon(categoryIconPath);
-        
-        // Background
-        if (opt.state & QStyle::State_Selected) {
-            painter->fillRect(opt.rect, opt.palette.highlight());
-            painter->setPen(opt.palette.highlightedText().color());
-        } else {
-            painter->fillRect(opt.rect, opt.state & QStyle::State_MouseOver 
-                             ? QColor(240, 240, 240) : Qt::white);
-            painter->setPen(Qt::black);
-        }
-        
-        int padding = 10;
-        int iconSize = 40;
-        
-        // Draw unread indicator
-        if (!isRead) {
-            QRect indicator(opt.rect.left() + 2, opt.rect.top() + (opt.rect.height() - 8) / 2, 4, 8);
-            painter->fillRect(indicator, QColor(41, 128, 185)); // Blue indicator for unread
-        }
-        
-        // Draw category icon
-        if (!categoryIcon.isNull()) {
-            QRect iconRect = QRect(opt.rect.left() + padding + (isRead ? 0 : 4), 
-                                  opt.rect.top() + padding,
-                                  iconSize, iconSize);
-            painter->drawPixmap(iconRect, categoryIcon.scaled(iconSize, iconSize, 
-                                                             Qt::KeepAspectRatio, 
-                                                             Qt::SmoothTransformation));
-        }
-        
-        // Format date
-        QDateTime dateTime = QDateTime::fromString(pubDate, Qt::RFC2822Date);
-        QString formattedDate = dateTime.isValid() 
-                              ? dateTime.toString("dd MMM yyyy - hh:mm") 
-                              : pubDate;
-        
-        // Draw title
-        QFont titleFont = opt.font;
-        titleFont.setBold(true);
-        titleFont.setPointSize(10);
-        if (isRead) {
-            titleFont.setBold(false);
-        }
-        painter->setFont(titleFont);
-        
-        int leftMargin = padding + iconSize + padding + (isRead ? 0 : 4);
-        QRect textRect = opt.rect.adjusted(leftMargin, padding, -padding, -padding);
-        QRect titleRect = textRect;
-        titleRect.setHeight(painter->fontMetrics().height());
-        
-        painter->drawText(titleRect, Qt::AlignLeft | Qt::AlignTop, 
-                         painter->fontMetrics().elidedText(title, Qt::ElideRight, titleRect.width()));
-        
-        // Draw date and category
-        QFont normalFont = opt.font;
-        normalFont.setPointSize(8);
-        painter->setFont(normalFont);
-        
-        QString catText = category.isEmpty() ? "" : " | " + category;
-        QString dateCategory = formattedDate + catText;
-        
-        QRect dateRect = textRect;
-        dateRect.setTop(titleRect.bottom() + 5);
-        dateRect.setHeight(painter->fontMetrics().height());
-        
-        QColor dateColor = opt.state & QStyle::State_Selected 
-                         ? opt.palette.highlightedText().color() 
-                         : QColor(120, 120, 120);
-        painter->setPen(dateColor);
-        painter->drawText(dateRect, Qt::AlignLeft | Qt::AlignTop, dateCategory);
-    }
-    
-    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const override
-    {
-        return QSize(option.rect.width(), 70);
-    }
-    
-private:
-    RssFeedModel *m_model;
-};
-
 NewsFeedWidget::NewsFeedWidget(QWidget *parent) : QWidget(parent),
     m_notificationsEnabled(true),
     m_autoRefreshEnabled(true),
@@ -200,15 +101,27 @@ NewsFeedWidget::NewsFeedWidget(QWidget *parent) : QWidget(parent),
     connect(m_model, &RssFeedModel::feedLoadError, this, &NewsFeedWidget::handleFeedError);
     connect(m_model, &RssFeedModel::statusMessage, this, &NewsFeedWidget::handleStatusMessage);
     connect(m_model, &RssFeedModel::feedsUpdated, this, &NewsFeedWidget::updateFeedSelector);
+    connect(m_model, &RssFeedModel::categoryCountsChanged, this, &NewsFeedWidget::setupCategoryCombo);
+    connect(m_model->parser(), &RssParser::unreadCountsChanged, this, &NewsFeedWidget::updateUnreadCounts);
+    connect(&ThemeManager::instance(), &ThemeManager::themeChanged, this, &NewsFeedWidget::onThemeChanged);
+    connect(m_model->parser(), &RssParser::alertTriggered, this, &NewsFeedWidget::handleAlert);
+    connect(m_model->parser(), &RssParser::backgroundItemsAvailable, this, &NewsFeedWidget::handleNewItemsNotification);
+    
+    // Bursts of refreshes end up as one balloon
+    m_notifier = new NotificationAggregator(this);
+    connect(m_notifier, &NotificationAggregator::notify, this, &NewsFeedWidget::showNotification);
     
     // Setup UI
     setupUi();
     setupTrayIcon();
     loadSettings();
     
+    m_apiServer = new LocalApiServer(m_model->parser(), this);
+    m_apiServer->loadSettings();
+    
     // Create auto-refresh timer
     m_autoRefreshTimer = new QTimer(this);
-    connect(m_autoRefreshTimer, &QTimer::timeout, this, &NewsFeedWidget::onRefreshClicked);
+    connect(m_autoRefreshTimer, &QTimer::timeout, this, &NewsFeedWidget::onAutoRefresh);
     
     if (m_autoRefreshEnabled) {
         m_autoRefreshTimer->start(m_autoRefreshInterval * 60 * 1000);
@@ -245,13 +158,31 @@ void NewsFeedWidget::setupUi()
     // Main content area with splitter
     m_mainSplitter = new QSplitter(Qt::Vertical, this);
     
-    // List view for feed items
+    // List view for feed items. Rows have one height and are laid out in
+    // batches, so only the visible range is measured and painted.
     m_listView = new QListView(this);
     m_listView->setUniformItemSizes(true);
+    m_listView->setLayoutMode(QListView::Batched);
+    m_listView->setBatchSize(100);
+    m_listView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
     m_listView->setSelectionMode(QAbstractItemView::SingleSelection);
     m_listView->setAlternatingRowColors(true);
     m_listView->setModel(m_proxyModel);
-    m_listView->setItemDelegate(new FeedItemDelegate(m_model, this));
+    m_itemDelegate = new FeedItemDelegate(m_model, this);
+    m_itemDelegate->trackModel(m_proxyModel);
+    m_listView->setItemDelegate(m_itemDelegate);
+    
+    // Warm the delegate caches for the rows around the viewport once scrolling settles
+    m_prefetchTimer = new QTimer(this);
+    m_prefetchTimer->setSingleShot(true);
+    m_prefetchTimer->setInterval(50);
+    connect(m_prefetchTimer, &QTimer::timeout, this, &NewsFeedWidget::prefetchVisibleRows);
+    connect(m_listView->verticalScrollBar(), &QScrollBar::valueChanged,
+            m_prefetchTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(m_proxyModel, &QAbstractItemModel::modelReset,
+            m_prefetchTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(m_proxyModel, &QAbstractItemModel::rowsInserted,
+            m_prefetchTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
     
     // Detail view for selected item
     QWidget *detailWidget = new QWidget(this);
@@ -286,6 +217,7 @@ void NewsFeedWidget::setupUi()
     
     m_detailView = new QTextBrowser(this);
     m_detailView->setOpenLinks(false);
+    m_detailView->document()->setDefaultStyleSheet(ThemeManager::instance().articleStyleSheet());
     
     detailLayout->addLayout(detailHeaderLayout);
     detailLayout->addWidget(m_detailView);
@@ -365,6 +297,12 @@ void NewsFeedWidget::setupToolbars()
     
     m_unreadOnlyCheck = new QCheckBox(tr("Unread only"), this);
     
+    m_sortCombo = new QComboBox(this);
+    m_sortCombo->addItem(tr("Newest"), FeedFilterProxyModel::SortByTime);
+    m_sortCombo->addItem(tr("Feed"), FeedFilterProxyModel::SortByFeed);
+    m_sortCombo->addItem(tr("Unread first"), FeedFilterProxyModel::SortUnreadFirst);
+    m_sortCombo->addItem(tr("Relevance"), FeedFilterProxyModel::SortByRelevance);
+    
     QLabel *filterLabel = new QLabel(tr("Search:"), this);
     m_filterEdit = new QLineEdit(this);
     m_filterEdit->setClearButtonEnabled(true);
@@ -372,11 +310,17 @@ void NewsFeedWidget::setupToolbars()
     
     m_markAllReadButton = new QPushButton(tr("Mark All Read"), this);
     
+    m_saveSearchButton = new QPushButton(tr("Save Search"), this);
+    m_saveSearchButton->setToolTip(tr("Keep the current feed, category, search and unread filter as a live view"));
+    
     m_filterToolbar->addWidget(new QLabel(tr("Category: ")));
     m_filterToolbar->addWidget(m_categoryCombo);
     m_filterToolbar->addWidget(m_unreadOnlyCheck);
+    m_filterToolbar->addWidget(new QLabel(tr("Sort: ")));
+    m_filterToolbar->addWidget(m_sortCombo);
     m_filterToolbar->addWidget(filterLabel);
     m_filterToolbar->addWidget(m_filterEdit);
+    m_filterToolbar->addWidget(m_saveSearchButton);
     m_filterToolbar->addWidget(m_markAllReadButton);
     
     // Connect signals
@@ -384,9 +328,13 @@ void NewsFeedWidget::setupToolbars()
     connect(m_feedSelector, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &NewsFeedWidget::onFeedSelectionChanged);
     connect(m_filterEdit, &QLineEdit::textChanged, this, &NewsFeedWidget::onFilterTextChanged);
-    connect(m_categoryCombo, &QComboBox::currentTextChanged, this, &NewsFeedWidget::onCategoryFilterChanged);
+    connect(m_categoryCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &NewsFeedWidget::onCategoryFilterChanged);
     connect(m_unreadOnlyCheck, &QCheckBox::toggled, this, &NewsFeedWidget::onShowUnreadOnlyToggled);
+    connect(m_sortCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &NewsFeedWidget::onSortModeChanged);
     connect(m_markAllReadButton, &QPushButton::clicked, this, &NewsFeedWidget::onMarkAllReadClicked);
+    connect(m_saveSearchButton, &QPushButton::clicked, this, &NewsFeedWidget::onSaveSearchClicked);
     connect(m_addFeedButton, &QToolButton::clicked, this, &NewsFeedWidget::onAddFeedClicked);
     connect(m_removeFeedButton, &QToolButton::clicked, this, &NewsFeedWidget::onRemoveFeedClicked);
     connect(m_settingsButton, &QToolButton::clicked, this, &NewsFeedWidget::onSettingsClicked);
@@ -422,15 +370,29 @@ void NewsFeedWidget::setupTrayIcon()
 
 void NewsFeedWidget::setupCategoryCombo()
 {
+    // Categories of the items in the list, with their counts; the item
+    // data holds the bare name for the filter
+    const QString selected = m_categoryCombo->currentData().toString();
+    
+    m_categoryCombo->blockSignals(true);
     m_categoryCombo->clear();
-    m_categoryCombo->addItem(tr("All Categories"));
+    m_categoryCombo->addItem(tr("All Categories"), QString());
+    
+    bool selectedListed = false;
+    const QList<CategoryCount> counts = m_model->categoryCounts();
+    for (const CategoryCount &count : counts) {
+        QString text = count.unread > 0 ? tr("%1 (%2, %3 unread)").arg(count.name).arg(count.items).arg(count.unread)
+                                        : tr("%1 (%2)").arg(count.name).arg(count.items);
+        m_categoryCombo->addItem(text, count.name);
+        selectedListed = selectedListed || count.name == selected;
+    }
     
-    QStringList categories = m_model->availableCategories();
-    for (const QString &category : categories) {
-        if (category != "All") {
-            m_categoryCombo->addItem(category);
-        }
+    // Keep an active filter visible even when no item has the category now
+    if (!selected.isEmpty() && !selectedListed) {
+        m_categoryCombo->addItem(tr("%1 (%2)").arg(selected).arg(0), selected);
     }
+    m_categoryCombo->setCurrentIndex(qMax(0, m_categoryCombo->findData(selected)));
+    m_categoryCombo->blockSignals(false);
 }
 
 void NewsFeedWidget::updateFeedSelector()
@@ -438,21 +400,25 @@ void NewsFeedWidget::updateFeedSelector()
     // Store the current selection
     QString currentFeed;
     if (m_feedSelector->currentIndex() >= 0) {
-        currentFeed = m_feedSelector->currentText();
+        currentFeed = m_feedSelector->currentData().toString();
     }
     
-    // Clear and rebuild
+    // Clear and rebuild; the item data holds the feed name, or the source
+    // URL of a saved search, the text adds the unread count
     m_feedSelector->blockSignals(true);
     m_feedSelector->clear();
     
     QHash<QString, QPair<QString, QString>> feeds = m_model->parser()->getFeeds();
     for (auto it = feeds.constBegin(); it != feeds.constEnd(); ++it) {
-        m_feedSelector->addItem(it.key());
+        m_feedSelector->addItem(it.key(), it.key());
+    }
+    for (const SavedSearch &search : m_model->parser()->savedSearches()) {
+        m_feedSelector->addItem(tr("Search: %1").arg(search.name), SavedSearches::sourceUrl(search.name));
     }
     
     // Try to restore selection
     if (!currentFeed.isEmpty()) {
-        int index = m_feedSelector->findText(currentFeed);
+        int index = m_feedSelector->findData(currentFeed);
         if (index >= 0) {
             m_feedSelector->setCurrentIndex(index);
         }
@@ -460,16 +426,66 @@ void NewsFeedWidget::updateFeedSelector()
     
     m_feedSelector->blockSignals(false);
     
+    updateUnreadCounts();
+    
     // Update categories in filter combo
     setupCategoryCombo();
 }
 
+void NewsFeedWidget::updateUnreadCounts()
+{
+    // Counters are kept by the parser, this only relabels
+    RssParser *parser = m_model->parser();
+    const QHash<QString, QPair<QString, QString>> feeds = parser->getFeeds();
+    for (int i = 0; i < m_feedSelector->count(); ++i) {
+        const QString data = m_feedSelector->itemData(i).toString();
+        const bool search = SavedSearches::isSource(data);
+        const QString name = search ? tr("Search: %1").arg(SavedSearches::sourceName(data)) : data;
+        const int unread = parser->unreadCount(search ? data : feeds.value(data).first);
+        m_feedSelector->setItemText(i, unread > 0 ? tr("%1 (%2)").arg(name).arg(unread) : name);
+    }
+    
+    const int total = parser->totalUnread();
+    m_trayIcon->setToolTip(total > 0 ? tr("Motorsport RSS Reader - %n unread article(s)", "", total)
+                                     : tr("Motorsport RSS Reader"));
+}
+
 void NewsFeedWidget::setFeedUrl(const QString &url)
 {
     m_model->setFeedUrl(url);
     m_statusLabel->setText(tr("Loading feed..."));
 }
 
+bool NewsFeedWidget::openFeed(const QString &feed)
+{
+    // Selector entries hold feed names and saved search URLs
+    int index = m_feedSelector->findData(feed);
+    if (index < 0) {
+        const QHash<QString, QPair<QString, QString>> feeds = m_model->parser()->getFeeds();
+        for (auto it = feeds.constBegin(); it != feeds.constEnd(); ++it) {
+            if (it.value().first == feed) {
+                index = m_feedSelector->findData(it.key());
+                break;
+            }
+        }
+    }
+    if (index < 0) {
+        index = m_feedSelector->findData(SavedSearches::sourceUrl(feed));
+    }
+    if (index < 0) {
+        return false;
+    }
+    
+    m_feedSelector->setCurrentIndex(index);
+    return true;
+}
+
+void NewsFeedWidget::refreshAllFeeds()
+{
+    onRefreshClicked();
+    m_model->parser()->refreshAllFeeds();
+}
+
 void NewsFeedWidget::onItemSelected(const QModelIndex &index)
 {
     if (!index.isValid())
@@ -485,6 +501,8 @@ void NewsFeedWidget::onItemSelected(const QModelIndex &index)
     QString pubDate = m_model->data(sourceIndex, RssFeedModel::PubDateRole).toString();
     QString category = m_model->data(sourceIndex, RssFeedModel::CategoryRole).toString();
     bool isRead = m_model->data(sourceIndex, RssFeedModel::IsReadRole).toBool();
+    int wordCount = m_model->data(sourceIndex, RssFeedModel::WordCountRole).toInt();
+    QStringList otherSources = m_model->data(sourceIndex, RssFeedModel::OtherSourcesRole).toStringList();
     
     // Format date
     QDateTime dateTime = QDateTime::fromString(pubDate, Qt::RFC2822Date);
@@ -501,33 +519,29 @@ void NewsFeedWidget::onItemSelected(const QModelIndex &index)
         m_categoryIcon->clear();
     }
     
-    // Prepare HTML content for the detail view
+    // Prepare HTML content for the detail view; the CSS is the theme's
+    // default style sheet of the document
     QString htmlContent = QString(
         "<html>"
-        "<head>"
-        "<style>"
-        "body { font-family: Arial, sans-serif; margin: 0; padding: 10px; }"
-        "h1 { font-size: 20px; color: #333; margin-top: 0; }"
-        ".meta { color: #666; font-size: 12px; margin-bottom: 15px; }"
-        ".content { line-height: 1.5; }"
-        "a { color: #0066cc; text-decoration: none; }"
-        "img { max-width: 100%; height: auto; margin: 10px 0; }"
-        "</style>"
-        "</head>"
         "<body>"
         "<h1>%1</h1>"
-        "<div class='meta'>%2%3</div>"
-        "<div class='content'>%4</div>"
+        "<div class='meta'>%2%3%4%5</div>"
+        "<div class='content'>%6</div>"
         "</body>"
         "</html>"
     ).arg(
         title,
         formattedDate,
         category.isEmpty() ? "" : " | " + category,
+        wordCount > 0 ? " | " + tr("%n words", "", wordCount) : QString(),
+        otherSources.isEmpty() ? QString() : " | " + tr("Also in %1").arg(otherSources.join(", ").toHtmlEscaped()),
         description
     );
     
-    m_detailView->setHtml(htmlContent);
+    {
+        StallScope stallScope("setHtml");
+        m_detailView->setHtml(htmlContent);
+    }
     m_openLinkButton->setEnabled(!m_currentLink.isEmpty());
     m_markReadButton->setEnabled(!isRead);
     m_saveButton->setEnabled(true);
@@ -545,6 +559,17 @@ void NewsFeedWidget::onRefreshClicked()
     m_statusLabel->setText(tr("Refreshing feed..."));
 }
 
+void NewsFeedWidget::onAutoRefresh()
+{
+    onRefreshClicked();
+    
+    // Alerts and API clients are only served if every feed is checked, not
+    // just the open one; feeds checked within the interval are left alone
+    if (!m_model->parser()->alerts().isEmpty() || m_apiServer->isListening()) {
+        m_model->parser()->refreshDueFeeds(m_autoRefreshInterval * 60);
+    }
+}
+
 void NewsFeedWidget::onOpenLinkClicked()
 {
     if (!m_currentLink.isEmpty()) {
@@ -560,7 +585,11 @@ void NewsFeedWidget::onFilterTextChanged(const QString &text)
 void NewsFeedWidget::onFeedSelectionChanged(int index)
 {
     if (index >= 0 && index < m_feedSelector->count()) {
-        QString feedName = m_feedSelector->itemText(index);
+        QString feedName = m_feedSelector->itemData(index).toString();
+        if (SavedSearches::isSource(feedName)) {
+            setFeedUrl(feedName);
+            return;
+        }
         QHash<QString, QPair<QString, QString>> feeds = m_model->parser()->getFeeds();
         if (feeds.contains(feedName)) {
             QString url = feeds[feedName].first;
@@ -576,15 +605,29 @@ void NewsFeedWidget::onShowUnreadOnlyToggled(bool checked)
     m_proxyModel->setShowUnreadOnly(checked);
 }
 
-void NewsFeedWidget::onCategoryFilterChanged(const QString &category)
+void NewsFeedWidget::onCategoryFilterChanged(int index)
 {
-    if (category == tr("All Categories")) {
-        m_proxyModel->setFilterCategory("");
-    } else {
-        m_proxyModel->setFilterCategory(category);
+    // "All Categories" carries an empty name
+    m_proxyModel->setFilterCategory(m_categoryCombo->itemData(index).toString());
+}
+
+void NewsFeedWidget::onThemeChanged()
+{
+    m_detailView->document()->setDefaultStyleSheet(ThemeManager::instance().articleStyleSheet());
+    m_listView->viewport()->update();
+    
+    // The open article picks up the new CSS only when set again
+    QModelIndex current = m_listView->currentIndex();
+    if (current.isValid()) {
+        onItemSelected(current);
     }
 }
 
+void NewsFeedWidget::onSortModeChanged(int index)
+{
+    m_proxyModel->setSortMode(FeedFilterProxyModel::SortMode(m_sortCombo->itemData(index).toInt()));
+}
+
 void NewsFeedWidget::onMarkAllReadClicked()
 {
     m_model->markAllItemsAsRead();
@@ -617,7 +660,7 @@ void NewsFeedWidget::onAddFeedClicked()
             updateFeedSelector();
             
             // Select the newly added feed
-            int index = m_feedSelector->findText(name);
+            int index = m_feedSelector->findData(name);
             if (index >= 0) {
                 m_feedSelector->setCurrentIndex(index);
             }
@@ -625,9 +668,47 @@ void NewsFeedWidget::onAddFeedClicked()
     }
 }
 
+void NewsFeedWidget::onSaveSearchClicked()
+{
+    // The search covers the open feed, or every feed when a search is open
+    SavedSearch search;
+    const QString currentUrl = m_model->parser()->currentUrl();
+    if (!SavedSearches::isSource(currentUrl)) {
+        search.feedUrl = currentUrl;
+    }
+    search.category = m_categoryCombo->currentData().toString();
+    search.text = m_filterEdit->text().trimmed();
+    search.unreadOnly = m_unreadOnlyCheck->isChecked();
+    
+    bool ok = false;
+    const QString name = QInputDialog::getText(this, tr("Save Search"), tr("Name:"), QLineEdit::Normal,
+                                               search.text, &ok).trimmed();
+    if (!ok || name.isEmpty()) {
+        return;
+    }
+    
+    search.name = name;
+    if (!m_model->parser()->addSavedSearch(search)) {
+        QMessageBox::warning(this, tr("Save Search"), tr("A saved search named '%1' already exists.").arg(name));
+        return;
+    }
+    updateFeedSelector();
+}
+
 void NewsFeedWidget::onRemoveFeedClicked()
 {
-    QString currentFeed = m_feedSelector->currentText();
+    QString currentFeed = m_feedSelector->currentData().toString();
+    if (SavedSearches::isSource(currentFeed)) {
+        const QString name = SavedSearches::sourceName(currentFeed);
+        if (QMessageBox::question(this, tr("Remove Saved Search"),
+                                  tr("Are you sure you want to remove the saved search '%1'?").arg(name),
+                                  QMessageBox::Yes | QMessageBox::No, QMessageBox::No) == QMessageBox::Yes) {
+            m_model->parser()->removeSavedSearch(name);
+            updateFeedSelector();
+            onFeedSelectionChanged(m_feedSelector->currentIndex());
+        }
+        return;
+    }
     if (!currentFeed.isEmpty()) {
         QMessageBox::StandardButton result = QMessageBox::question(
             this, 
@@ -681,9 +762,7 @@ void NewsFeedWidget::onSaveArticleClicked()
             out << title << "\n\n";
             
             // Strip HTML
-            QTextDocument doc;
-            doc.setHtml(content);
-            out << doc.toPlainText() << "\n\n";
+            out << HtmlScanner::toPlainText(content) << "\n\n";
             out << m_currentLink;
         } else {
             // Save as HTML
@@ -713,6 +792,68 @@ void NewsFeedWidget::onSaveArticleClicked()
     }
 }
 
+void NewsFeedWidget::prefetchVisibleRows()
+{
+    StallScope stallScope("prefetchVisibleRows");
+    
+    const QRect viewport = m_listView->viewport()->rect();
+    QModelIndex top = m_listView->indexAt(viewport.topLeft());
+    if (!top.isValid()) {
+        return;
+    }
+    
+    // The visible page plus one page either side
+    int visibleRows = viewport.height() / FeedItemDelegate::RowHeight + 1;
+    int first = qMax(0, top.row() - visibleRows);
+    int last = qMin(m_proxyModel->rowCount() - 1, top.row() + 2 * visibleRows);
+    for (int row = first; row <= last; ++row) {
+        m_itemDelegate->prefetch(m_proxyModel->index(row, 0));
+    }
+}
+
+NewsFeedWidget::PaintBenchmark NewsFeedWidget::benchmarkHoverSweep(int sweeps)
+{
+    PaintBenchmark result;
+    QWidget *viewport = m_listView->viewport();
+    if (!viewport->isVisible() || m_proxyModel->rowCount() == 0 || sweeps < 1) {
+        return result;
+    }
+    
+    m_itemDelegate->invalidateCache();
+    
+    // Quarter-row steps, so every row is entered and left like a pointer would
+    const int step = FeedItemDelegate::RowHeight / 4;
+    const int x = viewport->width() / 2;
+    QPoint previous(x, 0);
+    double warmTotal = 0.0;
+    QElapsedTimer frame;
+    
+    for (int sweep = 0; sweep < sweeps; ++sweep) {
+        for (int y = 0; y < viewport->height(); y += step) {
+            frame.start();
+            QHoverEvent hover(QEvent::HoverMove, QPoint(x, y), previous);
+            QApplication::sendEvent(viewport, &hover);
+            viewport->repaint();
+            const double ms = frame.nsecsElapsed() / 1000000.0;
+            
+            if (result.frames == 0) {
+                result.coldMs = ms;
+            } else {
+                warmTotal += ms;
+            }
+            result.worstMs = qMax(result.worstMs, ms);
+            ++result.frames;
+            previous = QPoint(x, y);
+        }
+    }
+    
+    QHoverEvent leave(QEvent::HoverLeave, QPoint(-1, -1), previous);
+    QApplication::sendEvent(viewport, &leave);
+    
+    result.warmMs = result.frames > 1 ? warmTotal / (result.frames - 1) : 0.0;
+    return result;
+}
+
 void NewsFeedWidget::onShareArticleClicked()
 {
     if (m_currentLink.isEmpty()) {
@@ -730,7 +871,7 @@ void NewsFeedWidget::onSettingsClicked()
 {
     QDialog settingsDialog(this);
     settingsDialog.setWindowTitle(tr("Settings"));
-    settingsDialog.resize(400, 300);
+    settingsDialog.resize(400, 670);
     
     QVBoxLayout *layout = new QVBoxLayout(&settingsDialog);
     
@@ -767,13 +908,86 @@ void NewsFeedWidget::onSettingsClicked()
     QGroupBox *cacheGroup = new QGroupBox(tr("Cache"), &settingsDialog);
     QVBoxLayout *cacheLayout = new QVBoxLayout(cacheGroup);
     
+    RetentionPolicy retention = m_model->parser()->retentionPolicy();
+    QFormLayout *retentionLayout = new QFormLayout();
+    
+    QSpinBox *maxAgeSpinBox = new QSpinBox(&settingsDialog);
+    maxAgeSpinBox->setRange(0, 3650);
+    maxAgeSpinBox->setSpecialValueText(tr("Forever"));
+    maxAgeSpinBox->setSuffix(tr(" days"));
+    maxAgeSpinBox->setValue(retention.maxAgeDays);
+    retentionLayout->addRow(tr("Keep articles for:"), maxAgeSpinBox);
+    
+    QSpinBox *maxItemsSpinBox = new QSpinBox(&settingsDialog);
+    maxItemsSpinBox->setRange(0, 100000);
+    maxItemsSpinBox->setSingleStep(100);
+    maxItemsSpinBox->setSpecialValueText(tr("Unlimited"));
+    maxItemsSpinBox->setValue(retention.maxItemsPerFeed);
+    retentionLayout->addRow(tr("Articles per feed:"), maxItemsSpinBox);
+    
+    QSpinBox *maxSizeSpinBox = new QSpinBox(&settingsDialog);
+    maxSizeSpinBox->setRange(0, 10240);
+    maxSizeSpinBox->setSingleStep(50);
+    maxSizeSpinBox->setSpecialValueText(tr("Unlimited"));
+    maxSizeSpinBox->setSuffix(tr(" MB"));
+    maxSizeSpinBox->setValue(int(retention.maxTotalBytes / (1024 * 1024)));
+    retentionLayout->addRow(tr("Maximum cache size:"), maxSizeSpinBox);
+    
+    cacheLayout->addLayout(retentionLayout);
+    
     QPushButton *clearCacheButton = new QPushButton(tr("Clear Cache"), &settingsDialog);
     cacheLayout->addWidget(clearCacheButton);
     
+    // Alert settings
+    QGroupBox *alertGroup = new QGroupBox(tr("Alerts"), &settingsDialog);
+    QVBoxLayout *alertLayout = new QVBoxLayout(alertGroup);
+    
+    AlertEngine &alerts = m_model->parser()->alerts();
+    QLabel *alertHelp = new QLabel(tr("One rule per line, e.g. \"Title fight: Verstappen, Norris\""), &settingsDialog);
+    alertLayout->addWidget(alertHelp);
+    
+    QPlainTextEdit *alertRulesEdit = new QPlainTextEdit(&settingsDialog);
+    alertRulesEdit->setPlainText(AlertEngine::formatRules(alerts.rules()));
+    alertRulesEdit->setMaximumHeight(90);
+    alertLayout->addWidget(alertRulesEdit);
+    
+    QFormLayout *throttleLayout = new QFormLayout();
+    QSpinBox *throttleSpinBox = new QSpinBox(&settingsDialog);
+    throttleSpinBox->setRange(0, 1440);
+    throttleSpinBox->setSuffix(tr(" min"));
+    throttleSpinBox->setValue(int(alerts.throttleSecs() / 60));
+    throttleLayout->addRow(tr("Repeat an alert after:"), throttleSpinBox);
+    alertLayout->addLayout(throttleLayout);
+    
+    // Local API settings
+    QGroupBox *apiGroup = new QGroupBox(tr("Local API"), &settingsDialog);
+    QFormLayout *apiLayout = new QFormLayout(apiGroup);
+    
+    QCheckBox *enableApi = new QCheckBox(tr("Serve articles as JSON on localhost"), &settingsDialog);
+    enableApi->setChecked(m_apiServer->isEnabled());
+    apiLayout->addRow(enableApi);
+    
+    QSpinBox *apiPortSpinBox = new QSpinBox(&settingsDialog);
+    apiPortSpinBox->setRange(1024, 65535);
+    apiPortSpinBox->setValue(m_apiServer->port());
+    apiPortSpinBox->setEnabled(m_apiServer->isEnabled());
+    apiLayout->addRow(tr("Port:"), apiPortSpinBox);
+    
+    // Browsers may read the API only from origins listed here
+    QLineEdit *apiOriginsEdit = new QLineEdit(m_apiServer->allowedOrigins().join(QStringLiteral(", ")), &settingsDialog);
+    apiOriginsEdit->setPlaceholderText(tr("None, e.g. http://localhost:3000"));
+    apiOriginsEdit->setEnabled(m_apiServer->isEnabled());
+    apiLayout->addRow(tr("Allowed origins:"), apiOriginsEdit);
+    
+    connect(enableApi, &QCheckBox::toggled, apiPortSpinBox, &QSpinBox::setEnabled);
+    connect(enableApi, &QCheckBox::toggled, apiOriginsEdit, &QLineEdit::setEnabled);
+    
     // Add everything to the main layout
     layout->addWidget(notificationGroup);
     layout->addWidget(refreshGroup);
+    layout->addWidget(alertGroup);
     layout->addWidget(cacheGroup);
+    layout->addWidget(apiGroup);
     
     // Button box
     QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
@@ -795,6 +1009,26 @@ void NewsFeedWidget::onSettingsClicked()
         m_autoRefreshEnabled = enableAutoRefresh->isChecked();
         m_autoRefreshInterval = intervalSpinBox->value();
         
+        // Apply retention limits
+        RetentionPolicy policy;
+        policy.maxAgeDays = maxAgeSpinBox->value();
+        policy.maxItemsPerFeed = maxItemsSpinBox->value();
+        policy.maxTotalBytes = qint64(maxSizeSpinBox->value()) * 1024 * 1024;
+        m_model->parser()->setRetentionPolicy(policy);
+        
+        // Recompile the alert rules
+        alerts.setRules(AlertEngine::parseRules(alertRulesEdit->toPlainText()));
+        alerts.setThrottleSecs(qint64(throttleSpinBox->value()) * 60);
+        alerts.save();
+        
+        // Restart the API on the chosen port
+        m_apiServer->setAllowedOrigins(apiOriginsEdit->text().split(QLatin1Char(','), QtCompat::SkipEmptyParts));
+        if (!m_apiServer->setEnabled(enableApi->isChecked(), quint16(apiPortSpinBox->value()))) {
+            QMessageBox::warning(this, tr("Local API"), tr("Could not listen on port %1: %2")
+                                 .arg(apiPortSpinBox->value()).arg(m_apiServer->errorString()));
+        }
+        m_apiServer->saveSettings();
+        
         // Update auto-refresh timer
         if (m_autoRefreshEnabled) {
             m_autoRefreshTimer->start(m_autoRefreshInterval * 60 * 1000);
@@ -809,12 +1043,16 @@ void NewsFeedWidget::onSettingsClicked()
 void NewsFeedWidget::handleNewItemsNotification(int count, const QString &feedName)
 {
     if (m_notificationsEnabled && count > 0) {
-        QString title = tr("New Articles");
-        QString message = tr("%1 new article(s) in %2").arg(count).arg(feedName);
-        showNotification(title, message);
+        m_notifier->postArticles(feedName, count);
     }
 }
 
+void NewsFeedWidget::handleAlert(const QString &rule, const QString &title, const QString &feedName)
+{
+    // Alerts are opted into per rule, so they bypass the new-article switch
+    m_notifier->postAlert(rule, title, feedName);
+}
+
 void NewsFeedWidget::handleFeedError(const QString &message)
 {
     m_statusLabel->setText(message);
@@ -855,8 +1093,11 @@ void NewsFeedWidget::saveSettings()
     settings.setValue("autoRefreshEnabled", m_autoRefreshEnabled);
     settings.setValue("autoRefreshInterval", m_autoRefreshInterval);
     
+    // Save list ordering
+    settings.setValue("sortMode", m_sortCombo->currentData());
+    
     // Save current feed
-    settings.setValue("currentFeed", m_feedSelector->currentText());
+    settings.setValue("currentFeed", m_feedSelector->currentData());
 }
 
 void NewsFeedWidget::loadSettings()
@@ -873,10 +1114,16 @@ void NewsFeedWidget::loadSettings()
     m_autoRefreshEnabled = settings.value("autoRefreshEnabled", true).toBool();
     m_autoRefreshInterval = settings.value("autoRefreshInterval", 30).toInt();
     
+    // Restore list ordering
+    int sortIndex = m_sortCombo->findData(settings.value("sortMode", FeedFilterProxyModel::SortByTime).toInt());
+    if (sortIndex >= 0) {
+        m_sortCombo->setCurrentIndex(sortIndex);
+    }
+    
     // Restore selected feed
     QString lastFeed = settings.value("currentFeed").toString();
     if (!lastFeed.isEmpty()) {
-        int index = m_feedSelector->findText(lastFeed);
+        int index = m_feedSelector->findData(lastFeed);
         if (index >= 0) {
             m_feedSelector->setCurrentIndex(index);
         }
@@ -24,6 +24,7 @@
 #include <QSpinBox>
 
 #include "rssfeedmodel.h"
+#include "notificationaggregator.h"
 
 class AddFeedDialog : public QDialog
 {
@@ -46,6 +47,9 @@ private:
     void setupUi();
 };
 
+class FeedItemDelegate;
+class LocalApiServer;
+
 class NewsFeedWidget : public QWidget
 {
     Q_OBJECT
@@ -55,16 +59,31 @@ public:
     ~NewsFeedWidget();
     
     void setFeedUrl(const QString &url);
+    
+    // Selects a feed or saved search by name or URL; false if there is none
+    bool openFeed(const QString &feed);
+    void refreshAllFeeds();
     void onRefreshClicked();
     void onSettingsClicked();
     
     // Get the active model for main window access
     RssFeedModel* getFeedModel() const { return m_model; }
     
+    // Hovers down every visible row, repainting the whole list once per step;
+    // the first frame starts with empty delegate caches
+    struct PaintBenchmark {
+        int frames = 0;
+        double coldMs = 0.0;  // first frame, every row laid out
+        double warmMs = 0.0;  // mean of the remaining frames
+        double worstMs = 0.0;
+    };
+    PaintBenchmark benchmarkHoverSweep(int sweeps);
+    
 public slots:
     void handleNewItemsNotification(int count, const QString &feedName);
     void handleFeedError(const QString &message);
     void handleStatusMessage(const QString &message);
+    void handleAlert(const QString &rule, const QString &title, const QString &feedName);
     
 signals:
     void statusMessageChanged(const QString &message);
@@ -76,13 +95,18 @@ private slots:
     void onFeedSelectionChanged(int index);
     void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
     void onShowUnreadOnlyToggled(bool checked);
-    void onCategoryFilterChanged(const QString &category);
+    void onCategoryFilterChanged(int index);
+    void onSortModeChanged(int index);
     void onMarkAllReadClicked();
     void onMarkReadClicked();
     void onAddFeedClicked();
     void onRemoveFeedClicked();
+    void onSaveSearchClicked();
     void onSaveArticleClicked();
     void onShareArticleClicked();
+    void prefetchVisibleRows();
+    void onAutoRefresh();
+    void onThemeChanged();
     
 private:
     void setupUi();
@@ -90,6 +114,7 @@ private:
     void setupCategoryCombo();
     void setupToolbars();
     void updateFeedSelector();
+    void updateUnreadCounts();
     void showNotification(const QString &title, const QString &message);
     void saveSettings();
     void loadSettings();
@@ -98,6 +123,8 @@ private:
     RssFeedModel *m_model;
     FeedFilterProxyModel *m_proxyModel;
     QListView *m_listView;
+    FeedItemDelegate *m_itemDelegate;
+    QTimer *m_prefetchTimer;
     QTextBrowser *m_detailView;
     
     // UI controls
@@ -105,10 +132,12 @@ private:
     QComboBox *m_feedSelector;
     QComboBox *m_categoryCombo;
     QCheckBox *m_unreadOnlyCheck;
+    QComboBox *m_sortCombo;
     QPushButton *m_refreshButton;
     QPushButton *m_openLinkButton;
     QPushButton *m_markReadButton;
     QPushButton *m_markAllReadButton;
+    QPushButton *m_saveSearchButton;
     QPushButton *m_saveButton;
     QPushButton *m_shareButton;
     QLineEdit *m_filterEdit;
@@ -126,6 +155,10 @@ private:
     // Tray icon
     QSystemTrayIcon *m_trayIcon;
     QMenu *m_trayMenu;
+    NotificationAggregator *m_notifier;
+    
+    // Opt-in localhost JSON API over the article store
+    LocalApiServer *m_apiServer;
     
     // Current state
     QString m_currentLink;
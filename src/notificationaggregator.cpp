@@ -0,0 +1,121 @@
+#include "notificationaggregator.h"
+
+#include <QDateTime>
+
+NotificationAggregator::NotificationAggregator(QObject *parent)
+    : QObject(parent),
+      m_windowMs(3000),
+      m_minIntervalMs(60 * 1000)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &NotificationAggregator::flush);
+}
+
+void NotificationAggregator::postArticles(const QString &feedName, int count)
+{
+    if (count <= 0) {
+        return;
+    }
+    if (!m_pending.contains(feedName)) {
+        m_order.append(feedName);
+    }
+    m_pending[feedName].articles += count;
+    schedule(m_windowMs);
+}
+
+void NotificationAggregator::postAlert(const QString &rule, const QString &title, const QString &feedName)
+{
+    if (!m_pending.contains(feedName)) {
+        m_order.append(feedName);
+    }
+    Pending &pending = m_pending[feedName];
+    pending.alerts++;
+    pending.alertRule = rule;
+    pending.alertTitle = title;
+    schedule(m_windowMs);
+}
+
+void NotificationAggregator::schedule(int delayMs)
+{
+    // The window runs from the first event, so a steady trickle cannot
+    // postpone the summary forever
+    if (!m_timer.isActive()) {
+        m_timer.start(delayMs);
+    }
+}
+
+void NotificationAggregator::flush()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    
+    // Feeds still inside their interval wait for the next round
+    QStringList ready;
+    qint64 nextDue = -1;
+    for (const QString &feed : m_order) {
+        qint64 due = m_lastShown.value(feed, -m_minIntervalMs) + m_minIntervalMs;
+        if (due <= now) {
+            ready.append(feed);
+        } else if (nextDue < 0 || due < nextDue) {
+            nextDue = due;
+        }
+    }
+    
+    if (!ready.isEmpty()) {
+        int articles = 0;
+        int alerts = 0;
+        QString alertRule, alertTitle, alertFeed, articleFeed;
+        QStringList listed;
+        for (const QString &feed : ready) {
+            const Pending pending = m_pending.take(feed);
+            m_order.removeOne(feed);
+            m_lastShown.insert(feed, now);
+            
+            articles += pending.articles;
+            alerts += pending.alerts;
+            if (pending.alerts > 0) {
+                alertRule = pending.alertRule;
+                alertTitle = pending.alertTitle;
+                alertFeed = feed;
+            }
+            if (pending.articles > 0) {
+                listed.append(tr("%1 (%2)").arg(feed).arg(pending.articles));
+                articleFeed = feed;
+            }
+        }
+        
+        // One balloon per round; alerts lead, article counts follow
+        QString title;
+        QStringList lines;
+        if (alerts == 1) {
+            title = tr("Alert: %1").arg(alertRule);
+            lines.append(tr("%1 (%2)").arg(alertTitle, alertFeed));
+        } else if (alerts > 1) {
+            title = tr("%1 alerts").arg(alerts);
+            lines.append(tr("Latest: %1 (%2)").arg(alertTitle, alertFeed));
+        }
+        
+        if (listed.size() == 1) {
+            if (title.isEmpty()) {
+                title = tr("New Articles");
+            }
+            lines.append(tr("%1 new article(s) in %2").arg(articles).arg(articleFeed));
+        } else if (listed.size() > 1) {
+            if (title.isEmpty()) {
+                title = tr("New Articles");
+            }
+            lines.append(tr("%1 new articles in %2 feeds").arg(articles).arg(listed.size()));
+            if (listed.size() > MaxListedFeeds) {
+                int more = listed.size() - MaxListedFeeds;
+                listed = listed.mid(0, MaxListedFeeds);
+                listed.append(tr("%1 more").arg(more));
+            }
+            lines.append(listed.join(", "));
+        }
+        
+        emit notify(title, lines.join('\n'));
+    }
+    
+    if (nextDue >= 0) {
+        m_timer.start(int(qMax<qint64>(nextDue - now, m_windowMs)));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef NOTIFICATIONAGGREGATOR_H
+#define NOTIFICATIONAGGREGATOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <QStringList>
+
+// Coalesces notification events into tray balloons. Events collected during
+// a short window become one summary; a feed shown recently is held back
+// until its interval has passed, and its events keep merging meanwhile. A
+// newer alert for a feed supersedes the pending one, article counts add up.
+class NotificationAggregator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NotificationAggregator(QObject *parent = nullptr);
+
+    void setWindowMs(int ms) { m_windowMs = ms; }
+    void setMinIntervalSecs(int secs) { m_minIntervalMs = qint64(secs) * 1000; }
+
+    void postArticles(const QString &feedName, int count);
+    void postAlert(const QString &rule, const QString &title, const QString &feedName);
+
+signals:
+    void notify(const QString &title, const QString &message);
+
+private slots:
+    void flush();
+
+private:
+    struct Pending {
+        int articles = 0;
+        int alerts = 0;
+        QString alertRule;  // latest alert only
+        QString alertTitle;
+    };
+
+    static const int MaxListedFeeds = 4;
+
+    QHash<QString, Pending> m_pending;
+    QStringList m_order;                // feeds in arrival order
+    QHash<QString, qint64> m_lastShown; // feed -> msecs since epoch
+    QTimer m_timer;
+    int m_windowMs;
+    qint64 m_minIntervalMs;
+
+    void schedule(int delayMs);
+};
+
+#endif // NOTIFICATIONAGGREGATOR_H
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef QTCOMPAT_H
+#define QTCOMPAT_H
+
+#include <QString>
+
+// Names that moved between the Qt versions the application builds with.
+// Qt 5.14 moved the split flags to Qt::SplitBehavior and deprecated the
+// QString ones; 5.12 only has those.
+namespace QtCompat {
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+const Qt::SplitBehavior SkipEmptyParts = Qt::SkipEmptyParts;
+#else
+const QString::SplitBehavior SkipEmptyParts = QString::SkipEmptyParts;
+#endif
+
+} // namespace QtCompat
+
+#endif // QTCOMPAT_H
\ No newline at end of file
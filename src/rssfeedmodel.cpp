@@ -1,12 +1,20 @@
 #include "rssfeedmodel.h"
+#include "stallwatchdog.h"
+#include "categoryindex.h"
 #include <QDebug>
 #include <QSettings>
 #include <QRegularExpression>
 
+#include <algorithm>
+
 // FilterProxyModel implementation
 FeedFilterProxyModel::FeedFilterProxyModel(QObject *parent)
     : QSortFilterProxyModel(parent),
-      m_showUnreadOnly(false)
+      m_feedModel(nullptr),
+      m_filterCategoryId(0),
+      m_showUnreadOnly(false),
+      m_sortMode(SortByTime),
+      m_searchMatchesValid(false)
 {
     setFilterCaseSensitivity(Qt::CaseInsensitive);
 }
@@ -15,6 +23,7 @@ void FeedFilterProxyModel::setFilterCategory(const QString &category)
 {
     if (m_filterCategory != category) {
         m_filterCategory = category;
+        m_filterCategoryId = CategoryIndex::instance().find(category);
         invalidateFilter();
     }
 }
@@ -31,18 +40,80 @@ void FeedFilterProxyModel::setSearchText(const QString &text)
 {
     if (m_searchText != text) {
         m_searchText = text;
-        invalidateFilter();
+        m_searchMatchesValid = false;
+        if (m_sortMode == SortByRelevance) {
+            resort();
+        } else {
+            invalidateFilter();
+        }
+    }
+}
+
+void FeedFilterProxyModel::setSortMode(SortMode mode)
+{
+    if (m_sortMode != mode) {
+        m_sortMode = mode;
+        resort();
     }
 }
 
+void FeedFilterProxyModel::resort()
+{
+    StallScope stallScope("resort");
+    
+    // Keys are rebuilt once, on the first comparison
+    m_sortKeys.clear();
+    invalidate();
+}
+
+void FeedFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (this->sourceModel()) {
+        disconnect(this->sourceModel(), nullptr, this, nullptr);
+    }
+    
+    // Connected before the base class, so the keys are current when it
+    // refilters on reset or moves changed rows
+    m_feedModel = qobject_cast<RssFeedModel*>(sourceModel);
+    m_sortKeys.clear();
+    if (sourceModel) {
+        connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, [this]() {
+            m_searchMatchesValid = false;
+            m_sortKeys.clear();
+        });
+        // Paged-in history and held back rows are matched by a fresh query
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeInserted, this, [this]() {
+            m_searchMatchesValid = false;
+        });
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this,
+                [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+            updateSortKeys(topLeft.row(), bottomRight.row());
+        });
+    }
+    if (m_feedModel) {
+        connect(m_feedModel, &RssFeedModel::feedsUpdated, this, [this]() {
+            if (m_sortMode == SortByFeed) {
+                resort();
+            }
+        });
+    }
+    
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+    
+    // Rows arriving later are inserted at their sorted position
+    sort(0, Qt::DescendingOrder);
+}
+
 bool FeedFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
+    StallScope stallScope("filterAcceptsRow");
+    
     QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
     
-    // Check category filter
+    // Check category filter, a mask test on the item
     if (!m_filterCategory.isEmpty()) {
-        QString category = sourceModel()->data(index, RssFeedModel::CategoryRole).toString();
-        if (!category.contains(m_filterCategory, Qt::CaseInsensitive)) {
+        if (m_filterCategoryId == 0 || !m_feedModel || sourceParent.isValid()
+            || !m_feedModel->itemHasCategory(sourceRow, m_filterCategoryId)) {
             return false;
         }
     }
@@ -58,24 +129,136 @@ bool FeedFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &so
     // Check text search
     if (!m_searchText.isEmpty()) {
         QString title = sourceModel()->data(index, RssFeedModel::TitleRole).toString();
-        QString description = sourceModel()->data(index, RssFeedModel::DescriptionRole).toString();
-        QString category = sourceModel()->data(index, RssFeedModel::CategoryRole).toString();
+        QStringList categories = sourceModel()->data(index, RssFeedModel::CategoriesRole).toStringList();
+        if (title.contains(m_searchText, Qt::CaseInsensitive) || categoriesMatch(categories)) {
+            return true;
+        }
         
-        return title.contains(m_searchText, Qt::CaseInsensitive) ||
-               description.contains(m_searchText, Qt::CaseInsensitive) ||
-               category.contains(m_searchText, Qt::CaseInsensitive);
+        if (!m_feedModel || sourceParent.isValid()) {
+            return false;
+        }
+        const QList<FeedItem> &items = m_feedModel->items();
+        return sourceRow < items.size() && bodyMatches(items.at(sourceRow));
     }
     
     return true;
 }
 
+bool FeedFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    if (!m_feedModel || left.parent().isValid()) {
+        return QSortFilterProxyModel::lessThan(left, right);
+    }
+    
+    // Keys only; no role is converted while sorting
+    return sortKey(left.row()) < sortKey(right.row());
+}
+
+quint64 FeedFilterProxyModel::sortKey(int sourceRow) const
+{
+    // Rows appended since the last comparison get their keys in one pass
+    if (sourceRow >= m_sortKeys.size()) {
+        const int first = m_sortKeys.size();
+        m_sortKeys.resize(qMax(m_feedModel->rowCount(), sourceRow + 1));
+        for (int row = first; row < m_sortKeys.size(); ++row) {
+            m_sortKeys[row] = computeSortKey(row);
+        }
+    }
+    return m_sortKeys.at(sourceRow);
+}
+
+quint64 FeedFilterProxyModel::computeSortKey(int sourceRow) const
+{
+    const QList<FeedItem> &items = m_feedModel->items();
+    if (sourceRow < 0 || sourceRow >= items.size()) {
+        return 0;
+    }
+    
+    // The ordering field goes above the time, which breaks ties newest first
+    const FeedItem &item = items.at(sourceRow);
+    const quint64 time = quint64(qBound<qint64>(0, item.ageTime(), (Q_INT64_C(1) << TimeBits) - 1));
+    switch (m_sortMode) {
+    case SortByFeed:
+        // Descending order, so the first feed name needs the largest key
+        return quint64(0xFFFF - m_feedModel->feedRank(item.feedId)) << TimeBits | time;
+    case SortUnreadFirst:
+        return quint64(item.isRead ? 0 : 1) << TimeBits | time;
+    case SortByRelevance:
+        return quint64(searchTier(item)) << TimeBits | time;
+    case SortByTime:
+        break;
+    }
+    return time;
+}
+
+int FeedFilterProxyModel::searchTier(const FeedItem &item) const
+{
+    // Same matches as the filter: title, then category, then body
+    if (m_searchText.isEmpty()) {
+        return 0;
+    }
+    if (item.title.contains(m_searchText, Qt::CaseInsensitive)) {
+        return 3;
+    }
+    if (categoriesMatch(item.categories())) {
+        return 2;
+    }
+    
+    return bodyMatches(item) ? 1 : 0;
+}
+
+bool FeedFilterProxyModel::bodyMatches(const FeedItem &item) const
+{
+    // Fetched rows are inserted before they are stored and still carry their body
+    if (!item.descriptionUtf8().isEmpty()) {
+        return item.description().contains(m_searchText, Qt::CaseInsensitive);
+    }
+    
+    if (!m_searchMatchesValid) {
+        m_searchMatches = m_feedModel->searchItems(m_searchText);
+        m_searchMatchesValid = true;
+    }
+    return m_searchMatches.contains(item.guidKey());
+}
+
+bool FeedFilterProxyModel::categoriesMatch(const QStringList &categories) const
+{
+    // Any category of the item, not just the first
+    for (const QString &category : categories) {
+        if (category.contains(m_searchText, Qt::CaseInsensitive)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FeedFilterProxyModel::updateSortKeys(int first, int last)
+{
+    // Rows without a key yet are computed on first use
+    if (!m_feedModel) {
+        return;
+    }
+    for (int row = qMax(first, 0); row <= last && row < m_sortKeys.size(); ++row) {
+        m_sortKeys[row] = computeSortKey(row);
+    }
+}
+
 // RssFeedModel implementation
 RssFeedModel::RssFeedModel(QObject *parent)
-    : QAbstractListModel(parent)
+    : QAbstractListModel(parent),
+      m_countedRows(0),
+      m_countedGeneration(0),
+      m_rowsGeneration(0),
+      m_appending(false),
+      m_suspended(false),
+      m_pendingUpdate(false)
 {
     m_parser = new RssParser(this);
     
     connect(m_parser, &RssParser::feedUpdated, this, &RssFeedModel::onFeedUpdated);
+    connect(m_parser, &RssParser::itemsAboutToBeAppended, this, &RssFeedModel::onItemsAboutToBeAppended);
+    connect(m_parser, &RssParser::itemsAppended, this, &RssFeedModel::onItemsAppended);
+    connect(this, &RssFeedModel::feedsUpdated, this, &RssFeedModel::updateFeedRanks);
     connect(m_parser, &RssParser::error, this, &RssFeedModel::onError);
     connect(m_parser, &RssParser::statusMessage, this, &RssFeedModel::onStatusMessage);
     connect(m_parser, &RssParser::newItemsAvailable, this, &RssFeedModel::handleNewItems);
@@ -210,34 +393,44 @@ int RssFeedModel::rowCount(const QModelIndex &parent) const
     if (parent.isValid())
         return 0;
     
-    return m_parser->getItems().count();
+    return items().count();
 }
 
 QVariant RssFeedModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_parser->getItems().count())
+    if (!index.isValid() || index.row() >= items().count())
         return QVariant();
     
-    // Get a copy to avoid dangling reference
-    FeedItem item = m_parser->getItems().at(index.row());
+    // The parser only changes its items between model resets
+    const FeedItem &item = items().at(index.row());
     
     switch (role) {
     case TitleRole:
         return item.title;
     case LinkRole:
-        return item.link;
+        return item.link();
     case DescriptionRole:
-        return item.description;
+        return m_parser->description(item);
     case PubDateRole:
         return item.pubDate;
     case ImageUrlRole:
-        return item.imageUrl;
+        return item.imageUrl();
     case CategoryRole:
-        return item.category;
+        return item.category();
     case IsReadRole:
         return item.isRead;
     case GuidRole:
-        return item.guid;
+        return item.guid();
+    case SnippetRole:
+        return item.snippet();
+    case WordCountRole:
+        return item.wordCount;
+    case OtherSourcesRole:
+        return m_parser->otherSources(item);
+    case PubTimeRole:
+        return item.pubTime;
+    case CategoriesRole:
+        return item.categories();
     default:
         return QVariant();
     }
@@ -245,14 +438,31 @@ QVariant RssFeedModel::data(const QModelIndex &index, int role) const
 
 bool RssFeedModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (!index.isValid() || index.row() >= m_parser->getItems().count())
+    if (!index.isValid() || index.row() >= items().count())
         return false;
     
     if (role == IsReadRole) {
-        QString guid = data(index, GuidRole).toString();
+        const FeedItem &item = items().at(index.row());
+        QString guid = item.guid();
         if (!guid.isEmpty()) {
-            m_parser->setItemAsRead(guid);
+            // Counted rows leave the unread tallies of their categories
+            const bool countRead = !item.isRead && index.row() < m_countedRows && item.categoryId != 0;
+            if (countRead) {
+                m_categoryCounts[item.categoryId].unread--;
+                for (quint16 id : item.moreCategoryIds()) {
+                    m_categoryCounts[id].unread--;
+                }
+            }
+            
+            m_parser->setItemAsRead(item.feedUrl(), guid);
+            // Rows held by hidden views show the new state as well
+            if (m_suspended) {
+                m_suspendedItems[index.row()].isRead = true;
+            }
             emit dataChanged(index, index, {IsReadRole});
+            if (countRead) {
+                emit categoryCountsChanged();
+            }
             return true;
         }
     }
@@ -271,9 +481,118 @@ QHash<int, QByteArray> RssFeedModel::roleNames() const
     roles[CategoryRole] = "category";
     roles[IsReadRole] = "isRead";
     roles[GuidRole] = "guid";
+    roles[SnippetRole] = "snippet";
+    roles[WordCountRole] = "wordCount";
+    roles[OtherSourcesRole] = "otherSources";
+    roles[PubTimeRole] = "pubTime";
+    roles[CategoriesRole] = "categories";
     return roles;
 }
 
+bool RssFeedModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_suspended && m_parser->canFetchMore();
+}
+
+void RssFeedModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    
+    StallScope stallScope("fetchMore");
+    
+    // Older rows go at the end, so the rows on screen keep their indexes
+    QList<FeedItem> page = m_parser->fetchHistoryPage(HistoryPageSize);
+    if (page.isEmpty()) {
+        return;
+    }
+    
+    const int first = m_parser->items().count();
+    beginInsertRows(QModelIndex(), first, first + page.size() - 1);
+    m_parser->appendItems(page);
+    endInsertRows();
+    
+    updateCategoryCounts();
+}
+
+bool RssFeedModel::itemHasCategory(int row, quint16 categoryId) const
+{
+    const QList<FeedItem> &rows = items();
+    return row >= 0 && row < rows.size() && rows.at(row).hasCategory(categoryId);
+}
+
+int RssFeedModel::feedRank(quint16 feedId) const
+{
+    return feedId < m_feedRanks.size() ? m_feedRanks.at(feedId) : 0xFFFF;
+}
+
+void RssFeedModel::updateFeedRanks()
+{
+    QStringList names = m_feeds.keys();
+    std::sort(names.begin(), names.end(), [](const QString &a, const QString &b) {
+        return a.compare(b, Qt::CaseInsensitive) < 0;
+    });
+    
+    // Indexed by feed ID; feeds that are not configured sort last
+    m_feedRanks.clear();
+    for (int rank = 0; rank < names.size(); ++rank) {
+        const quint16 id = InternTable::feeds().intern(m_feeds.value(names.at(rank)).first);
+        while (m_feedRanks.size() <= id) {
+            m_feedRanks.append(0xFFFF);
+        }
+        m_feedRanks[id] = quint16(rank);
+    }
+}
+
+QList<CategoryCount> RssFeedModel::categoryCounts() const
+{
+    QList<CategoryCount> counts;
+    for (auto it = m_categoryCounts.constBegin(); it != m_categoryCounts.constEnd(); ++it) {
+        CategoryCount count = it.value();
+        count.name = InternTable::categories().value(it.key());
+        counts.append(count);
+    }
+    
+    // Most common first
+    std::sort(counts.begin(), counts.end(), [](const CategoryCount &a, const CategoryCount &b) {
+        return a.items != b.items ? a.items > b.items : a.name < b.name;
+    });
+    return counts;
+}
+
+void RssFeedModel::updateCategoryCounts()
+{
+    // Items are appended between refreshes; anything else starts over
+    const QList<FeedItem> &items = m_parser->items();
+    if (m_parser->itemsGeneration() != m_countedGeneration || items.size() < m_countedRows) {
+        m_categoryCounts.clear();
+        m_countedRows = 0;
+        m_countedGeneration = m_parser->itemsGeneration();
+    } else if (items.size() == m_countedRows) {
+        return;
+    }
+    
+    for (int i = m_countedRows; i < items.size(); ++i) {
+        const FeedItem &item = items.at(i);
+        if (item.categoryId == 0) {
+            continue;
+        }
+        const int unread = item.isRead ? 0 : 1;
+        CategoryCount &count = m_categoryCounts[item.categoryId];
+        count.items++;
+        count.unread += unread;
+        for (quint16 id : item.moreCategoryIds()) {
+            CategoryCount &more = m_categoryCounts[id];
+            more.items++;
+            more.unread += unread;
+        }
+    }
+    m_countedRows = items.size();
+    
+    emit categoryCountsChanged();
+}
+
 void RssFeedModel::setFeedUrl(const QString &url)
 {
     m_currentFeedUrl = url;
@@ -300,11 +619,86 @@ void RssFeedModel::refresh()
     }
 }
 
+void RssFeedModel::setViewUpdatesSuspended(bool suspended)
+{
+    if (suspended == m_suspended) {
+        return;
+    }
+    
+    if (suspended) {
+        m_suspendedItems = m_parser->items();
+        m_pendingUpdate = false;
+        m_suspended = true;
+        return;
+    }
+    
+    if (!m_pendingUpdate) {
+        m_suspended = false;
+        m_suspendedItems.clear();
+        return;
+    }
+    
+    StallScope stallScope("resumeUpdates");
+    
+    // The views still see the old row count until the change is announced
+    const int rows = m_parser->items().count();
+    if (m_parser->itemsGeneration() == m_rowsGeneration) {
+        if (rows > m_suspendedItems.count()) {
+            beginInsertRows(QModelIndex(), m_suspendedItems.count(), rows - 1);
+            m_suspended = false;
+            endInsertRows();
+        }
+    } else {
+        beginResetModel();
+        m_rowsGeneration = m_parser->itemsGeneration();
+        m_suspended = false;
+        endResetModel();
+    }
+    m_suspended = false;
+    m_pendingUpdate = false;
+    m_suspendedItems.clear();
+    
+    updateCategoryCounts();
+}
+
 void RssFeedModel::onFeedUpdated()
 {
-    beginResetModel();
-    // The data is already updated in the parser
-    endResetModel();
+    if (m_suspended) {
+        m_pendingUpdate = true;
+        return;
+    }
+    
+    // Fetched rows were inserted as they arrived; anything else is a reset
+    if (m_parser->itemsGeneration() != m_rowsGeneration) {
+        StallScope stallScope("modelReset");
+        
+        beginResetModel();
+        // The data is already updated in the parser
+        m_rowsGeneration = m_parser->itemsGeneration();
+        endResetModel();
+    }
+    
+    updateCategoryCounts();
+}
+
+void RssFeedModel::onItemsAboutToBeAppended(int count)
+{
+    // After a clear or trim the views' rows are stale; the reset that
+    // follows brings in the new rows as well. Hidden views get them on resume.
+    m_pendingUpdate = m_pendingUpdate || m_suspended;
+    m_appending = !m_suspended && m_parser->itemsGeneration() == m_rowsGeneration;
+    if (m_appending) {
+        const int first = m_parser->items().count();
+        beginInsertRows(QModelIndex(), first, first + count - 1);
+    }
+}
+
+void RssFeedModel::onItemsAppended()
+{
+    if (m_appending) {
+        m_appending = false;
+        endInsertRows();
+    }
 }
 
 void RssFeedModel::onError(const QString &message)
@@ -345,10 +739,32 @@ void RssFeedModel::markItemAsRead(const QModelIndex &index)
 
 void RssFeedModel::markAllItemsAsRead()
 {
-    for (int i = 0; i < rowCount(); i++) {
-        QModelIndex idx = index(i, 0);
-        if (!data(idx, IsReadRole).toBool()) {
-            setData(idx, true, IsReadRole);
+    const int rows = rowCount();
+    if (rows == 0) {
+        return;
+    }
+    
+    // Counted rows leave the unread tallies of their categories
+    bool countsChanged = false;
+    const QList<FeedItem> &items = m_parser->items();
+    for (int i = 0; i < m_countedRows && i < items.size(); ++i) {
+        const FeedItem &item = items.at(i);
+        if (!item.isRead && !item.guidKey().isEmpty() && item.categoryId != 0) {
+            m_categoryCounts[item.categoryId].unread--;
+            for (quint16 id : item.moreCategoryIds()) {
+                m_categoryCounts[id].unread--;
+            }
+            countsChanged = true;
         }
     }
+    
+    // One store transaction and one view update for the whole list
+    m_parser->setAllItemsAsRead();
+    for (FeedItem &item : m_suspendedItems) {
+        item.isRead = true;
+    }
+    emit dataChanged(index(0, 0), index(rows - 1, 0), {IsReadRole});
+    if (countsChanged) {
+        emit categoryCountsChanged();
+    }
 } 
\ No newline at end of file
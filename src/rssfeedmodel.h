@@ -5,30 +5,74 @@
 #include <QSortFilterProxyModel>
 #include "rssparser.h"
 
+class RssFeedModel;
+
+// Items and unread items of one category in the current feed
+struct CategoryCount {
+    QString name;
+    int items = 0;
+    int unread = 0;
+};
+
 // Custom sort filter model for filtering by category and read status
 class FeedFilterProxyModel : public QSortFilterProxyModel
 {
     Q_OBJECT
     
 public:
+    // Orderings, newest first within each; relevance ranks title matches of
+    // the search above category and body matches
+    enum SortMode {
+        SortByTime,
+        SortByFeed,
+        SortUnreadFirst,
+        SortByRelevance
+    };
+    
     explicit FeedFilterProxyModel(QObject *parent = nullptr);
     
     // Filter settings
     void setFilterCategory(const QString &category);
     void setShowUnreadOnly(bool unreadOnly);
     void setSearchText(const QString &text);
+    void setSortMode(SortMode mode);
     
     QString filterCategory() const { return m_filterCategory; }
     bool showUnreadOnly() const { return m_showUnreadOnly; }
     QString searchText() const { return m_searchText; }
+    SortMode sortMode() const { return m_sortMode; }
+    
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
     
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
     
 private:
+    RssFeedModel *m_feedModel;
     QString m_filterCategory;
+    quint16 m_filterCategoryId; // CategoryIndex ID, 0 if no item has the category
     bool m_showUnreadOnly;
     QString m_searchText;
+    SortMode m_sortMode;
+    
+    // Descriptions are not resident, so the search runs once in the store
+    mutable QSet<QByteArray> m_searchMatches;
+    mutable bool m_searchMatchesValid;
+    
+    // Integer keys of the source rows for the current mode, larger sorts
+    // first. The source only appends rows between resets, so the keys are
+    // extended as rows arrive and recomputed only for changed rows.
+    static const int TimeBits = 40;
+    mutable QVector<quint64> m_sortKeys;
+    
+    quint64 sortKey(int sourceRow) const;
+    quint64 computeSortKey(int sourceRow) const;
+    int searchTier(const FeedItem &item) const;
+    bool bodyMatches(const FeedItem &item) const;
+    bool categoriesMatch(const QStringList &categories) const;
+    void updateSortKeys(int first, int last);
+    void resort();
 };
 
 class RssFeedModel : public QAbstractListModel
@@ -44,7 +88,12 @@ public:
         ImageUrlRole,
         CategoryRole,
         IsReadRole,
-        GuidRole
+        GuidRole,
+        SnippetRole,
+        WordCountRole,
+        OtherSourcesRole,
+        PubTimeRole,
+        CategoriesRole
     };
 
     explicit RssFeedModel(QObject *parent = nullptr);
@@ -54,6 +103,10 @@ public:
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
     QHash<int, QByteArray> roleNames() const override;
     
+    // Stored history is paged in when the view scrolls to the end
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    
     RssParser* parser() const { return m_parser; }
     
     void setFeedUrl(const QString &url);
@@ -67,6 +120,27 @@ public:
     QString feedCategory() const { return m_currentCategory; }
     QStringList availableCategories() const;
     
+    // Category filter test and per-category counts of the current feed; the
+    // counts follow appended items and read changes without a rescan
+    bool itemHasCategory(int row, quint16 categoryId) const;
+    QList<CategoryCount> categoryCounts() const;
+    
+    // Position of a feed among the feeds ordered by name, for sorting
+    int feedRank(quint16 feedId) const;
+    
+    // While no view is on screen the views keep the rows they have; fetched
+    // rows and resets are held back and applied as one insert or one reset
+    // when updates resume
+    void setViewUpdatesSuspended(bool suspended);
+    bool viewUpdatesSuspended() const { return m_suspended; }
+    
+    // Items behind the views' rows: the parser's, or while suspended the
+    // ones the views were left with
+    const QList<FeedItem> &items() const { return m_suspended ? m_suspendedItems : m_parser->items(); }
+    
+    // GUIDs of the current feed's items matching a search
+    QSet<QByteArray> searchItems(const QString &text) const { return m_parser->searchItems(text); }
+    
     // Add/remove feeds
     void addFeed(const QString &name, const QString &url, const QString &category);
     void removeFeed(const QString &name);
@@ -79,9 +153,12 @@ signals:
     void newItemsNotification(int count, const QString &feedName);
     void feedLoadError(const QString &message);
     void statusMessage(const QString &message);
+    void categoryCountsChanged();
     
 private slots:
     void onFeedUpdated();
+    void onItemsAboutToBeAppended(int count);
+    void onItemsAppended();
     void onError(const QString &message);
     void onStatusMessage(const QString &message);
     
@@ -92,8 +169,20 @@ private:
     QString m_currentCategory;
     QHash<QString, QString> m_categoryIcons;
     QHash<QString, QPair<QString, QString>> m_feeds; // name -> (url, category)
+    static const int HistoryPageSize = 200;
+    QHash<quint16, CategoryCount> m_categoryCounts; // category ID -> counts, names left empty
+    int m_countedRows;
+    quint64 m_countedGeneration;
+    quint64 m_rowsGeneration; // parser generation the views' rows belong to
+    bool m_appending;
+    bool m_suspended;
+    bool m_pendingUpdate;   // rows changed while suspended
+    QList<FeedItem> m_suspendedItems; // the views' rows while suspended, shared until the parser changes
+    QVector<quint16> m_feedRanks; // feed ID -> rank by name
     
     void setupCategoryIcons();
+    void updateFeedRanks();
+    void updateCategoryCounts();
     void loadSavedFeeds();
     void saveFeedsToSettings();
 };
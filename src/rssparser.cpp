@@ -1,18 +1,156 @@
 #include "rssparser.h"
+#include "feedmetrics.h"
+#include "stallwatchdog.h"
+#include "feedrecovery.h"
+#include "htmlscanner.h"
+#include "jsonfeedreader.h"
+#include "alertengine.h"
 
 #include <QNetworkRequest>
 #include <QDebug>
 #include <QCryptographicHash>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
 #include <QSettings>
-#include <QDomDocument>
+#include <QVector>
+
+#include <algorithm>
+
+namespace {
+
+const QString RdfNamespace = QStringLiteral("http://www.w3.org/1999/02/22-rdf-syntax-ns#");
+
+// Appends the UTF-8 encoding of text, byte for byte what QString::toUtf8()
+// produces, without a temporary QByteArray
+void appendUtf8(QByteArray &out, const QString &text)
+{
+    const int offset = out.size();
+    out.resize(offset + text.size() * 3);
+    char *dst = out.data() + offset;
+    const ushort *src = text.utf16();
+    const ushort *end = src + text.size();
+    
+    while (src < end) {
+        uint c = *src++;
+        if (c < 0x80) {
+            *dst++ = char(c);
+        } else if (c < 0x800) {
+            *dst++ = char(0xC0 | (c >> 6));
+            *dst++ = char(0x80 | (c & 0x3F));
+        } else if (QChar::isHighSurrogate(c) && src < end && QChar::isLowSurrogate(*src)) {
+            c = QChar::surrogateToUcs4(ushort(c), *src++);
+            *dst++ = char(0xF0 | (c >> 18));
+            *dst++ = char(0x80 | ((c >> 12) & 0x3F));
+            *dst++ = char(0x80 | ((c >> 6) & 0x3F));
+            *dst++ = char(0x80 | (c & 0x3F));
+        } else if (QChar::isSurrogate(c)) {
+            *dst++ = '?'; // unpaired surrogate, as QUtf8 encodes it
+        } else {
+            *dst++ = char(0xE0 | (c >> 12));
+            *dst++ = char(0x80 | ((c >> 6) & 0x3F));
+            *dst++ = char(0x80 | (c & 0x3F));
+        }
+    }
+    out.resize(int(dst - out.constData()));
+}
+
+// Elements the item parser understands, keyed on (namespace URI, local name)
+enum ElementKind {
+    UnknownElement,
+    ItemElement,
+    TitleElement,
+    LinkElement,
+    GuidElement,
+    DescriptionElement,
+    FullContentElement,
+    PubDateElement,
+    FallbackDateElement,
+    CategoryElement,
+    AtomCategoryElement,
+    AtomLinkElement,
+    EnclosureElement,
+    MediaGroupElement,
+    MediaContentElement,
+    MediaThumbnailElement
+};
+
+struct ElementName {
+    QString localName;
+    ElementKind kind;
+};
+
+struct NamespaceElements {
+    QString uri;
+    QVector<ElementName> elements;
+};
+
+const QVector<NamespaceElements> &elementTable()
+{
+    // Built once, so matching a token never allocates; the most common
+    // namespaces come first
+    static const QVector<ElementName> rss = {
+        { QStringLiteral("item"), ItemElement },
+        { QStringLiteral("title"), TitleElement },
+        { QStringLiteral("link"), LinkElement },
+        { QStringLiteral("description"), DescriptionElement },
+        { QStringLiteral("pubDate"), PubDateElement },
+        { QStringLiteral("guid"), GuidElement },
+        { QStringLiteral("category"), CategoryElement },
+        { QStringLiteral("enclosure"), EnclosureElement }
+    };
+    static const QVector<ElementName> media = {
+        { QStringLiteral("group"), MediaGroupElement },
+        { QStringLiteral("content"), MediaContentElement },
+        { QStringLiteral("thumbnail"), MediaThumbnailElement }
+    };
+    static const QVector<NamespaceElements> table = {
+        { QString(), rss },                              // RSS 2.0
+        { QStringLiteral("http://purl.org/rss/1.0/"), rss }, // RSS 1.0 (RDF)
+        { QStringLiteral("http://www.w3.org/2005/Atom"), {
+            { QStringLiteral("entry"), ItemElement },
+            { QStringLiteral("title"), TitleElement },
+            { QStringLiteral("link"), AtomLinkElement },
+            { QStringLiteral("id"), GuidElement },
+            { QStringLiteral("summary"), DescriptionElement },
+            { QStringLiteral("content"), FullContentElement },
+            { QStringLiteral("published"), PubDateElement },
+            { QStringLiteral("updated"), FallbackDateElement },
+            { QStringLiteral("category"), AtomCategoryElement } } },
+        { QStringLiteral("http://purl.org/rss/1.0/modules/content/"), {
+            { QStringLiteral("encoded"), FullContentElement } } },
+        { QStringLiteral("http://purl.org/dc/elements/1.1/"), {
+            { QStringLiteral("date"), FallbackDateElement },
+            { QStringLiteral("subject"), CategoryElement } } },
+        { QStringLiteral("http://search.yahoo.com/mrss/"), media },
+        { QStringLiteral("http://search.yahoo.com/mrss"), media }
+    };
+    return table;
+}
+
+ElementKind lookupElement(const QStringRef &namespaceUri, const QStringRef &name)
+{
+    // QStringRef == QString checks the length first, so misses are cheap
+    for (const NamespaceElements &ns : elementTable()) {
+        if (namespaceUri == ns.uri) {
+            for (const ElementName &element : ns.elements) {
+                if (name == element.localName) {
+                    return element.kind;
+                }
+            }
+            return UnknownElement;
+        }
+    }
+    return UnknownElement;
+}
+
+} // namespace
 
 RssParser::RssParser(QObject *parent) : QObject(parent), 
     m_retryCount(0), 
-    m_maxRetryAttempts(3)
+    m_maxRetryAttempts(3),
+    m_itemsGeneration(0),
+    m_totalUnread(0)
 {
+    m_descriptionCache.setMaxCost(DescriptionCacheSize);
+    
     m_networkManager = new QNetworkAccessManager(this);
     connect(m_networkManager, &QNetworkAccessManager::finished, this, &RssParser::parseReply);
     
@@ -21,16 +159,13 @@ RssParser::RssParser(QObject *parent) : QObject(parent),
     m_retryTimer->setSingleShot(true);
     connect(m_retryTimer, &QTimer::timeout, this, &RssParser::retryFetchFeed);
     
-    // Initialize network timeout timer
-    m_networkTimeoutTimer = new QTimer(this);
-    m_networkTimeoutTimer->setSingleShot(true);
-    connect(m_networkTimeoutTimer, &QTimer::timeout, this, &RssParser::handleNetworkTimeout);
-    
-    // Create cache directory if it doesn't exist
-    QDir cacheDir(getCacheDir());
-    if (!cacheDir.exists()) {
-        cacheDir.mkpath(".");
-    }
+    // Open the article database
+    m_store.open();
+    loadRetentionPolicy();
+    m_alerts.load();
+    m_searches.load();
+    rebuildSearches();
+    refreshUnreadCounts();
     
     // Load saved feeds
     loadSavedFeeds();
@@ -44,36 +179,141 @@ void RssParser::fetchFeed(const QString &url)
 {
     // Reset retry counter
     m_retryCount = 0;
+    
+    if (SavedSearches::isSource(url)) {
+        openSearch(url);
+        return;
+    }
+    
+    // Items of the previous feed stay in the store only
+    if (url != m_currentUrl) {
+        clearItems();
+    }
     m_currentUrl = url;
     
     // Try to load from cache first
-    if (loadFeedCache(url)) {
+    if (!m_feedItems.isEmpty()) {
+        emit statusMessage(tr("Fetching updates..."));
+    } else if (loadFeedCache(url)) {
         emit statusMessage(tr("Loaded from cache, fetching updates..."));
     } else {
         emit statusMessage(tr("Fetching feed..."));
     }
     
-    // Make a network request
+    startRequest(url);
+}
+
+void RssParser::openSearch(const QString &url)
+{
+    // A saved search is already resident; refreshing it refreshes its feeds
+    if (url == m_currentUrl) {
+        refreshAllFeeds();
+        return;
+    }
+    
+    const int view = m_searches.indexOf(SavedSearches::sourceName(url));
+    if (view < 0) {
+        emit error(tr("Unknown saved search: %1").arg(SavedSearches::sourceName(url)));
+        return;
+    }
+    
+    m_retryTimer->stop();
+    clearItems();
+    m_currentUrl = url;
+    m_history.atEnd = false;
+    appendItems(fetchHistoryPage(ResidentPageSize));
+    emit feedUpdated();
+    emit statusMessage(tr("%n matching article(s)", "", m_feedItems.size()));
+}
+
+void RssParser::refreshAllFeeds()
+{
+    refreshDueFeeds(0);
+}
+
+void RssParser::refreshDueFeeds(int maxAgeSecs)
+{
+    // A timer tick lands a little after the previous round's replies were
+    // stored; without the slack every other tick would find nothing due
+    const QDateTime dueBefore = QDateTime::currentDateTime().addSecs(-qMax(0, maxAgeSecs - DueSlackSecs));
+    
+    // The current feed goes through fetchFeed, with retries and status
+    for (auto it = m_feeds.constBegin(); it != m_feeds.constEnd(); ++it) {
+        const QString url = it.value().first;
+        if (url == m_currentUrl || m_backgroundFetches.contains(url)) {
+            continue;
+        }
+        if (maxAgeSecs > 0) {
+            const QDateTime lastUpdate = m_store.feedMeta(url).lastUpdate;
+            if (lastUpdate.isValid() && lastUpdate > dueBefore) {
+                continue;
+            }
+        }
+        m_backgroundFetches.insert(url);
+        startRequest(url);
+    }
+}
+
+void RssParser::startRequest(const QString &url)
+{
+    // Make a network request; the feed URL travels with it to parseReply
     QNetworkRequest request(url);
+    request.setAttribute(FeedUrlAttribute, url);
     request.setHeader(QNetworkRequest::UserAgentHeader, "MotorsportRSS Reader 1.0");
+    request.setRawHeader("Accept", "application/rss+xml, application/atom+xml, application/rdf+xml, "
+                                   "application/feed+json, application/xml;q=0.9, */*;q=0.8");
     
     // Add conditional GET headers if we have cached content
-    QSettings settings;
-    QString lastModifiedKey = "lastModified_" + url;
-    QString etagKey = "etag_" + url;
+    FeedMeta meta = m_store.feedMeta(url);
     
-    if (settings.contains(lastModifiedKey)) {
-        request.setRawHeader("If-Modified-Since", settings.value(lastModifiedKey).toString().toUtf8());
+    if (!meta.lastModified.isEmpty()) {
+        request.setRawHeader("If-Modified-Since", meta.lastModified.toUtf8());
     }
     
-    if (settings.contains(etagKey)) {
-        request.setRawHeader("If-None-Match", settings.value(etagKey).toString().toUtf8());
+    if (!meta.etag.isEmpty()) {
+        request.setRawHeader("If-None-Match", meta.etag.toUtf8());
     }
     
     QNetworkReply *reply = m_networkManager->get(request);
     
-    // Start timeout timer
-    m_networkTimeoutTimer->start(15000); // 15 seconds timeout
+    // Every reply gets a deadline, restarted while data keeps arriving; a
+    // hung request is aborted and finishes through parseReply like any error
+    QTimer *deadline = new QTimer(reply);
+    deadline->setSingleShot(true);
+    connect(deadline, &QTimer::timeout, reply, [reply]() {
+        reply->setProperty("timedOut", true);
+        reply->abort();
+    });
+    connect(reply, &QNetworkReply::finished, deadline, &QTimer::stop);
+    deadline->start(RequestTimeoutMs);
+    
+    // Track per-stage timings for the metrics registry
+    FetchTiming &timing = m_fetchTimings[reply];
+    timing.clock.start();
+    FeedMetrics::instance().increment(feedLabel(url), FeedMetrics::CounterFetches);
+    
+    connect(reply, &QNetworkReply::encrypted, this, [this, reply, url]() {
+        auto it = m_fetchTimings.find(reply);
+        if (it != m_fetchTimings.end()) {
+            FeedMetrics::instance().recordDuration(feedLabel(url), FeedMetrics::StageConnect,
+                                                   it->clock.nsecsElapsed() / 1000000.0);
+        }
+    });
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply, url]() {
+        auto it = m_fetchTimings.find(reply);
+        if (it != m_fetchTimings.end() && it->headersAt < 0) {
+            it->headersAt = it->clock.nsecsElapsed();
+            FeedMetrics::instance().recordDuration(feedLabel(url), FeedMetrics::StageTtfb,
+                                                   it->headersAt / 1000000.0);
+        }
+    });
+    connect(reply, &QNetworkReply::downloadProgress, this, [this, reply, deadline](qint64 received, qint64) {
+        deadline->start(RequestTimeoutMs);
+        auto it = m_fetchTimings.find(reply);
+        if (it != m_fetchTimings.end()) {
+            it->bytes = received;
+        }
+    });
     
     // Monitor for SSL errors
     connect(reply, &QNetworkReply::sslErrors, this, [this, reply](const QList<QSslError> &errors) {
@@ -95,6 +335,191 @@ void RssParser::clearItems()
 {
     m_feedItems.clear();
     m_processedGuids.clear();
+    m_descriptionCache.clear();
+    m_history = ItemCursor();
+    ++m_itemsGeneration;
+}
+
+QList<FeedItem> RssParser::fetchHistoryPage(int limit)
+{
+    QList<FeedItem> page;
+    if (m_history.atEnd) {
+        return page;
+    }
+    
+    StallScope stallScope("fetchHistoryPage");
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+    
+    const int view = SavedSearches::isSource(m_currentUrl)
+                   ? m_searches.indexOf(SavedSearches::sourceName(m_currentUrl)) : -1;
+    if (view >= 0) {
+        // A search holds only keys; its rows are read from the store by key
+        const QList<ArticleKey> keys = m_searches.keys(view, m_processedGuids, limit);
+        m_history.atEnd = keys.size() < limit;
+        page = m_store.loadArticles(keys);
+    } else {
+        // Items parsed since the feed was opened may already be resident
+        const QList<FeedItem> rows = m_store.loadItemsBefore(m_currentUrl, &m_history, limit);
+        for (const FeedItem &item : rows) {
+            if (!m_processedGuids.contains(item.guidKey())) {
+                page.append(item);
+            }
+        }
+    }
+    
+    FeedMetrics::instance().recordDuration(feedLabel(m_currentUrl), FeedMetrics::StageCacheLoad,
+                                           loadTimer.nsecsElapsed() / 1000000.0);
+    return page;
+}
+
+void RssParser::appendItems(const QList<FeedItem> &items)
+{
+    for (const FeedItem &item : items) {
+        m_feedItems.append(item);
+        m_processedGuids.insert(item.guidKey());
+    }
+}
+
+QString RssParser::description(const FeedItem &item)
+{
+    // Freshly parsed items still carry their body until it is stored
+    if (!item.descriptionUtf8().isEmpty()) {
+        return item.description();
+    }
+    
+    if (QString *cached = m_descriptionCache.object(item.guidKey())) {
+        return *cached;
+    }
+    
+    QString description = m_store.loadDescription(item.feedUrl(), item.guid());
+    m_descriptionCache.insert(item.guidKey(), new QString(description));
+    return description;
+}
+
+QSet<QByteArray> RssParser::searchItems(const QString &text)
+{
+    const int view = m_searches.indexOf(SavedSearches::sourceName(m_currentUrl));
+    if (!SavedSearches::isSource(m_currentUrl) || view < 0) {
+        return m_store.searchItems(m_currentUrl, text);
+    }
+    
+    // A search spans feeds, so narrow it within its own feed scope
+    QSet<QByteArray> guids;
+    for (const FeedItem &item : m_store.searchArticles(m_searches.search(view).feedUrl, text)) {
+        guids.insert(item.guidKey());
+    }
+    return guids;
+}
+
+int RssParser::unreadCount(const QString &feedUrl) const
+{
+    if (SavedSearches::isSource(feedUrl)) {
+        const int view = m_searches.indexOf(SavedSearches::sourceName(feedUrl));
+        return view < 0 ? 0 : m_searches.unreadCount(view);
+    }
+    return m_unreadCounts.value(feedUrl);
+}
+
+QList<SavedSearch> RssParser::savedSearches() const
+{
+    return m_searches.searches();
+}
+
+bool RssParser::addSavedSearch(const SavedSearch &search)
+{
+    if (search.name.trimmed().isEmpty() || m_searches.indexOf(search.name) >= 0) {
+        return false;
+    }
+    
+    QList<SavedSearch> searches = m_searches.searches();
+    searches.append(search);
+    m_searches.setSearches(searches);
+    m_searches.save();
+    rebuildSearches();
+    emit unreadCountsChanged();
+    return true;
+}
+
+void RssParser::removeSavedSearch(const QString &name)
+{
+    QList<SavedSearch> searches = m_searches.searches();
+    const int view = m_searches.indexOf(name);
+    if (view < 0) {
+        return;
+    }
+    
+    searches.removeAt(view);
+    m_searches.setSearches(searches);
+    m_searches.save();
+    rebuildSearches();
+    emit unreadCountsChanged();
+}
+
+void RssParser::rebuildSearches()
+{
+    StallScope stallScope("rebuildSearches");
+    
+    // One store query per search; afterwards the views follow the writes
+    for (int view = 0; view < m_searches.size(); ++view) {
+        const SavedSearch &search = m_searches.search(view);
+        m_searches.setResults(view, m_store.searchArticles(search.feedUrl, search.text.trimmed()));
+    }
+}
+
+void RssParser::updateSearches(const QList<FeedItem> &newItems)
+{
+    if (m_searches.size() == 0 || newItems.isEmpty()) {
+        return;
+    }
+    
+    const int open = SavedSearches::isSource(m_currentUrl)
+                   ? m_searches.indexOf(SavedSearches::sourceName(m_currentUrl)) : -1;
+    bool changed = false;
+    QList<FeedItem> resident;
+    for (const FeedItem &item : newItems) {
+        const QVector<int> views = m_searches.addItem(item);
+        changed = changed || !views.isEmpty();
+        if (views.contains(open)) {
+            FeedItem row = item;
+            row.releaseBody();
+            resident.append(row);
+        }
+    }
+    
+    // The open search takes its new rows like a fetched feed
+    if (!resident.isEmpty()) {
+        emit itemsAboutToBeAppended(resident.size());
+        appendItems(resident);
+        emit itemsAppended();
+        emit newItemsAvailable(resident.size());
+        emit feedUpdated();
+    }
+    if (changed) {
+        emit unreadCountsChanged();
+    }
+}
+
+QStringList RssParser::otherSources(const FeedItem &item)
+{
+    QStringList names;
+    const QString feedUrl = item.feedUrl();
+    for (const QString &url : m_store.storySources(feedUrl, item.guid())) {
+        if (url != feedUrl) {
+            names.append(feedLabel(url));
+        }
+    }
+    return names;
+}
+
+void RssParser::releaseDescriptions()
+{
+    // Keep only the row metadata resident once the bodies are on disk
+    for (FeedItem &item : m_feedItems) {
+        if (!item.descriptionUtf8().isEmpty()) {
+            item.releaseBody();
+        }
+    }
 }
 
 QString RssParser::getCacheDir() const
@@ -102,98 +527,87 @@ QString RssParser::getCacheDir() const
     return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/feeds";
 }
 
+QString RssParser::feedLabel(const QString &url) const
+{
+    for (auto it = m_feeds.constBegin(); it != m_feeds.constEnd(); ++it) {
+        if (it.value().first == url) {
+            return it.key();
+        }
+    }
+    return url;
+}
+
 QString RssParser::getCacheFilePath(const QString &feedUrl)
 {
-    // Create a hash of the feed URL to use as filename
+    // Legacy JSON cache location, only read when migrating into the article store
     QString urlHash = QCryptographicHash::hash(feedUrl.toUtf8(), QCryptographicHash::Md5).toHex();
     return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/feeds/" + urlHash + ".json";
 }
 
 void RssParser::saveFeedCache(const QString &feedUrl)
 {
-    QFile file(getCacheFilePath(feedUrl));
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Could not open cache file for writing:" << file.fileName();
-        return;
-    }
+    storeItems(feedUrl, m_feedItems);
+}
+
+void RssParser::storeItems(const QString &feedUrl, const QList<FeedItem> &items)
+{
+    StallScope stallScope("saveFeedCache");
     
-    QJsonArray feedArray;
+    QElapsedTimer writeTimer;
+    writeTimer.start();
     
-    for (const FeedItem &item : m_feedItems) {
-        QJsonObject itemObject;
-        itemObject["title"] = item.title;
-        itemObject["link"] = item.link;
-        itemObject["description"] = item.description;
-        itemObject["pubDate"] = item.pubDate;
-        itemObject["imageUrl"] = item.imageUrl;
-        itemObject["category"] = item.category;
-        itemObject["guid"] = item.guid;
-        itemObject["isRead"] = item.isRead;
-        itemObject["fetchTime"] = item.fetchTime.toString(Qt::ISODate);
-        
-        feedArray.append(itemObject);
+    // One transaction per batch; existing rows are left untouched
+    if (!items.isEmpty() && !m_store.insertItems(feedUrl, items)) {
+        qWarning() << "Could not store items for" << feedUrl;
+    } else {
+        if (feedUrl == m_currentUrl) {
+            releaseDescriptions();
+        }
+        if (!items.isEmpty()) {
+            emit itemsStored(feedUrl, items);
+            emit storeChanged();
+        }
     }
+    m_store.setLastUpdate(feedUrl, QDateTime::currentDateTime());
     
-    QJsonDocument doc(feedArray);
-    file.write(doc.toJson());
-    
-    // Store cache metadata
-    QSettings settings;
-    settings.setValue("lastCacheUpdate_" + feedUrl, QDateTime::currentDateTime().toString(Qt::ISODate));
-    
-    qDebug() << "Feed cache saved to" << file.fileName();
+    FeedMetrics::instance().recordDuration(feedLabel(feedUrl), FeedMetrics::StageCacheWrite,
+                                           writeTimer.nsecsElapsed() / 1000000.0);
 }
 
 bool RssParser::loadFeedCache(const QString &feedUrl)
 {
-    QFile file(getCacheFilePath(feedUrl));
-    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
-        return false;
-    }
+    StallScope stallScope("loadFeedCache");
     
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    if (doc.isNull() || !doc.isArray()) {
-        qWarning() << "Invalid cache file format:" << file.fileName();
-        return false;
+    // Migrate the old per-feed JSON file on first use
+    QString legacyPath = getCacheFilePath(feedUrl);
+    if (QFile::exists(legacyPath)) {
+        m_store.importLegacyCache(feedUrl, legacyPath);
     }
     
-    QJsonArray feedArray = doc.array();
-    QList<FeedItem> cachedItems;
+    QElapsedTimer loadTimer;
+    loadTimer.start();
     
-    for (const QJsonValue &value : feedArray) {
-        QJsonObject obj = value.toObject();
-        FeedItem item;
-        
-        item.title = obj["title"].toString();
-        item.link = obj["link"].toString();
-        item.description = obj["description"].toString();
-        item.pubDate = obj["pubDate"].toString();
-        item.imageUrl = obj["imageUrl"].toString();
-        item.category = obj["category"].toString();
-        item.guid = obj["guid"].toString();
-        item.isRead = obj["isRead"].toBool();
-        item.fetchTime = QDateTime::fromString(obj["fetchTime"].toString(), Qt::ISODate);
-        
-        if (!item.guid.isEmpty()) {
-            m_processedGuids.append(item.guid);
-        }
-        
-        cachedItems.append(item);
+    // Only the newest page is made resident; the rest is paged in on scroll
+    int pageSize = m_retention.maxItemsPerFeed > 0 ? qMin(m_retention.maxItemsPerFeed, int(ResidentPageSize))
+                                                   : int(ResidentPageSize);
+    QList<FeedItem> cachedItems = m_store.loadItems(feedUrl, pageSize, &m_history);
+    for (const FeedItem &item : cachedItems) {
+        m_processedGuids.insert(item.guidKey());
     }
     
+    FeedMetrics::instance().recordDuration(feedLabel(feedUrl), FeedMetrics::StageCacheLoad,
+                                           loadTimer.nsecsElapsed() / 1000000.0);
+    
     // If we have cached items, update our current items
     if (!cachedItems.isEmpty()) {
         m_feedItems = cachedItems;
+        ++m_itemsGeneration;
         emit feedUpdated();
         
         // Check if cache is too old (more than 30 minutes)
-        QSettings settings;
-        QString lastUpdateKey = "lastCacheUpdate_" + feedUrl;
-        if (settings.contains(lastUpdateKey)) {
-            QDateTime lastUpdate = QDateTime::fromString(settings.value(lastUpdateKey).toString(), Qt::ISODate);
-            if (lastUpdate.secsTo(QDateTime::currentDateTime()) > 1800) {
-                qDebug() << "Cache is older than 30 minutes";
-            }
+        QDateTime lastUpdate = m_store.feedMeta(feedUrl).lastUpdate;
+        if (lastUpdate.isValid() && lastUpdate.secsTo(QDateTime::currentDateTime()) > 1800) {
+            qDebug() << "Cache is older than 30 minutes";
         }
         
         return true;
@@ -202,128 +616,359 @@ bool RssParser::loadFeedCache(const QString &feedUrl)
     return false;
 }
 
-void RssParser::setItemAsRead(const QString &guid)
+bool RssParser::isKnownItem(const QByteArray &guid)
+{
+    // Evicted items are no longer resident; their tombstones in the store
+    // keep them from coming back as new
+    return m_ingest.guids->contains(guid)
+        || (m_ingest.checkStore && m_store.containsItem(m_ingest.feedUrl, QString::fromUtf8(guid)));
+}
+
+void RssParser::loadRetentionPolicy()
 {
+    QSettings settings;
+    m_retention.maxAgeDays = settings.value("retention/maxAgeDays", m_retention.maxAgeDays).toInt();
+    m_retention.maxItemsPerFeed = settings.value("retention/maxItemsPerFeed", m_retention.maxItemsPerFeed).toInt();
+    m_retention.maxTotalBytes = settings.value("retention/maxTotalBytes", m_retention.maxTotalBytes).toLongLong();
+}
+
+void RssParser::setRetentionPolicy(const RetentionPolicy &policy)
+{
+    // The settings dialog applies the policy whether or not it was edited
+    if (policy == m_retention) {
+        return;
+    }
+    m_retention = policy;
+    
+    QSettings settings;
+    settings.setValue("retention/maxAgeDays", policy.maxAgeDays);
+    settings.setValue("retention/maxItemsPerFeed", policy.maxItemsPerFeed);
+    settings.setValue("retention/maxTotalBytes", policy.maxTotalBytes);
+    
+    if (!m_currentUrl.isEmpty() && !SavedSearches::isSource(m_currentUrl)) {
+        enforceRetention(m_currentUrl);
+        emit feedUpdated();
+    }
+}
+
+void RssParser::enforceRetention(const QString &feedUrl)
+{
+    // Resident items of the current feed
+    if (feedUrl == m_currentUrl) {
+        qint64 cutoff = m_retention.maxAgeDays > 0
+                      ? QDateTime::currentDateTime().addDays(-m_retention.maxAgeDays).toSecsSinceEpoch()
+                      : 0;
+        
+        // Find the age threshold that also satisfies the count limit
+        if (m_retention.maxItemsPerFeed > 0 && m_feedItems.size() > m_retention.maxItemsPerFeed) {
+            QVector<qint64> times;
+            times.reserve(m_feedItems.size());
+            for (const FeedItem &item : m_feedItems) {
+                times.append(item.ageTime());
+            }
+            int excess = m_feedItems.size() - m_retention.maxItemsPerFeed;
+            std::nth_element(times.begin(), times.begin() + excess, times.end());
+            cutoff = qMax(cutoff, times.at(excess));
+        }
+        
+        if (cutoff > 0) {
+            int limit = m_retention.maxItemsPerFeed > 0 ? m_retention.maxItemsPerFeed : m_feedItems.size();
+            int kept = 0;
+            QList<FeedItem> retained;
+            retained.reserve(qMin(limit, m_feedItems.size()));
+            
+            // Walk newest first so ties at the cutoff keep the most recently added items
+            for (int i = m_feedItems.size() - 1; i >= 0; --i) {
+                const FeedItem &item = m_feedItems.at(i);
+                if (item.ageTime() >= cutoff && kept < limit) {
+                    retained.prepend(item);
+                    ++kept;
+                } else {
+                    m_processedGuids.remove(item.guidKey());
+                }
+            }
+            // Nothing evicted leaves the rows, and the views' rows, as they are
+            if (retained.size() != m_feedItems.size()) {
+                m_feedItems = retained;
+                ++m_itemsGeneration;
+            }
+        }
+    }
+    
+    // Stored items, this feed plus the global size cap
+    QList<ArticleKey> evicted;
+    int removed = m_store.prune(feedUrl, m_retention, &evicted);
+    if (removed > 0) {
+        emit storeChanged();
+    }
+    
+    // Rows of an open search stay until it is reopened, so they never vanish under the reader
+    if (m_searches.evict(evicted)) {
+        emit unreadCountsChanged();
+    }
+    
+    // New rows and evicted rows both move the counters
+    refreshUnreadCounts();
+}
+
+RssParser::MemoryReport RssParser::memoryReport()
+{
+    MemoryReport report;
+    report.itemCount = m_feedItems.size();
+    for (const FeedItem &item : m_feedItems) {
+        report.itemBytes += item.memoryFootprint();
+        report.legacyItemBytes += item.legacyFootprint();
+    }
+    
+    const InternTable *tables[] = { &InternTable::categories(), &InternTable::feeds(), &InternTable::urlPrefixes() };
+    for (const InternTable *table : tables) {
+        report.internCount += table->size() - 1;
+        report.internBytes += table->memoryFootprint();
+    }
+    
+    // Hash nodes only, the GUID bytes are shared with the items
+    report.guidCount = m_processedGuids.size();
+    report.guidBytes = qint64(m_processedGuids.size()) * (3 * qint64(sizeof(void *)) + qint64(sizeof(QByteArray)));
+    
+    report.descriptionCacheCount = m_descriptionCache.size();
+    for (const QByteArray &guid : m_descriptionCache.keys()) {
+        const QString *description = m_descriptionCache.object(guid);
+        report.descriptionCacheBytes += qint64(sizeof(QArrayData)) + (description->capacity() + 1) * 2;
+    }
+    
+    report.storeUsedBytes = m_store.usedBytes();
+    report.storeFileBytes = m_store.fileBytes();
+    return report;
+}
+
+void RssParser::setItemAsRead(const QString &feedUrl, const QString &guid)
+{
+    // Rows of a saved search come from several feeds, which may share a GUID
+    const quint16 feedId = InternTable::feeds().intern(feedUrl);
+    const QByteArray key = guid.toUtf8();
     for (int i = 0; i < m_feedItems.size(); ++i) {
-        if (m_feedItems[i].guid == guid) {
+        if (m_feedItems[i].feedId == feedId && m_feedItems[i].guidKey() == key) {
             m_feedItems[i].isRead = true;
             break;
         }
     }
     
-    // Save the updated state
-    saveFeedCache(m_currentUrl);
+    // Persist only the changed flag
+    m_store.setRead(feedUrl, guid);
+    emit storeChanged();
+    
+    // The whole story is read, in every search that holds one of its articles
+    if (m_searches.size() > 0) {
+        QList<ArticleKey> articles = m_store.storyArticles(feedUrl, guid);
+        ArticleKey article;
+        article.feedUrl = feedUrl;
+        article.guid = key;
+        articles.append(article);
+        if (m_searches.markRead(articles)) {
+            emit unreadCountsChanged();
+        }
+    }
+    refreshUnreadCounts();
+}
+
+void RssParser::setAllItemsAsRead()
+{
+    QList<ArticleKey> articles;
+    for (FeedItem &item : m_feedItems) {
+        if (item.isRead || item.guidKey().isEmpty()) {
+            continue;
+        }
+        item.isRead = true;
+        ArticleKey article;
+        article.feedUrl = item.feedUrl();
+        article.guid = item.guidKey();
+        articles.append(article);
+    }
+    if (articles.isEmpty()) {
+        return;
+    }
+    
+    m_store.setRead(articles);
+    emit storeChanged();
+    
+    if (m_searches.size() > 0) {
+        QList<ArticleKey> marked = articles;
+        for (const ArticleKey &article : articles) {
+            marked.append(m_store.storyArticles(article.feedUrl, QString::fromUtf8(article.guid)));
+        }
+        if (m_searches.markRead(marked)) {
+            emit unreadCountsChanged();
+        }
+    }
+    refreshUnreadCounts();
+}
+
+void RssParser::refreshUnreadCounts()
+{
+    QHash<QString, int> counts = m_store.unreadCounts();
+    if (counts == m_unreadCounts) {
+        return;
+    }
+    
+    m_unreadCounts = counts;
+    m_totalUnread = 0;
+    for (int count : counts) {
+        m_totalUnread += count;
+    }
+    emit unreadCountsChanged();
 }
 
 void RssParser::parseReply(QNetworkReply *reply)
 {
-    m_networkTimeoutTimer->stop();
+    StallScope stallScope("parseReply");
+    
+    // Replies for other feeds, including one the user has switched away
+    // from, are stored without touching the resident items
+    const QString feedUrl = reply->request().attribute(FeedUrlAttribute).toString();
+    const bool background = feedUrl != m_currentUrl;
+    if (background) {
+        m_backgroundFetches.remove(feedUrl);
+    }
+    
+    // Close out the network stages for this request
+    FeedMetrics &metrics = FeedMetrics::instance();
+    const QString feed = feedLabel(feedUrl);
+    FetchTiming timing = m_fetchTimings.take(reply);
+    if (timing.clock.isValid()) {
+        qint64 finishedAt = timing.clock.nsecsElapsed();
+        if (timing.headersAt >= 0) {
+            metrics.recordDuration(feed, FeedMetrics::StageDownload, (finishedAt - timing.headersAt) / 1000000.0);
+        }
+        metrics.increment(feed, FeedMetrics::CounterBytes, quint64(qMax<qint64>(0, timing.bytes)));
+    }
     
     if (reply->error() == QNetworkReply::NoError || reply->error() == QNetworkReply::ContentNotFoundError) {
         // If we get a 304 Not Modified, the feed hasn't changed
         if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
-            emit statusMessage(tr("Feed has not changed since last update"));
+            metrics.increment(feed, FeedMetrics::CounterConditionalHits);
+            m_store.setLastUpdate(feedUrl, QDateTime::currentDateTime());
+            if (!background) {
+                emit statusMessage(tr("Feed has not changed since last update"));
+            }
             reply->deleteLater();
             return;
         }
         
         // Extract and save cache headers
-        QSettings settings;
-        QVariant lastModified = reply->header(QNetworkRequest::LastModifiedHeader);
-        QVariant etag = reply->rawHeader("ETag");
+        QString lastModified = QString::fromLatin1(reply->rawHeader("Last-Modified"));
+        QString etag = QString::fromLatin1(reply->rawHeader("ETag"));
         
-        if (lastModified.isValid()) {
-            settings.setValue("lastModified_" + m_currentUrl, lastModified.toString());
+        if (!lastModified.isEmpty() || !etag.isEmpty()) {
+            m_store.setValidators(feedUrl, etag, lastModified);
         }
         
-        if (!etag.toString().isEmpty()) {
-            settings.setValue("etag_" + m_currentUrl, etag.toString());
-        }
+        // Items are parsed into a scratch list; those of the current feed are
+        // deduplicated against the resident GUIDs and appended in one step
+        QList<FeedItem> newItems;
+        QSet<QByteArray> scratchGuids;
+        const qint64 minAgeTime = m_retention.maxAgeDays > 0
+                                ? QDateTime::currentDateTime().addDays(-m_retention.maxAgeDays).toSecsSinceEpoch()
+                                : 0;
+        m_ingest = IngestTarget(feedUrl, &newItems, background ? &scratchGuids : &m_processedGuids,
+                                true, minAgeTime);
         
-        // Save the original items for comparing later
-        QList<FeedItem> oldItems = m_feedItems;
-        QStringList oldGuids = m_processedGuids;
+        // Read the payload once, a recovery pass works on the same bytes
+        const QByteArray payload = reply->readAll();
         
-        // Try to parse the XML response
-        QXmlStreamReader xml(reply);
+        QElapsedTimer parseTimer;
+        parseTimer.start();
+        QString parseError;
+        bool recovered = false;
+        bool parsed = parsePayload(payload, reply->rawHeader("Content-Type"), &parseError, &recovered);
+        metrics.recordDuration(feed, FeedMetrics::StageParse, parseTimer.nsecsElapsed() / 1000000.0);
         
-        if (parseXml(xml)) {
-            emit statusMessage(tr("Feed successfully updated"));
-            
-            // Check for new items and emit a signal if found
-            QList<FeedItem> newItems;
-            for (const FeedItem &item : m_feedItems) {
-                if (!oldGuids.contains(item.guid)) {
-                    newItems.append(item);
-                }
+        m_ingest = IngestTarget();
+        
+        if (parsed) {
+            if (recovered) {
+                metrics.increment(feed, FeedMetrics::CounterRecoveries);
             }
+            metrics.increment(feed, FeedMetrics::CounterItems, newItems.size());
             
-            if (!newItems.isEmpty()) {
-                emit newItemsAvailable(newItems.size());
+            // Views insert the new rows in place instead of resetting
+            if (!background && !newItems.isEmpty()) {
+                emit itemsAboutToBeAppended(newItems.size());
+                m_feedItems.append(newItems);
+                emit itemsAppended();
             }
             
-            // Save feed cache
-            saveFeedCache(m_currentUrl);
+            // Write the new items in one batch
+            storeItems(feedUrl, newItems);
+            updateSearches(newItems);
+            enforceRetention(feedUrl);
             
-            emit feedUpdated();
+            if (!background) {
+                emit statusMessage(recovered ? tr("Feed repaired and updated") : tr("Feed successfully updated"));
+                if (!newItems.isEmpty()) {
+                    emit newItemsAvailable(newItems.size());
+                }
+                emit feedUpdated();
+            } else if (!newItems.isEmpty()) {
+                emit backgroundItemsAvailable(newItems.size(), feed);
+            }
+            
+            emitAlerts(feedUrl, newItems);
         } else {
-            // Try to interpret as Atom if RSS parsing failed
-            xml.clear();
-            xml.addData(reply->readAll());
+            metrics.increment(feed, FeedMetrics::CounterParseErrors);
             
-            if (xml.atEnd() || xml.hasError()) {
-                // If we can't read as Atom either, try a fallback approach with a DOM parser
-                QString content = reply->readAll();
-                QDomDocument doc;
-                if (doc.setContent(content)) {
-                    qDebug() << "Attempting to parse with DOM parser as a fallback";
-                    // DOM parsing logic would be here if needed
-                    // For this example we'll just use a simpler approach
-                    
-                    bool parsingWorked = false;
-                    // Simple pattern-based extraction could be added here
-                    
-                    if (parsingWorked) {
-                        emit statusMessage(tr("Feed parsed with fallback mechanism"));
-                        emit feedUpdated();
-                    } else {
-                        emit error(tr("XML parsing error: %1").arg(xml.errorString()));
-                        retryFetchFeed();
-                    }
-                } else {
-                    emit error(tr("XML parsing error: %1").arg(xml.errorString()));
-                    retryFetchFeed();
+            // Items of a failed parse were never made resident
+            if (!background) {
+                for (const FeedItem &item : newItems) {
+                    m_processedGuids.remove(item.guidKey());
                 }
+            }
+            
+            if (background) {
+                qWarning() << "Background refresh of" << feed << "failed:" << parseError;
             } else {
-                parseAtom(xml);
-                
-                // Check for new items
-                QList<FeedItem> newItems;
-                for (const FeedItem &item : m_feedItems) {
-                    if (!oldGuids.contains(item.guid)) {
-                        newItems.append(item);
-                    }
-                }
-                
-                if (!newItems.isEmpty()) {
-                    emit newItemsAvailable(newItems.size());
+                if (format == JsonFeedFormat) {
+                    emit error(tr("JSON Feed parsing error: %1").arg(parseError));
+                } else {
+                    emit error(tr("XML parsing error: %1").arg(parseError));
                 }
-                
-                // Save feed cache
-                saveFeedCache(m_currentUrl);
-                
-                emit statusMessage(tr("Feed parsed as Atom format"));
-                emit feedUpdated();
+                retryFetchFeed();
             }
         }
     } else {
-        emit error(tr("Network error: %1").arg(reply->errorString()));
-        retryFetchFeed();
+        metrics.increment(feed, FeedMetrics::CounterNetworkErrors);
+        const bool timedOut = reply->property("timedOut").toBool();
+        if (background) {
+            qWarning() << "Background refresh of" << feed << "failed:"
+                       << (timedOut ? QStringLiteral("timed out") : reply->errorString());
+        } else if (timedOut) {
+            emit error(tr("Network request timed out"));
+            retryFetchFeed();
+        } else {
+            emit error(tr("Network error: %1").arg(reply->errorString()));
+            retryFetchFeed();
+        }
     }
     
     reply->deleteLater();
 }
 
+void RssParser::emitAlerts(const QString &feedUrl, const QList<FeedItem> &newItems)
+{
+    if (m_alerts.isEmpty()) {
+        return;
+    }
+    
+    // One automaton pass per article over its title and lead
+    const QString feedName = feedLabel(feedUrl);
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (const FeedItem &item : newItems) {
+        const QStringList rules = m_alerts.evaluate(item.title + QLatin1Char('\n') + item.snippet(), now);
+        for (const QString &rule : rules) {
+            emit alertTriggered(rule, item.title, feedName);
+        }
+    }
+}
+
 void RssParser::retryFetchFeed()
 {
     if (m_retryCount < m_maxRetryAttempts) {
@@ -346,203 +991,366 @@ void RssParser::retryFetchFeed()
     }
 }
 
-void RssParser::handleNetworkTimeout()
+RssParser::FeedFormat RssParser::detectFormat(const QByteArray &payload, const QByteArray &contentType)
+{
+    // The bytes win over the Content-Type, which is often a generic text/xml or text/plain
+    int pos = payload.startsWith("\xEF\xBB\xBF") ? 3 : 0;
+    while (pos < payload.size() && (payload.at(pos) == ' ' || payload.at(pos) == '\t'
+                                    || payload.at(pos) == '\n' || payload.at(pos) == '\r')) {
+        ++pos;
+    }
+
+    if (pos < payload.size() && payload.at(pos) == '{') {
+        return JsonFeedFormat;
+    }
+
+    if (pos < payload.size() && payload.at(pos) == '<') {
+        // Root element: the first of the known names after the prolog
+        const QByteArray head = payload.mid(pos, 2048);
+        FeedFormat format = UnknownFormat;
+        int first = head.size();
+        const struct { const char *tag; FeedFormat format; } roots[] = {
+            { "<rss", RssFormat }, { "<feed", AtomFormat }, { "<rdf:RDF", RdfFormat }
+        };
+        for (const auto &root : roots) {
+            int index = head.indexOf(root.tag);
+            if (index >= 0 && index < first) {
+                first = index;
+                format = root.format;
+            }
+        }
+        return format;
+    }
+
+    if (contentType.toLower().contains("json")) {
+        return JsonFeedFormat;
+    }
+    return UnknownFormat;
+}
+
+bool RssParser::parseItems(const QString &feedUrl, const QByteArray &payload, const QByteArray &contentType,
+                           QList<FeedItem> *items, QString *errorString, bool *recovered)
 {
-    emit error(tr("Network request timed out"));
-    retryFetchFeed();
+    // Nothing of this document is in the store, so skip the lookups
+    QSet<QByteArray> guids;
+    m_ingest = IngestTarget(feedUrl, items, &guids, false);
+    QString error;
+    bool wasRecovered = false;
+    const bool parsed = parsePayload(payload, contentType, &error, &wasRecovered);
+    m_ingest = IngestTarget();
+    
+    if (errorString) {
+        *errorString = error;
+    }
+    if (recovered) {
+        *recovered = wasRecovered;
+    }
+    return parsed;
+}
+
+bool RssParser::parsePayload(const QByteArray &payload, const QByteArray &contentType,
+                             QString *errorString, bool *recovered)
+{
+    const FeedFormat format = detectFormat(payload, contentType);
+    bool parsed = parseDocument(payload, format, errorString);
+    *recovered = false;
+    
+    // The repair pipeline only knows about XML
+    if (!parsed && format != JsonFeedFormat) {
+        // Repair the document instead of downloading it again; items read
+        // before the error are kept and deduplicated by GUID
+        QByteArray repaired = FeedRecovery::repair(payload, contentType);
+        
+        parsed = parseDocument(repaired, format, errorString) || !m_ingest.items->isEmpty();
+        
+        // A repair that yields no items at all has not recovered the feed
+        if (parsed && m_ingest.itemsSeen == 0) {
+            parsed = false;
+            *errorString = tr("no items left after repair");
+        }
+        *recovered = parsed;
+    }
+    return parsed;
+}
+
+bool RssParser::parseDocument(const QByteArray &data, FeedFormat format, QString *errorString)
+{
+    if (format == JsonFeedFormat) {
+        return parseJsonFeed(data, errorString);
+    }
+
+    QXmlStreamReader xml(data);
+    bool ok = parseXml(xml);
+    if (!ok && errorString) {
+        *errorString = xml.errorString();
+    }
+    return ok;
 }
 
 bool RssParser::parseXml(QXmlStreamReader &xml)
 {
-    bool foundItems = false;
+    const qint64 fetchTime = QDateTime::currentSecsSinceEpoch();
+    const quint16 feedId = InternTable::feeds().intern(m_ingest.feedUrl);
+    
+    // Reserved capacity survives resize(0), so the arena grows only once
+    m_arena.text.reserve(4096);
+    m_arena.bytes.reserve(1024);
     
+    // RSS 2.0 and RSS 1.0 items, and Atom entries, wherever they are nested
     while (!xml.atEnd() && !xml.hasError()) {
         QXmlStreamReader::TokenType token = xml.readNext();
         
-        if (token == QXmlStreamReader::StartElement) {
-            // Check format type - RSS or Atom
-            if (xml.name() == "rss" || xml.name() == "channel") {
-                // Continue with RSS parsing
-            } else if (xml.name() == "feed") {
-                // This is an Atom feed - handle differently
-                parseAtom(xml);
-                return true;
-            } else if (xml.name() == "item") {
-                FeedItem item;
-                parseItem(xml, item);
-                
-                // Only add if we have a valid item with a unique GUID
-                if (!item.title.isEmpty() && !item.link.isEmpty()) {
-                    // Generate a GUID if one wasn't provided
-                    if (item.guid.isEmpty()) {
-                        item.guid = QCryptographicHash::hash(
-                            (item.link + item.title).toUtf8(), 
-                            QCryptographicHash::Md5).toHex();
-                    }
-                    
-                    // Check if we've already processed this item
-                    if (!m_processedGuids.contains(item.guid)) {
-                        m_feedItems.append(item);
-                        m_processedGuids.append(item.guid);
-                        foundItems = true;
-                    }
-                }
+        if (token == QXmlStreamReader::StartElement
+            && lookupElement(xml.namespaceUri(), xml.name()) == ItemElement) {
+            FeedItem item;
+            // RSS 1.0 identifies items by their rdf:about URI
+            const QXmlStreamAttributes attrs = xml.attributes();
+            const QString about = attrs.value(RdfNamespace, QStringLiteral("about")).toString();
+            parseItem(xml, item);
+            // An item cut short by an error is read whole after repair
+            if (xml.hasError()) {
+                break;
+            }
+            if (item.guidKey().isEmpty() && !about.isEmpty()) {
+                item.setGuid(about);
             }
+            
+            ingestItem(item, fetchTime, feedId);
         }
     }
     
-    return !xml.hasError() && foundItems;
+    return !xml.hasError();
 }
 
-void RssParser::parseItem(QXmlStreamReader &xml, FeedItem &item)
+// Gathers the text of the current element, children included, into the
+// arena and leaves the reader on its end tag. The result is only valid
+// until the next call.
+QStringRef RssParser::readText(QXmlStreamReader &xml)
 {
+    QString &buffer = m_arena.text;
+    buffer.resize(0);
+    int depth = 0;
+    
     while (!xml.atEnd()) {
-        QXmlStreamReader::TokenType token = xml.readNext();
-        
-        if (token == QXmlStreamReader::EndElement && xml.name() == "item") {
+        switch (xml.readNext()) {
+        case QXmlStreamReader::Characters:
+        case QXmlStreamReader::EntityReference:
+            buffer.append(xml.text());
             break;
-        }
-        
-        if (token == QXmlStreamReader::StartElement) {
-            if (xml.name() == "title") {
-                item.title = xml.readElementText();
-            } else if (xml.name() == "link") {
-                item.link = xml.readElementText();
-            } else if (xml.name() == "description") {
-                item.description = xml.readElementText();
-                
-                // Try to extract image URL from description if it contains HTML
-                if (item.description.contains("<img")) {
-                    int imgStart = item.description.indexOf("<img");
-                    int srcStart = item.description.indexOf("src=\"", imgStart) + 5;
-                    if (srcStart > 5) {
-                        int srcEnd = item.description.indexOf("\"", srcStart);
-                        if (srcEnd > srcStart) {
-                            item.imageUrl = item.description.mid(srcStart, srcEnd - srcStart);
-                        }
-                    }
-                }
-            } else if (xml.name() == "pubDate") {
-                item.pubDate = xml.readElementText();
-            } else if (xml.name() == "category") {
-                item.category = xml.readElementText();
-            } else if (xml.name() == "guid") {
-                item.guid = xml.readElementText();
-            } else if (xml.name() == "enclosure" && item.imageUrl.isEmpty()) {
-                QXmlStreamAttributes attrs = xml.attributes();
-                if (attrs.hasAttribute("url") && attrs.hasAttribute("type") && 
-                    attrs.value("type").toString().startsWith("image/")) {
-                    item.imageUrl = attrs.value("url").toString();
-                }
-            } else if ((xml.name() == "media:content" || xml.name() == "media:thumbnail") && 
-                       item.imageUrl.isEmpty()) {
-                QXmlStreamAttributes attrs = xml.attributes();
-                if (attrs.hasAttribute("url")) {
-                    item.imageUrl = attrs.value("url").toString();
-                }
+        case QXmlStreamReader::StartElement:
+            ++depth;
+            break;
+        case QXmlStreamReader::EndElement:
+            if (depth == 0) {
+                return QStringRef(&buffer);
             }
+            --depth;
+            break;
+        default:
+            break;
         }
     }
+    return QStringRef(&buffer);
 }
 
-// Parse Atom feed
-void RssParser::parseAtom(QXmlStreamReader &xml)
+// Reads the children of an item or entry up to its end tag
+void RssParser::parseItem(QXmlStreamReader &xml, FeedItem &item)
 {
+    bool hasFullContent = false;
+    int depth = 0;
+    
     while (!xml.atEnd() && !xml.hasError()) {
         QXmlStreamReader::TokenType token = xml.readNext();
         
-        if (token == QXmlStreamReader::StartElement) {
-            if (xml.name() == "entry") {
-                FeedItem item;
-                parseAtomEntry(xml, item);
-                
-                // Only add if we have a valid item with a unique ID
-                if (!item.title.isEmpty() && !item.link.isEmpty()) {
-                    // Generate a GUID if one wasn't provided
-                    if (item.guid.isEmpty()) {
-                        item.guid = QCryptographicHash::hash(
-                            (item.link + item.title).toUtf8(), 
-                            QCryptographicHash::Md5).toHex();
-                    }
-                    
-                    // Check if we've already processed this item
-                    if (!m_processedGuids.contains(item.guid)) {
-                        m_feedItems.append(item);
-                        m_processedGuids.append(item.guid);
-                    }
-                }
+        if (token == QXmlStreamReader::EndElement) {
+            if (depth == 0) {
+                break;
             }
+            --depth;
+            continue;
+        }
+        if (token != QXmlStreamReader::StartElement) {
+            continue;
         }
-    }
-}
-
-// Parse an Atom entry
-void RssParser::parseAtomEntry(QXmlStreamReader &xml, FeedItem &item)
-{
-    while (!xml.atEnd()) {
-        QXmlStreamReader::TokenType token = xml.readNext();
         
-        if (token == QXmlStreamReader::EndElement && xml.name() == "entry") {
+        // Text elements are read to their end tag, unknown subtrees are
+        // skipped, and the rest are descended into
+        switch (lookupElement(xml.namespaceUri(), xml.name())) {
+        case TitleElement:
+            item.title = readText(xml).toString();
+            break;
+        case LinkElement:
+            item.setLink(readText(xml).trimmed());
+            break;
+        case GuidElement:
+            item.setGuid(readText(xml).trimmed());
+            break;
+        case DescriptionElement:
+            // description and Atom summary give way to the full body
+            if (hasFullContent) {
+                xml.skipCurrentElement();
+            } else {
+                item.setDescription(readText(xml));
+            }
+            break;
+        case FullContentElement:
+            item.setDescription(readText(xml));
+            hasFullContent = true;
+            break;
+        case PubDateElement:
+            item.pubDate = readText(xml).trimmed().toString();
+            break;
+        case FallbackDateElement:
+            if (item.pubDate.isEmpty()) {
+                item.pubDate = readText(xml).trimmed().toString();
+            } else {
+                xml.skipCurrentElement();
+            }
+            break;
+        case CategoryElement:
+            item.addCategory(readText(xml));
+            break;
+        case AtomCategoryElement: {
+            const QXmlStreamAttributes attrs = xml.attributes();
+            const QStringRef term = attrs.value("term");
+            if (!term.isEmpty()) {
+                item.addCategory(term);
+                xml.skipCurrentElement();
+            } else {
+                item.addCategory(readText(xml));
+            }
             break;
         }
-        
-        if (token == QXmlStreamReader::StartElement) {
-            if (xml.name() == "title") {
-                item.title = xml.readElementText();
-            } else if (xml.name() == "link") {
-                QXmlStreamAttributes attrs = xml.attributes();
-                if (attrs.hasAttribute("href")) {
-                    item.link = attrs.value("href").toString();
-                } else {
-                    item.link = xml.readElementText();
-                }
-            } else if (xml.name() == "id") {
-                item.guid = xml.readElementText();
-            } else if (xml.name() == "summary" || xml.name() == "content") {
-                item.description = xml.readElementText();
-                
-                // Try to extract image URL from description if it contains HTML
-                if (item.description.contains("<img")) {
-                    int imgStart = item.description.indexOf("<img");
-                    int srcStart = item.description.indexOf("src=\"", imgStart) + 5;
-                    if (srcStart > 5) {
-                        int srcEnd = item.description.indexOf("\"", srcStart);
-                        if (srcEnd > srcStart) {
-                            item.imageUrl = item.description.mid(srcStart, srcEnd - srcStart);
-                        }
-                    }
-                }
-            } else if (xml.name() == "published" || xml.name() == "updated") {
-                // Only set pubDate if it's not already set
-                if (item.pubDate.isEmpty()) {
-                    item.pubDate = xml.readElementText();
-                }
-            } else if (xml.name() == "category") {
-                QXmlStreamAttributes attrs = xml.attributes();
-                if (attrs.hasAttribute("term")) {
-                    item.category = attrs.value("term").toString();
-                } else {
-                    item.category = xml.readElementText();
+        case AtomLinkElement: {
+            // Atom links and atom:link in RSS; rel defaults to alternate
+            const QXmlStreamAttributes attrs = xml.attributes();
+            const QStringRef rel = attrs.value("rel");
+            if (rel.isEmpty() || rel == QLatin1String("alternate")) {
+                if (!item.hasLink()) {
+                    item.setLink(attrs.value("href"));
                 }
+            } else if (rel == QLatin1String("enclosure") && !item.hasImageUrl()
+                       && attrs.value("type").startsWith(QLatin1String("image/"))) {
+                item.setImageUrl(attrs.value("href"));
+            }
+            ++depth;
+            break;
+        }
+        case EnclosureElement: {
+            const QXmlStreamAttributes attrs = xml.attributes();
+            if (!item.hasImageUrl() && attrs.value("type").startsWith(QLatin1String("image/"))) {
+                item.setImageUrl(attrs.value("url"));
+            }
+            ++depth;
+            break;
+        }
+        case MediaContentElement: {
+            // Images only; medium or type may be missing on image-only feeds
+            const QXmlStreamAttributes attrs = xml.attributes();
+            const QStringRef medium = attrs.value("medium");
+            const QStringRef type = attrs.value("type");
+            bool image = medium.isEmpty() ? (type.isEmpty() || type.startsWith(QLatin1String("image/")))
+                                          : medium == QLatin1String("image");
+            if (image && !item.hasImageUrl()) {
+                item.setImageUrl(attrs.value("url"));
             }
+            ++depth;
+            break;
+        }
+        case MediaThumbnailElement:
+            if (!item.hasImageUrl()) {
+                const QXmlStreamAttributes attrs = xml.attributes();
+                item.setImageUrl(attrs.value("url"));
+            }
+            ++depth;
+            break;
+        case MediaGroupElement:
+            ++depth;
+            break;
+        default:
+            xml.skipCurrentElement();
+            break;
         }
     }
 }
 
-void RssParser::processNewItems(const QList<FeedItem> &newItems)
+// Shared by every format: validate, deduplicate by GUID and append
+void RssParser::ingestItem(FeedItem &item, qint64 fetchTime, quint16 feedId)
 {
-    if (newItems.isEmpty()) {
+    // Only add if we have a valid item with a unique GUID
+    if (item.title.isEmpty() || !item.hasLink()) {
         return;
     }
+    ++m_ingest.itemsSeen;
     
-    // Add new items to the m_feedItems list
-    m_feedItems.append(newItems);
+    // Generate a GUID if one wasn't provided
+    if (item.guidKey().isEmpty()) {
+        item.setGuidKey(fallbackGuid(item));
+    }
+    
+    // Check if we've already processed this item
+    if (!isKnownItem(item.guidKey())) {
+        item.pubTime = ArticleStore::parsePubTime(item.pubDate);
+        
+        // Past the age limit retention would delete it again straight away
+        if (item.pubTime > 0 && item.pubTime < m_ingest.minAgeTime) {
+            return;
+        }
+        item.fetchTime = fetchTime;
+        item.feedId = feedId;
+        summarizeBody(item);
+        m_ingest.guids->insert(item.guidKey());
+        
+        // Move the fields into the list instead of sharing them
+        m_ingest.items->append(FeedItem());
+        m_ingest.items->last() = std::move(item);
+    }
+}
+
+// MD5 over the UTF-8 of link and title, the historic key of items without
+// a GUID; assembled in the arena instead of through QString temporaries
+QByteArray RssParser::fallbackGuid(const FeedItem &item)
+{
+    QByteArray &bytes = m_arena.bytes;
+    bytes.resize(0);
+    const CompactUrl &link = item.compactLink();
+    if (link.prefixId != 0) {
+        appendUtf8(bytes, InternTable::urlPrefixes().value(link.prefixId));
+    }
+    bytes.append(link.rest);
+    appendUtf8(bytes, item.title);
     
-    // Save the updated feed
-    saveFeedCache(m_currentUrl);
+    m_arena.md5.reset();
+    m_arena.md5.addData(bytes);
+    return m_arena.md5.result().toHex();
+}
+
+// Parse a JSON Feed; items go through the same pipeline as RSS and Atom
+bool RssParser::parseJsonFeed(const QByteArray &data, QString *errorString)
+{
+    const qint64 fetchTime = QDateTime::currentSecsSinceEpoch();
+    const quint16 feedId = InternTable::feeds().intern(m_ingest.feedUrl);
     
-    emit newItemsAvailable(newItems.size());
-    emit feedUpdated();
+    JsonFeedReader reader(data);
+    bool ok = reader.readItems([&](FeedItem &item) {
+        ingestItem(item, fetchTime, feedId);
+    });
+    if (!ok && errorString) {
+        *errorString = reader.errorString();
+    }
+    return ok;
+}
+
+void RssParser::summarizeBody(FeedItem &item)
+{
+    // One scan per accepted item; explicit enclosures and media take precedence
+    HtmlSummary summary = HtmlScanner::scan(item.descriptionUtf8());
+    if (!item.hasImageUrl()) {
+        item.setImageUrl(summary.imageUrl);
+    }
+    item.setSnippet(summary.snippet);
+    item.wordCount = quint32(summary.wordCount);
+    item.setLinks(summary.links);
 }
 
 // New methods for feed management
@@ -620,18 +1428,30 @@ void RssParser::saveFeedsToSettings()
 
 void RssParser::clearCache()
 {
+    // Remove any legacy cache files that were never migrated
     QDir cacheDir(getCacheDir());
     if (cacheDir.exists()) {
-        // Remove all cache files
         QStringList files = cacheDir.entryList(QDir::Files);
         for (const QString &file : files) {
             cacheDir.remove(file);
         }
-        
-        // Clear memory cache
-        m_feedItems.clear();
-        m_processedGuids.clear();
-        
-        emit statusMessage(tr("Cache cleared successfully"));
     }
+    
+    // Items left in the store would come back on the next start
+    if (!m_store.clear()) {
+        emit error(tr("Could not clear the article cache"));
+        return;
+    }
+    
+    // Clear memory cache
+    m_feedItems.clear();
+    m_processedGuids.clear();
+    m_descriptionCache.clear();
+    ++m_itemsGeneration;
+    rebuildSearches();
+    refreshUnreadCounts();
+    emit unreadCountsChanged();
+    emit storeChanged();
+    
+    emit statusMessage(tr("Cache cleared successfully"));
 } 
\ No newline at end of file
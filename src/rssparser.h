@@ -10,18 +10,15 @@
 #include <QDir>
 #include <QStandardPaths>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QCache>
+#include <QCryptographicHash>
 
-struct FeedItem {
-    QString title;
-    QString link;
-    QString description;
-    QString pubDate;
-    QString imageUrl;
-    QString category;
-    QString guid;
-    bool isRead = false;
-    QDateTime fetchTime = QDateTime::currentDateTime();
-};
+#include "feeditem.h"
+#include "articlestore.h"
+#include "alertengine.h"
+#include "savedsearch.h"
 
 class RssParser : public QObject
 {
@@ -32,17 +29,97 @@ public:
     ~RssParser();
 
     void fetchFeed(const QString &url);
+    const QString &currentUrl() const { return m_currentUrl; }
+    
+    // Fetches every other feed in the background; new items are stored and
+    // checked against the alert rules but do not become resident
+    void refreshAllFeeds();
+    // The same for the feeds not checked within the last maxAgeSecs
+    void refreshDueFeeds(int maxAgeSecs);
     QList<FeedItem> getItems() const;
+    const QList<FeedItem> &items() const { return m_feedItems; }
+    
+    // Changes whenever resident items are removed or replaced rather than
+    // appended, so views can tell when incremental bookkeeping must restart.
+    // Appends of fetched items are announced by itemsAboutToBeAppended and
+    // itemsAppended.
+    quint64 itemsGeneration() const { return m_itemsGeneration; }
     void clearItems();
     
-    // New methods for caching
+    // Older stored items of the current feed are paged in as the list scrolls
+    bool canFetchMore() const { return !m_history.atEnd; }
+    QList<FeedItem> fetchHistoryPage(int limit);
+    void appendItems(const QList<FeedItem> &items);
+    
+    // Description bodies live in the article store and are paged in on demand
+    QString description(const FeedItem &item);
+    QSet<QByteArray> searchItems(const QString &text);
+    
+    // Stored items of one feed, or of every feed when the URL is empty,
+    // matching the text if any; newest first, without bodies
+    QList<FeedItem> storedItems(const QString &feedUrl, const QString &text, int limit)
+    {
+        return m_store.searchArticles(feedUrl, text, limit);
+    }
+    
+    // Feed name for a URL, the URL itself for an unknown feed
+    QString feedLabel(const QString &url) const;
+    
+    // Names of the other feeds that published the same story
+    QStringList otherSources(const FeedItem &item);
+    
+    // Persistence through the article store
     void saveFeedCache(const QString &feedUrl);
     bool loadFeedCache(const QString &feedUrl);
     static QString getCacheFilePath(const QString &feedUrl);
     void clearCache();
     
-    // Set item as read
-    void setItemAsRead(const QString &guid);
+    // Set item as read; GUIDs are unique within their feed only
+    void setItemAsRead(const QString &feedUrl, const QString &guid);
+    // Every resident item, with one store write and one counter refresh
+    void setAllItemsAsRead();
+    
+    // Unread articles per feed and over all feeds, mirrored from the store's
+    // counters after every write; reading them costs a hash lookup
+    int unreadCount(const QString &feedUrl) const;
+    int totalUnread() const { return m_totalUnread; }
+    
+    // Retention limits for resident and stored items
+    void setRetentionPolicy(const RetentionPolicy &policy);
+    RetentionPolicy retentionPolicy() const { return m_retention; }
+    
+    // Parses a feed document through the ingest path, repairing it if it is
+    // malformed, without the network or the store; for tests and benchmarks
+    bool parseItems(const QString &feedUrl, const QByteArray &payload, const QByteArray &contentType,
+                    QList<FeedItem> *items, QString *errorString = nullptr, bool *recovered = nullptr);
+    
+    // Memory accounting
+    struct MemoryReport {
+        int itemCount = 0;
+        qint64 itemBytes = 0;
+        qint64 legacyItemBytes = 0; // same items with the previous FeedItem layout
+        int internCount = 0;
+        qint64 internBytes = 0;
+        int descriptionCacheCount = 0;
+        qint64 descriptionCacheBytes = 0;
+        int guidCount = 0;
+        qint64 guidBytes = 0;
+        qint64 storeUsedBytes = 0;
+        qint64 storeFileBytes = 0;
+    };
+    MemoryReport memoryReport();
+    
+    // Stored bodies used to benchmark the HTML scanner
+    QList<QByteArray> sampleDescriptions(int limit) { return m_store.sampleDescriptions(limit); }
+    
+    // Keyword alerts, evaluated on new items of every fetched feed
+    AlertEngine &alerts() { return m_alerts; }
+    
+    // Saved searches open like feeds, under SavedSearches::sourceUrl(name),
+    // from results kept current as articles are stored, read and evicted
+    QList<SavedSearch> savedSearches() const;
+    bool addSavedSearch(const SavedSearch &search);
+    void removeSavedSearch(const QString &name);
     
     // Retry mechanism
     void setMaxRetryAttempts(int attempts) { m_maxRetryAttempts = attempts; }
@@ -57,12 +134,20 @@ signals:
     void feedUpdated();
     void error(const QString &message);
     void newItemsAvailable(int count);
+    void itemsAboutToBeAppended(int count);
+    void itemsAppended();
     void statusMessage(const QString &message);
+    void backgroundItemsAvailable(int count, const QString &feedName);
+    void unreadCountsChanged();
+    
+    // Stored articles were added, removed or marked read
+    void storeChanged();
+    void itemsStored(const QString &feedUrl, const QList<FeedItem> &items);
+    void alertTriggered(const QString &rule, const QString &title, const QString &feedName);
 
 private slots:
     void parseReply(QNetworkReply *reply);
     void retryFetchFeed();
-    void handleNetworkTimeout();
 
 private:
     QNetworkAccessManager *m_networkManager;
@@ -70,18 +155,87 @@ private:
     QString m_currentUrl;
     int m_retryCount;
     int m_maxRetryAttempts;
+    quint64 m_itemsGeneration;
     QTimer *m_retryTimer;
-    QTimer *m_networkTimeoutTimer;
-    QStringList m_processedGuids; // To track which items we've already processed
+    QSet<QByteArray> m_processedGuids; // GUIDs of the resident items, shared with the items
     QHash<QString, QPair<QString, QString>> m_feeds; // name -> (url, category)
+    static const int DescriptionCacheSize = 32;
+    static const int ResidentPageSize = 200; // rows loaded when a feed is opened
+    static const int RequestTimeoutMs = 15000; // idle time before a request is aborted
+    static const int DueSlackSecs = 60; // timer jitter allowed when picking feeds due a refresh
+    ArticleStore m_store;
+    QCache<QByteArray, QString> m_descriptionCache; // guid -> recently viewed bodies
+    RetentionPolicy m_retention;
+    AlertEngine m_alerts;
+    SavedSearches m_searches;
+    QHash<QString, int> m_unreadCounts; // feed URL -> unread articles
+    int m_totalUnread;
+    QSet<QString> m_backgroundFetches; // feed URLs with a background request in flight
+    static const QNetworkRequest::Attribute FeedUrlAttribute = QNetworkRequest::User;
+    
+    // Where parsed items go: a scratch list, checked against the resident
+    // GUIDs for the current feed or its own set for a background feed
+    struct IngestTarget {
+        IngestTarget(const QString &feedUrl = QString(), QList<FeedItem> *items = nullptr,
+                     QSet<QByteArray> *guids = nullptr, bool checkStore = true, qint64 minAgeTime = 0)
+            : feedUrl(feedUrl), items(items), guids(guids), checkStore(checkStore), minAgeTime(minAgeTime),
+              itemsSeen(0) {}
+        QString feedUrl;
+        QList<FeedItem> *items;
+        QSet<QByteArray> *guids;
+        bool checkStore;   // false when nothing of the feed can be stored yet
+        qint64 minAgeTime; // older items would be evicted at once; 0 keeps all
+        int itemsSeen;     // valid items parsed, new or not
+    };
+    IngestTarget m_ingest;
+    
+    // Scratch space reused by every element of every parse. Element text is
+    // gathered here and converted once into the item's own storage; the
+    // buffers keep their capacity, so steady-state parsing allocates only
+    // for the fields that are kept.
+    struct ParseArena {
+        QString text;
+        QByteArray bytes;
+        QCryptographicHash md5 { QCryptographicHash::Md5 };
+    };
+    ParseArena m_arena;
+    ItemCursor m_history; // oldest resident row of the current feed
+    
+    // Per-request timing state for the metrics registry
+    struct FetchTiming {
+        QElapsedTimer clock;
+        qint64 headersAt = -1;
+        qint64 bytes = 0;
+    };
+    QHash<QNetworkReply*, FetchTiming> m_fetchTimings;
+    
+    // Payload format, sniffed from the first bytes and the Content-Type
+    enum FeedFormat { UnknownFormat, RssFormat, AtomFormat, RdfFormat, JsonFeedFormat };
+    static FeedFormat detectFormat(const QByteArray &payload, const QByteArray &contentType);
     
+    // Parses into m_ingest, with a repair pass for malformed XML
+    bool parsePayload(const QByteArray &payload, const QByteArray &contentType, QString *errorString, bool *recovered);
+    bool parseDocument(const QByteArray &data, FeedFormat format, QString *errorString = nullptr);
     bool parseXml(QXmlStreamReader &xml);
     void parseItem(QXmlStreamReader &xml, FeedItem &item);
-    void parseAtom(QXmlStreamReader &xml);
-    void parseAtomEntry(QXmlStreamReader &xml, FeedItem &item);
-    void processNewItems(const QList<FeedItem> &newItems);
+    QStringRef readText(QXmlStreamReader &xml);
+    QByteArray fallbackGuid(const FeedItem &item);
+    void startRequest(const QString &url);
+    bool parseJsonFeed(const QByteArray &data, QString *errorString);
+    void emitAlerts(const QString &feedUrl, const QList<FeedItem> &newItems);
+    void openSearch(const QString &url);
+    void rebuildSearches();
+    void updateSearches(const QList<FeedItem> &newItems);
+    void ingestItem(FeedItem &item, qint64 fetchTime, quint16 feedId);
+    void storeItems(const QString &feedUrl, const QList<FeedItem> &items);
+    void releaseDescriptions();
+    void summarizeBody(FeedItem &item);
+    bool isKnownItem(const QByteArray &guid);
+    void enforceRetention(const QString &feedUrl);
+    void refreshUnreadCounts();
+    void loadRetentionPolicy();
     
-    // Return caching directory
+    // Directory of the legacy per-feed JSON cache files
     QString getCacheDir() const;
     
     // Load and save feeds
@@ -0,0 +1,236 @@
+#include "savedsearch.h"
+#include "categoryindex.h"
+
+#include <QSettings>
+
+static const QLatin1String SourcePrefix("search:");
+
+SearchPredicate::SearchPredicate(const SavedSearch &search)
+    : m_feedId(search.feedUrl.isEmpty() ? 0 : InternTable::feeds().intern(search.feedUrl))
+    , m_categoryId(search.category.isEmpty() ? 0 : CategoryIndex::instance().normalize(search.category))
+    , m_text(search.text.trimmed())
+    , m_unreadOnly(search.unreadOnly)
+{
+}
+
+bool SearchPredicate::matches(const FeedItem &item, bool checkText) const
+{
+    if (m_unreadOnly && item.isRead) {
+        return false;
+    }
+    if (m_feedId != 0 && item.feedId != m_feedId) {
+        return false;
+    }
+    if (m_categoryId != 0 && !item.hasCategory(m_categoryId)) {
+        return false;
+    }
+    return !checkText || matchesText(item);
+}
+
+bool SearchPredicate::matchesText(const FeedItem &item) const
+{
+    if (m_text.isEmpty() || item.title.contains(m_text, Qt::CaseInsensitive)) {
+        return true;
+    }
+    for (const QString &category : item.categories()) {
+        if (category.contains(m_text, Qt::CaseInsensitive)) {
+            return true;
+        }
+    }
+    // Only new items still carry their body
+    return !item.descriptionUtf8().isEmpty() && item.description().contains(m_text, Qt::CaseInsensitive);
+}
+
+QString SavedSearches::sourceUrl(const QString &name)
+{
+    return SourcePrefix + name;
+}
+
+bool SavedSearches::isSource(const QString &url)
+{
+    return url.startsWith(SourcePrefix);
+}
+
+QString SavedSearches::sourceName(const QString &url)
+{
+    return isSource(url) ? url.mid(SourcePrefix.size()) : QString();
+}
+
+void SavedSearches::setSearches(const QList<SavedSearch> &searches)
+{
+    m_views.clear();
+    for (const SavedSearch &search : searches) {
+        View view;
+        view.search = search;
+        view.predicate = SearchPredicate(search);
+        m_views.append(view);
+    }
+}
+
+QList<SavedSearch> SavedSearches::searches() const
+{
+    QList<SavedSearch> searches;
+    for (const View &view : m_views) {
+        searches.append(view.search);
+    }
+    return searches;
+}
+
+int SavedSearches::indexOf(const QString &name) const
+{
+    for (int i = 0; i < m_views.size(); ++i) {
+        if (m_views.at(i).search.name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SavedSearches::setResults(int view, const QList<FeedItem> &rows)
+{
+    View &target = m_views[view];
+    target.results.clear();
+    target.unread = 0;
+    for (const FeedItem &row : rows) {
+        // The store matched the text against the bodies already
+        if (target.predicate.matches(row, false)) {
+            target.results.append(result(row));
+            if (!row.isRead) {
+                ++target.unread;
+            }
+        }
+    }
+    target.results.squeeze();
+}
+
+QList<ArticleKey> SavedSearches::keys(int view, const QSet<QByteArray> &skip, int limit) const
+{
+    QList<ArticleKey> keys;
+    for (const Result &result : m_views.at(view).results) {
+        if (keys.size() >= limit) {
+            break;
+        }
+        if (!skip.contains(result.guid)) {
+            ArticleKey key;
+            key.feedUrl = InternTable::feeds().value(result.feedId);
+            key.guid = result.guid;
+            keys.append(key);
+        }
+    }
+    return keys;
+}
+
+QVector<int> SavedSearches::addItem(const FeedItem &item)
+{
+    QVector<int> views;
+    for (int i = 0; i < m_views.size(); ++i) {
+        View &view = m_views[i];
+        if (!view.predicate.matches(item)) {
+            continue;
+        }
+        view.results.prepend(result(item));
+        if (!item.isRead) {
+            ++view.unread;
+        }
+        views.append(i);
+    }
+    return views;
+}
+
+bool SavedSearches::markRead(const QList<ArticleKey> &articles)
+{
+    bool changed = false;
+    for (View &view : m_views) {
+        for (const ArticleKey &key : articles) {
+            int row = find(view.results, key);
+            if (row < 0 || view.results.at(row).isRead) {
+                continue;
+            }
+            if (view.search.unreadOnly) {
+                view.results.remove(row);
+            } else {
+                view.results[row].isRead = true;
+            }
+            --view.unread;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool SavedSearches::evict(const QList<ArticleKey> &articles)
+{
+    bool changed = false;
+    for (View &view : m_views) {
+        for (const ArticleKey &key : articles) {
+            int row = find(view.results, key);
+            if (row < 0) {
+                continue;
+            }
+            if (!view.results.at(row).isRead) {
+                --view.unread;
+            }
+            view.results.remove(row);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+SavedSearches::Result SavedSearches::result(const FeedItem &item)
+{
+    Result result;
+    result.guid = item.guidKey();
+    result.feedId = item.feedId;
+    result.isRead = item.isRead;
+    return result;
+}
+
+int SavedSearches::find(const QVector<Result> &results, const ArticleKey &key)
+{
+    const quint16 feedId = InternTable::feeds().intern(key.feedUrl);
+    for (int i = 0; i < results.size(); ++i) {
+        if (results.at(i).feedId == feedId && results.at(i).guid == key.guid) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SavedSearches::load()
+{
+    QSettings settings;
+    QList<SavedSearch> searches;
+    int size = settings.beginReadArray("savedSearches");
+    for (int i = 0; i < size; ++i) {
+        settings.setArrayIndex(i);
+        SavedSearch search;
+        search.name = settings.value("name").toString();
+        search.feedUrl = settings.value("feedUrl").toString();
+        search.category = settings.value("category").toString();
+        search.text = settings.value("text").toString();
+        search.unreadOnly = settings.value("unreadOnly", false).toBool();
+        if (!search.name.isEmpty()) {
+            searches.append(search);
+        }
+    }
+    settings.endArray();
+
+    setSearches(searches);
+}
+
+void SavedSearches::save() const
+{
+    QSettings settings;
+    settings.beginWriteArray("savedSearches");
+    for (int i = 0; i < m_views.size(); ++i) {
+        const SavedSearch &search = m_views.at(i).search;
+        settings.setArrayIndex(i);
+        settings.setValue("name", search.name);
+        settings.setValue("feedUrl", search.feedUrl);
+        settings.setValue("category", search.category);
+        settings.setValue("text", search.text);
+        settings.setValue("unreadOnly", search.unreadOnly);
+    }
+    settings.endArray();
+}
\ No newline at end of file
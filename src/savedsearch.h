@@ -0,0 +1,95 @@
+#ifndef SAVEDSEARCH_H
+#define SAVEDSEARCH_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QSet>
+
+#include "articlestore.h"
+
+// A named filter over every stored article
+struct SavedSearch {
+    QString name;
+    QString feedUrl;  // empty for every feed
+    QString category; // empty for every category
+    QString text;     // title, categories or body; empty matches everything
+    bool unreadOnly = false;
+};
+
+// A saved search compiled against the item fields: interned feed and
+// category IDs, so everything but the text is an integer test
+class SearchPredicate
+{
+public:
+    explicit SearchPredicate(const SavedSearch &search = SavedSearch());
+
+    // checkText is false for rows the store has already matched on text
+    bool matches(const FeedItem &item, bool checkText = true) const;
+    bool matchesText(const FeedItem &item) const;
+
+private:
+    quint16 m_feedId;     // 0 for every feed
+    quint16 m_categoryId; // 0 for every category
+    QString m_text;
+    bool m_unreadOnly;
+};
+
+// Saved searches kept as live result sets. Each set is read from the store
+// once and then follows the articles as they arrive, are read and are
+// evicted, so its unread count is always current. A result is only the
+// article's key and read flag; an opened search pages its rows in from the
+// store like a feed.
+class SavedSearches
+{
+public:
+    // Saved searches appear as sources named "search:<name>"
+    static QString sourceUrl(const QString &name);
+    static bool isSource(const QString &url);
+    static QString sourceName(const QString &url);
+
+    void setSearches(const QList<SavedSearch> &searches);
+    QList<SavedSearch> searches() const;
+    int indexOf(const QString &name) const;
+    int size() const { return m_views.size(); }
+    const SavedSearch &search(int view) const { return m_views.at(view).search; }
+
+    // Replaces a search's results with the store rows matching its text
+    void setResults(int view, const QList<FeedItem> &rows);
+
+    // The newest results whose GUIDs are not in skip, at most limit of them
+    QList<ArticleKey> keys(int view, const QSet<QByteArray> &skip, int limit) const;
+    int unreadCount(int view) const { return m_views.at(view).unread; }
+
+    // Views that took a newly stored item
+    QVector<int> addItem(const FeedItem &item);
+
+    // Read state shared by every article of a story; returns whether any view changed
+    bool markRead(const QList<ArticleKey> &articles);
+    bool evict(const QList<ArticleKey> &articles);
+
+    // QSettings persistence
+    void load();
+    void save() const;
+
+private:
+    struct Result {
+        QByteArray guid;
+        quint16 feedId;
+        bool isRead;
+    };
+
+    struct View {
+        SavedSearch search;
+        SearchPredicate predicate;
+        QVector<Result> results; // newest first
+        int unread = 0;
+    };
+
+    QList<View> m_views;
+
+    static Result result(const FeedItem &item);
+    static int find(const QVector<Result> &results, const ArticleKey &key);
+};
+
+#endif // SAVEDSEARCH_H
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "singleinstance.h"
+
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDir>
+#include <QDebug>
+
+namespace {
+
+const char Ack = '+';
+
+QByteArray encodeArguments(const QStringList &arguments)
+{
+    // Length-prefixed so the reader knows when the message is complete
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << arguments;
+
+    QByteArray message;
+    QDataStream framed(&message, QIODevice::WriteOnly);
+    framed << quint32(payload.size());
+    return message + payload;
+}
+
+} // namespace
+
+SingleInstance::SingleInstance(QObject *parent)
+    : QObject(parent)
+    , m_lock(dataDir() + "/instance.lock")
+    , m_server(nullptr)
+    , m_delivering(false)
+{
+    // Per user and data directory, which is what two instances would share
+    const QByteArray key = QCryptographicHash::hash(dataDir().toUtf8(), QCryptographicHash::Md5).toHex().left(16);
+    m_serverName = QCoreApplication::applicationName() + "-" + QString::fromLatin1(key);
+
+    // Only a lock whose process is gone is stale, however long the primary runs
+    m_lock.setStaleLockTime(0);
+    if (!m_lock.tryLock(0)) {
+        return;
+    }
+
+    // Holding the lock, any socket left under the name is stale
+    QLocalServer::removeServer(m_serverName);
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    if (!m_server->listen(m_serverName)) {
+        qWarning() << "Single instance server failed:" << m_server->errorString();
+    }
+    connect(m_server, &QLocalServer::newConnection, this, &SingleInstance::onNewConnection);
+}
+
+SingleInstance::~SingleInstance()
+{
+    if (m_server) {
+        m_server->close();
+        m_lock.unlock();
+    }
+}
+
+QString SingleInstance::dataDir()
+{
+    const QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(path);
+    return path;
+}
+
+bool SingleInstance::sendArguments(const QStringList &arguments, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // The primary may still be starting up and not listening yet
+    QLocalSocket socket;
+    forever {
+        socket.connectToServer(m_serverName);
+        if (socket.waitForConnected(qMax(1, timeoutMs - int(timer.elapsed())))) {
+            break;
+        }
+        if (timer.elapsed() >= timeoutMs) {
+            qWarning() << "Could not reach the running instance:" << socket.errorString();
+            return false;
+        }
+        QThread::msleep(100);
+    }
+
+    socket.write(encodeArguments(arguments));
+    if (!socket.waitForBytesWritten(timeoutMs)) {
+        return false;
+    }
+
+    // Wait for the primary to confirm before exiting
+    const bool delivered = socket.waitForReadyRead(qMax(1, timeoutMs - int(timer.elapsed())))
+                        && socket.read(1) == QByteArray(1, Ack);
+    socket.disconnectFromServer();
+    return delivered;
+}
+
+void SingleInstance::startDelivery()
+{
+    m_delivering = true;
+    const QList<QStringList> pending = m_pending;
+    m_pending.clear();
+    for (const QStringList &arguments : pending) {
+        emit argumentsReceived(arguments);
+    }
+}
+
+void SingleInstance::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, &SingleInstance::onReadyRead);
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void SingleInstance::onReadyRead()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket) {
+        return;
+    }
+
+    QByteArray &buffer = m_buffers[socket];
+    buffer += socket->readAll();
+    if (buffer.size() < int(sizeof(quint32))) {
+        return;
+    }
+
+    quint32 size = 0;
+    QDataStream header(buffer);
+    header >> size;
+    if (size > 64 * 1024) {
+        qWarning() << "Ignoring oversized message from another instance";
+        socket->abort();
+        return;
+    }
+    if (quint32(buffer.size()) < sizeof(quint32) + size) {
+        return;
+    }
+
+    QStringList arguments;
+    QDataStream in(buffer.mid(sizeof(quint32), int(size)));
+    in.setVersion(QDataStream::Qt_5_0);
+    in >> arguments;
+    m_buffers.remove(socket);
+
+    socket->write(QByteArray(1, Ack));
+    socket->flush();
+    if (m_delivering) {
+        emit argumentsReceived(arguments);
+    } else {
+        m_pending.append(arguments);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef SINGLEINSTANCE_H
+#define SINGLEINSTANCE_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QLockFile>
+#include <QStringList>
+#include <QHash>
+
+// Keeps one running instance per user data directory. The first launch
+// takes a lock file and listens on a local socket; later launches send
+// their command line to it and exit, so only one parser ever fetches
+// feeds and writes the store and settings.
+class SingleInstance : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SingleInstance(QObject *parent = nullptr);
+    ~SingleInstance();
+
+    // True for the instance that holds the lock and serves the others
+    bool isPrimary() const { return m_server != nullptr; }
+
+    // Hands the arguments to the primary instance; false if it cannot be
+    // reached. The primary only answers once its event loop runs, which
+    // can take a few seconds after it starts.
+    bool sendArguments(const QStringList &arguments, int timeoutMs = 5000);
+
+    // Arguments received before this are queued, since the splash screen
+    // runs events before anything can handle them; they are emitted now,
+    // in order, and later ones as they arrive
+    void startDelivery();
+
+signals:
+    void argumentsReceived(const QStringList &arguments);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    QLockFile m_lock;
+    QLocalServer *m_server;
+    QString m_serverName;
+    QHash<QLocalSocket*, QByteArray> m_buffers; // partial messages
+    QList<QStringList> m_pending;               // received before startDelivery
+    bool m_delivering;
+
+    static QString dataDir();
+};
+
+#endif // SINGLEINSTANCE_H
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "stallwatchdog.h"
+#include "feedmetrics.h"
+
+#include <QMutexLocker>
+#include <QSettings>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QStringList>
+
+// Scope stack shared between the GUI thread (writer) and the monitor (reader).
+// Names are string literals, so the pointers stay valid for the whole run.
+static const int MaxScopeDepth = 16;
+static std::atomic<const char *> s_scopes[MaxScopeDepth];
+static std::atomic<int> s_scopeDepth(0);
+
+// Event loop lag reported to the metrics registry regardless of the watchdog
+static const int MetricsLagThresholdMs = 50;
+
+class StallMonitorThread : public QThread
+{
+public:
+    explicit StallMonitorThread(StallWatchdog *watchdog) : m_watchdog(watchdog) {}
+
+protected:
+    void run() override
+    {
+        bool stalled = false;
+        qint64 stallBeat = 0;
+        StallRecord record;
+
+        while (!isInterruptionRequested()) {
+            QThread::msleep(StallWatchdog::MonitorIntervalMs);
+
+            qint64 beat = m_watchdog->m_lastBeat.load();
+            qint64 now = m_watchdog->m_clock.elapsed();
+
+            if (stalled) {
+                if (beat != stallBeat) {
+                    // Heartbeat resumed, the stall is over
+                    record.durationMs = beat - stallBeat - StallWatchdog::HeartbeatIntervalMs;
+                    m_watchdog->addRecord(record);
+                    stalled = false;
+                } else {
+                    record.samples[StallWatchdog::scopeStack()]++;
+                }
+            } else if (now - beat - StallWatchdog::HeartbeatIntervalMs > m_watchdog->thresholdMs()) {
+                stalled = true;
+                stallBeat = beat;
+
+                record = StallRecord();
+                record.when = QDateTime::currentDateTime().addMSecs(-(now - beat));
+                record.scope = StallWatchdog::scopeStack();
+                record.samples[record.scope]++;
+            }
+        }
+    }
+
+private:
+    StallWatchdog *m_watchdog;
+};
+
+StallWatchdog::StallWatchdog(QObject *parent) : QObject(parent),
+    m_lastBeat(0),
+    m_thresholdMs(200),
+    m_monitor(nullptr)
+{
+    m_clock.start();
+
+    m_heartbeatTimer = new QTimer(this);
+    m_heartbeatTimer->setInterval(HeartbeatIntervalMs);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &StallWatchdog::onHeartbeat);
+    m_heartbeatTimer->start();
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    setEnabled(false);
+}
+
+void StallWatchdog::onHeartbeat()
+{
+    qint64 now = m_clock.elapsed();
+    qint64 lateMs = now - m_lastBeat.load() - HeartbeatIntervalMs;
+    m_lastBeat.store(now);
+
+    if (lateMs > MetricsLagThresholdMs) {
+        FeedMetrics::instance().recordDuration(FeedMetrics::AppScope, FeedMetrics::StageGuiStall, lateMs);
+    }
+}
+
+void StallWatchdog::setEnabled(bool enabled)
+{
+    if (enabled == isEnabled()) {
+        return;
+    }
+
+    if (enabled) {
+        m_lastBeat.store(m_clock.elapsed());
+        m_monitor = new StallMonitorThread(this);
+        m_monitor->start();
+    } else {
+        m_monitor->requestInterruption();
+        m_monitor->wait();
+        delete m_monitor;
+        m_monitor = nullptr;
+    }
+}
+
+bool StallWatchdog::isEnabled() const
+{
+    return m_monitor != nullptr;
+}
+
+void StallWatchdog::addRecord(const StallRecord &record)
+{
+    QMutexLocker locker(&m_recordsMutex);
+
+    // Keep only the worst stalls, ordered by duration
+    int pos = 0;
+    while (pos < m_records.size() && m_records.at(pos).durationMs >= record.durationMs) {
+        ++pos;
+    }
+
+    if (pos >= MaxRecords) {
+        return;
+    }
+
+    m_records.insert(pos, record);
+    while (m_records.size() > MaxRecords) {
+        m_records.removeLast();
+    }
+}
+
+QList<StallRecord> StallWatchdog::worstStalls() const
+{
+    QMutexLocker locker(&m_recordsMutex);
+    return m_records;
+}
+
+void StallWatchdog::clear()
+{
+    QMutexLocker locker(&m_recordsMutex);
+    m_records.clear();
+}
+
+QByteArray StallWatchdog::toJson() const
+{
+    QJsonArray stalls;
+    for (const StallRecord &record : worstStalls()) {
+        QJsonObject samples;
+        for (auto it = record.samples.constBegin(); it != record.samples.constEnd(); ++it) {
+            samples[it.key()] = it.value();
+        }
+
+        QJsonObject stall;
+        stall["when"] = record.when.toString(Qt::ISODateWithMs);
+        stall["duration_ms"] = record.durationMs;
+        stall["scope"] = record.scope;
+        stall["samples"] = samples;
+        stalls.append(stall);
+    }
+
+    QJsonObject root;
+    root["generated"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["threshold_ms"] = thresholdMs();
+    root["sample_interval_ms"] = MonitorIntervalMs;
+    root["stalls"] = stalls;
+
+    return QJsonDocument(root).toJson();
+}
+
+void StallWatchdog::loadSettings()
+{
+    QSettings settings;
+    setThresholdMs(settings.value("diagnostics/stallThresholdMs", 200).toInt());
+    setEnabled(settings.value("diagnostics/stallWatchdogEnabled", false).toBool());
+}
+
+void StallWatchdog::saveSettings() const
+{
+    QSettings settings;
+    settings.setValue("diagnostics/stallThresholdMs", thresholdMs());
+    settings.setValue("diagnostics/stallWatchdogEnabled", isEnabled());
+}
+
+void StallWatchdog::pushScope(const char *name)
+{
+    int depth = s_scopeDepth.load(std::memory_order_relaxed);
+    if (depth < MaxScopeDepth) {
+        s_scopes[depth].store(name, std::memory_order_relaxed);
+    }
+    s_scopeDepth.store(depth + 1, std::memory_order_release);
+}
+
+void StallWatchdog::popScope()
+{
+    s_scopeDepth.store(s_scopeDepth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+}
+
+QString StallWatchdog::scopeStack()
+{
+    int depth = qMin(s_scopeDepth.load(std::memory_order_acquire), MaxScopeDepth);
+    if (depth <= 0) {
+        return QStringLiteral("(event loop)");
+    }
+
+    QStringList names;
+    for (int i = 0; i < depth; ++i) {
+        const char *name = s_scopes[i].load(std::memory_order_relaxed);
+        names.append(QLatin1String(name ? name : "?"));
+    }
+    return names.join(" > ");
+}
\ No newline at end of file
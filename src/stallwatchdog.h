@@ -0,0 +1,84 @@
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QObject>
+#include <QTimer>
+#include <QThread>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+
+#include <atomic>
+
+struct StallRecord {
+    QDateTime when;
+    double durationMs = 0.0;
+    QString scope;               // Instrumented scope active when the stall was detected
+    QHash<QString, int> samples; // Scope stack -> number of monitor samples during the stall
+};
+
+// Detects GUI event loop stalls. A heartbeat timer on the GUI thread
+// stamps a shared clock; when enabled, a monitor thread notices missed
+// beats, samples the active StallScope stack and keeps the worst stalls.
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StallWatchdog(QObject *parent = nullptr);
+    ~StallWatchdog();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    void setThresholdMs(int ms) { m_thresholdMs.store(ms); }
+    int thresholdMs() const { return m_thresholdMs.load(); }
+
+    QList<StallRecord> worstStalls() const;
+    void clear();
+    QByteArray toJson() const;
+
+    void loadSettings();
+    void saveSettings() const;
+
+    // Scope stack, only touched from the GUI thread
+    static void pushScope(const char *name);
+    static void popScope();
+    static QString scopeStack();
+
+private slots:
+    void onHeartbeat();
+
+private:
+    friend class StallMonitorThread;
+
+    static const int HeartbeatIntervalMs = 50;
+    static const int MonitorIntervalMs = 10;
+    static const int MaxRecords = 32;
+
+    QTimer *m_heartbeatTimer;
+    QElapsedTimer m_clock;
+    std::atomic<qint64> m_lastBeat;
+    std::atomic<int> m_thresholdMs;
+    QThread *m_monitor;
+
+    mutable QMutex m_recordsMutex;
+    QList<StallRecord> m_records; // Sorted, worst first
+
+    void addRecord(const StallRecord &record);
+};
+
+// RAII marker naming the code path currently running on the GUI thread
+class StallScope
+{
+public:
+    explicit StallScope(const char *name) { StallWatchdog::pushScope(name); }
+    ~StallScope() { StallWatchdog::popScope(); }
+
+private:
+    Q_DISABLE_COPY(StallScope)
+};
+
+#endif // STALLWATCHDOG_H
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "storycluster.h"
+
+#include <QUrl>
+#include <QUrlQuery>
+#include <QtAlgorithms>
+
+#include <algorithm>
+
+namespace {
+
+bool isTrackingParameter(const QString &name)
+{
+    static const char *const names[] = { "fbclid", "gclid", "mc_cid", "mc_eid", "cmpid", "ref", "rss", "icid" };
+    if (name.startsWith(QLatin1String("utm_"))) {
+        return true;
+    }
+    for (const char *tracking : names) {
+        if (name == QLatin1String(tracking)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// FNV-1a; stable across runs, unlike qHash, because signatures are stored
+quint64 fnv1a(const QByteArray &data)
+{
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+    for (char c : data) {
+        hash ^= uchar(c);
+        hash *= Q_UINT64_C(1099511628211);
+    }
+    return hash;
+}
+
+} // namespace
+
+QString StoryKey::canonicalUrl(const QString &url)
+{
+    QUrl parsed(url.trimmed());
+    if (!parsed.isValid() || parsed.host().isEmpty()) {
+        return url.trimmed();
+    }
+
+    QString host = parsed.host().toLower();
+    if (host.startsWith(QLatin1String("www."))) {
+        host = host.mid(4);
+    }
+
+    QString path = parsed.path(QUrl::FullyEncoded);
+    if (path.endsWith(QLatin1String("/amp")) || path.endsWith(QLatin1String("/amp/"))) {
+        path.truncate(path.lastIndexOf(QLatin1String("/amp")));
+    }
+    while (path.endsWith(QLatin1Char('/'))) {
+        path.chop(1);
+    }
+
+    QStringList parameters;
+    const auto items = QUrlQuery(parsed).queryItems(QUrl::FullyEncoded);
+    for (const auto &item : items) {
+        if (!isTrackingParameter(item.first.toLower())) {
+            parameters.append(item.first + QLatin1Char('=') + item.second);
+        }
+    }
+    std::sort(parameters.begin(), parameters.end());
+
+    // Scheme-less, so http and https copies compare equal
+    QString canonical = host + path;
+    if (!parameters.isEmpty()) {
+        canonical += QLatin1Char('?') + parameters.join(QLatin1Char('&'));
+    }
+    return canonical;
+}
+
+quint64 StoryKey::titleSignature(const QString &title)
+{
+    // Case and accents folded, punctuation ignored
+    const QString folded = title.normalized(QString::NormalizationForm_KD).toCaseFolded();
+    QStringList tokens;
+    QString token;
+    for (QChar c : folded) {
+        if (c.isLetterOrNumber()) {
+            token += c;
+        } else if (!c.isMark() && !token.isEmpty()) {
+            tokens.append(token);
+            token.clear();
+        }
+    }
+    if (!token.isEmpty()) {
+        tokens.append(token);
+    }
+
+    // Short headlines collide too easily
+    if (tokens.size() < 4) {
+        return 0;
+    }
+
+    // Words and word pairs as features, each voting on all 64 bits
+    int votes[64] = {};
+    auto addFeature = [&votes](const QString &feature) {
+        quint64 hash = fnv1a(feature.toUtf8());
+        for (int bit = 0; bit < 64; ++bit) {
+            votes[bit] += (hash >> bit) & 1 ? 1 : -1;
+        }
+    };
+    for (int i = 0; i < tokens.size(); ++i) {
+        addFeature(tokens.at(i));
+        if (i + 1 < tokens.size()) {
+            addFeature(tokens.at(i) + QLatin1Char(' ') + tokens.at(i + 1));
+        }
+    }
+
+    quint64 signature = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (votes[bit] > 0) {
+            signature |= quint64(1) << bit;
+        }
+    }
+    return signature ? signature : 1;
+}
+
+int StoryKey::distance(quint64 a, quint64 b)
+{
+    return int(qPopulationCount(a ^ b));
+}
+
+quint32 StoryIndex::bandKey(quint64 signature, int band)
+{
+    return quint32(band) << 16 | quint32((signature >> (band * 16)) & 0xFFFF);
+}
+
+void StoryIndex::insert(quint64 signature, qint64 storyId, qint64 time)
+{
+    if (signature == 0) {
+        return;
+    }
+
+    m_newest = qMax(m_newest, time);
+    if (m_entries.size() >= m_compactAt) {
+        compact();
+    }
+
+    const int index = m_entries.size();
+    m_entries.append({ signature, storyId, time });
+    for (int band = 0; band < Bands; ++band) {
+        m_bands.insert(bandKey(signature, band), index);
+    }
+}
+
+qint64 StoryIndex::find(quint64 signature, qint64 time) const
+{
+    if (signature == 0) {
+        return 0;
+    }
+
+    qint64 best = 0;
+    int bestDistance = StoryKey::MaxDistance + 1;
+    for (int band = 0; band < Bands; ++band) {
+        auto it = m_bands.constFind(bandKey(signature, band));
+        for (; it != m_bands.constEnd() && it.key() == bandKey(signature, band); ++it) {
+            const Entry &entry = m_entries.at(it.value());
+            int d = StoryKey::distance(signature, entry.signature);
+            if (d < bestDistance && qAbs(entry.time - time) <= WindowSecs) {
+                best = entry.storyId;
+                bestDistance = d;
+            }
+        }
+    }
+    return best;
+}
+
+void StoryIndex::clear()
+{
+    m_entries.clear();
+    m_bands.clear();
+    m_newest = 0;
+    m_compactAt = CompactThreshold;
+}
+
+void StoryIndex::compact()
+{
+    // Drop entries that can no longer fall inside the window of new items
+    QVector<Entry> entries;
+    entries.reserve(m_entries.size());
+    for (const Entry &entry : m_entries) {
+        if (entry.time >= m_newest - 2 * WindowSecs) {
+            entries.append(entry);
+        }
+    }
+
+    m_entries = entries;
+    m_bands.clear();
+    for (int index = 0; index < m_entries.size(); ++index) {
+        for (int band = 0; band < Bands; ++band) {
+            m_bands.insert(bandKey(m_entries.at(index).signature, band), index);
+        }
+    }
+
+    // A busy window keeps the index large; compact again once it doubles
+    m_compactAt = qMax(int(CompactThreshold), 2 * m_entries.size());
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef STORYCLUSTER_H
+#define STORYCLUSTER_H
+
+#include <QString>
+#include <QVector>
+#include <QMultiHash>
+
+// Keys that recognise the same story published by several feeds: a
+// canonical form of the article URL, and a 64-bit SimHash of the title
+// whose Hamming distance to a near-duplicate headline stays small.
+class StoryKey
+{
+public:
+    // Titles closer than this are the same story
+    static const int MaxDistance = 3;
+
+    // Scheme, www., fragment, tracking parameters, AMP suffix and trailing
+    // slash removed; query parameters sorted
+    static QString canonicalUrl(const QString &url);
+
+    // 0 when the title is too short to compare reliably
+    static quint64 titleSignature(const QString &title);
+
+    static int distance(quint64 a, quint64 b);
+};
+
+// In-memory index of recent title signatures. The 64 bits are split into
+// four 16-bit bands; two signatures within MaxDistance bits share at least
+// one band exactly, so a lookup only compares against band collisions.
+class StoryIndex
+{
+public:
+    // Stories further apart in time are never merged
+    static const qint64 WindowSecs = 3 * 24 * 3600;
+
+    void insert(quint64 signature, qint64 storyId, qint64 time);
+
+    // Closest story within MaxDistance and the time window, 0 if none
+    qint64 find(quint64 signature, qint64 time) const;
+
+    void clear();
+    int size() const { return m_entries.size(); }
+
+private:
+    static const int Bands = 4;
+    static const int CompactThreshold = 4096;
+
+    struct Entry {
+        quint64 signature;
+        qint64 storyId;
+        qint64 time;
+    };
+
+    QVector<Entry> m_entries;
+    QMultiHash<quint32, int> m_bands; // band number << 16 | band bits -> entry
+    qint64 m_newest = 0;
+    int m_compactAt = CompactThreshold;
+
+    static quint32 bandKey(quint64 signature, int band);
+    void compact();
+};
+
+#endif // STORYCLUSTER_H
\ No newline at end of file
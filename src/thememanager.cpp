@@ -0,0 +1,144 @@
+#include "thememanager.h"
+#include "feedmetrics.h"
+
+#include <QApplication>
+#include <QStyle>
+#include <QStyleFactory>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QSettings>
+#include <QFile>
+
+ThemeManager::ThemeManager()
+    : m_theme(LightTheme),
+      m_applied(false),
+      m_legacyStyleSheet(QSettings().value("theme/legacyStyleSheet", false).toBool())
+{
+}
+
+ThemeManager &ThemeManager::instance()
+{
+    static ThemeManager manager;
+    return manager;
+}
+
+void ThemeManager::apply(Theme theme)
+{
+    if (m_applied && theme == m_theme) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_theme = theme;
+    if (m_legacyStyleSheet) {
+        applyLegacyStyleSheet(theme);
+    } else {
+        // One style for both themes; the native styles ignore parts of the palette
+        if (!m_applied) {
+            QApplication::setStyle(QStyleFactory::create(QStringLiteral("Fusion")));
+        }
+        QApplication::setPalette(theme == DarkTheme ? darkPalette() : QApplication::style()->standardPalette());
+    }
+    m_applied = true;
+
+    emit themeChanged();
+
+    // Polish and layout requests queued by the switch run on the next turn
+    QTimer::singleShot(0, this, [timer]() {
+        const double settledMs = timer.nsecsElapsed() / 1000000.0;
+        FeedMetrics::instance().recordDuration(FeedMetrics::AppScope, FeedMetrics::StageThemeApply, settledMs);
+    });
+}
+
+void ThemeManager::applyLegacyStyleSheet(Theme theme)
+{
+    if (theme == LightTheme) {
+        qApp->setStyleSheet(QString());
+        return;
+    }
+
+    QFile file(QStringLiteral(":/styles/dark.qss"));
+    if (file.open(QFile::ReadOnly | QFile::Text)) {
+        qApp->setStyleSheet(QString::fromUtf8(file.readAll()));
+    }
+}
+
+QPalette ThemeManager::darkPalette()
+{
+    // The colours of the former dark.qss
+    const QColor window(0x1E, 0x1E, 0x1E);
+    const QColor base(0x25, 0x25, 0x26);
+    const QColor alternateBase(0x2A, 0x2A, 0x2A);
+    const QColor button(0x2D, 0x2D, 0x30);
+    const QColor border(0x3E, 0x3E, 0x42);
+    const QColor text(0xF8, 0xF8, 0xF8);
+    const QColor disabledText(0x65, 0x65, 0x65);
+    const QColor highlight(0x00, 0x78, 0xD7);
+
+    QPalette palette;
+    palette.setColor(QPalette::Window, window);
+    palette.setColor(QPalette::WindowText, text);
+    palette.setColor(QPalette::Base, base);
+    palette.setColor(QPalette::AlternateBase, alternateBase);
+    palette.setColor(QPalette::ToolTipBase, button);
+    palette.setColor(QPalette::ToolTipText, text);
+    palette.setColor(QPalette::Text, text);
+    palette.setColor(QPalette::Button, button);
+    palette.setColor(QPalette::ButtonText, text);
+    palette.setColor(QPalette::BrightText, Qt::white);
+    palette.setColor(QPalette::Light, border.lighter(130));
+    palette.setColor(QPalette::Midlight, border);
+    palette.setColor(QPalette::Mid, button);
+    palette.setColor(QPalette::Dark, window.darker(130));
+    palette.setColor(QPalette::Shadow, Qt::black);
+    palette.setColor(QPalette::Highlight, highlight);
+    palette.setColor(QPalette::HighlightedText, Qt::white);
+    palette.setColor(QPalette::Link, QColor(0x37, 0x94, 0xFF));
+    palette.setColor(QPalette::LinkVisited, QColor(0x9C, 0x7F, 0xE0));
+
+    palette.setColor(QPalette::Disabled, QPalette::WindowText, disabledText);
+    palette.setColor(QPalette::Disabled, QPalette::Text, disabledText);
+    palette.setColor(QPalette::Disabled, QPalette::ButtonText, disabledText);
+    palette.setColor(QPalette::Disabled, QPalette::Highlight, border);
+    return palette;
+}
+
+QColor ThemeManager::accentColor() const
+{
+    return m_theme == DarkTheme ? QColor(0x00, 0x78, 0xD7) : QColor(41, 128, 185);
+}
+
+QColor ThemeManager::hoverColor() const
+{
+    return m_theme == DarkTheme ? QColor(0x3E, 0x3E, 0x42) : QColor(240, 240, 240);
+}
+
+QColor ThemeManager::mutedTextColor() const
+{
+    return m_theme == DarkTheme ? QColor(0xA0, 0xA0, 0xA0) : QColor(120, 120, 120);
+}
+
+QString ThemeManager::statusBarStyleSheet() const
+{
+    if (m_theme == LightTheme) {
+        return QString();
+    }
+    return QStringLiteral("QStatusBar { background-color: %1; color: white; }").arg(accentColor().name());
+}
+
+QString ThemeManager::articleStyleSheet() const
+{
+    const QPalette palette = QApplication::palette();
+    return QStringLiteral(
+        "body { font-family: Arial, sans-serif; margin: 0; padding: 10px; color: %1; }"
+        "h1 { font-size: 20px; color: %1; margin-top: 0; }"
+        ".meta { color: %2; font-size: 12px; margin-bottom: 15px; }"
+        ".content { line-height: 1.5; }"
+        "a { color: %3; text-decoration: none; }"
+        "img { max-width: 100%; height: auto; margin: 10px 0; }")
+        .arg(palette.color(QPalette::Text).name(),
+             mutedTextColor().name(),
+             palette.color(QPalette::Link).name());
+}
\ No newline at end of file
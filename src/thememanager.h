@@ -0,0 +1,50 @@
+#ifndef THEMEMANAGER_H
+#define THEMEMANAGER_H
+
+#include <QObject>
+#include <QPalette>
+#include <QColor>
+#include <QString>
+
+// Application look, carried by a QPalette on the Fusion style. Style sheets
+// are limited to the widgets that need one, so a theme switch sends palette
+// change events instead of re-polishing every widget. Colours without a
+// palette role are kept here for the item delegate and the article view.
+class ThemeManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Theme { LightTheme, DarkTheme };
+
+    static ThemeManager &instance();
+
+    void apply(Theme theme);
+    Theme theme() const { return m_theme; }
+
+    QColor accentColor() const;    // unread marker, links, status bar
+    QColor hoverColor() const;     // hovered list rows
+    QColor mutedTextColor() const; // dates and other secondary text
+
+    // Targeted style sheets, set on single widgets
+    QString statusBarStyleSheet() const;
+
+    // Default CSS of the article HTML in the detail view
+    QString articleStyleSheet() const;
+
+signals:
+    void themeChanged();
+
+private:
+    ThemeManager();
+    Q_DISABLE_COPY(ThemeManager)
+
+    Theme m_theme;
+    bool m_applied;
+    bool m_legacyStyleSheet; // the old application-wide dark.qss, kept for comparison
+
+    static QPalette darkPalette();
+    void applyLegacyStyleSheet(Theme theme);
+};
+
+#endif // THEMEMANAGER_H
\ No newline at end of file
@@ -0,0 +1,7 @@
+include(../../tests.pri)
+
+TARGET = tst_alertengine
+
+SOURCES += \
+    tst_alertengine.cpp \
+    $$SRC_DIR/alertengine.cpp
\ No newline at end of file
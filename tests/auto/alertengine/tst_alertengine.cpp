@@ -0,0 +1,116 @@
+#include <QtTest>
+
+#include "alertengine.h"
+
+// The keywords of every rule share one automaton. A keyword matches
+// case-insensitively where a word starts, including keywords that end
+// inside a longer one (reached through failure links), and each rule is
+// reported once per text and then throttled.
+class tst_AlertEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+    void match_data();
+    void match();
+    void throttle();
+    void parseRules();
+    void formatRoundTrip();
+};
+
+static QList<AlertRule> rules()
+{
+    return {
+        { QStringLiteral("Incidents"), { QStringLiteral("crash"), QStringLiteral("red flag") } },
+        { QStringLiteral("Weather"), { QStringLiteral(" Rain ") } },
+        { QStringLiteral("Safety car"), { QStringLiteral("safety car") } },
+        { QStringLiteral("Cars"), { QStringLiteral("car") } },
+        { QStringLiteral("Perez"), { QString::fromUtf8("P\xC3\xA9rez") } }
+    };
+}
+
+void tst_AlertEngine::empty()
+{
+    AlertEngine engine;
+    QVERIFY(engine.isEmpty());
+    QVERIFY(engine.match(QStringLiteral("crash")).isEmpty());
+
+    // Rules without usable keywords compile to nothing
+    engine.setRules({ { QStringLiteral("Blank"), { QStringLiteral("  "), QString() } } });
+    QVERIFY(engine.isEmpty());
+    QVERIFY(engine.evaluate(QStringLiteral("anything"), 0).isEmpty());
+}
+
+void tst_AlertEngine::match_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QVector<int>>("matched");
+
+    QTest::newRow("no match") << "Qualifying report from Suzuka" << QVector<int>();
+    QTest::newRow("case") << "CRASH at turn one" << QVector<int>{ 0 };
+    QTest::newRow("word prefix") << "Two crashes in practice" << QVector<int>{ 0 };
+    QTest::newRow("inside a word") << "Aircrash investigation" << QVector<int>();
+    QTest::newRow("trimmed keyword") << "Rain expected on Sunday" << QVector<int>{ 1 };
+    QTest::newRow("phrase") << "Red flag after heavy rain" << QVector<int>{ 0, 1 };
+    QTest::newRow("once per rule") << "Crash, then another crash, then a red flag" << QVector<int>{ 0 };
+
+    // "car" ends inside "safety car" and is found through its failure link
+    QTest::newRow("suffix keyword") << "Safety car deployed" << QVector<int>{ 2, 3 };
+    QTest::newRow("suffix not at word start") << "Sidecar race" << QVector<int>();
+    QTest::newRow("non-ASCII case") << QString::fromUtf8("P\xC3\x89REZ on pole") << QVector<int>{ 4 };
+}
+
+void tst_AlertEngine::match()
+{
+    QFETCH(QString, text);
+    QFETCH(QVector<int>, matched);
+
+    AlertEngine engine;
+    engine.setRules(rules());
+    QVERIFY(!engine.isEmpty());
+    QCOMPARE(engine.match(text), matched);
+}
+
+void tst_AlertEngine::throttle()
+{
+    AlertEngine engine;
+    engine.setRules(rules());
+    engine.setThrottleSecs(600);
+
+    const QString text = QStringLiteral("Crash in the rain");
+    QCOMPARE(engine.evaluate(text, 1000), (QStringList{ "Incidents", "Weather" }));
+    QVERIFY(engine.evaluate(text, 1599).isEmpty());
+
+    // Rules are throttled on their own
+    QCOMPARE(engine.evaluate(QStringLiteral("Safety car"), 1599), (QStringList{ "Safety car", "Cars" }));
+    QCOMPARE(engine.evaluate(text, 1600), (QStringList{ "Incidents", "Weather" }));
+}
+
+void tst_AlertEngine::parseRules()
+{
+    const QList<AlertRule> parsed = AlertEngine::parseRules(
+        QStringLiteral("Incidents: crash, red flag,\n\nrain\nNo keywords:\n  : orphan\n"));
+    QCOMPARE(parsed.size(), 2);
+    QCOMPARE(parsed.at(0).name, QStringLiteral("Incidents"));
+    QCOMPARE(parsed.at(0).keywords, (QStringList{ "crash", "red flag" }));
+
+    // Without a name the keywords name the rule
+    QCOMPARE(parsed.at(1).name, QStringLiteral("rain"));
+    QCOMPARE(parsed.at(1).keywords, QStringList{ "rain" });
+}
+
+void tst_AlertEngine::formatRoundTrip()
+{
+    const QList<AlertRule> original = rules().mid(0, 1) + rules().mid(2);
+    const QList<AlertRule> parsed = AlertEngine::parseRules(AlertEngine::formatRules(original));
+    QCOMPARE(parsed.size(), original.size());
+    for (int i = 0; i < parsed.size(); ++i) {
+        QCOMPARE(parsed.at(i).name, original.at(i).name);
+        QCOMPARE(parsed.at(i).keywords, original.at(i).keywords);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_AlertEngine)
+
+#include "tst_alertengine.moc"
\ No newline at end of file
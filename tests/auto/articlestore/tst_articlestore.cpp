@@ -0,0 +1,370 @@
+#include <QtTest>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include "articlestore.h"
+
+#include <algorithm>
+
+// The article database: a store written by the first schema migrates to
+// the current one with its articles, bodies and read state intact; feeds
+// page backwards over (pub_time, id) without gaps or repeats; the unread
+// counters follow every insert, read change and delete; and evicted
+// articles leave tombstones until they expire.
+class tst_ArticleStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void migrateFromVersion1();
+    void keysetPaging();
+    void unreadCounters();
+    void tombstones();
+    void searchFoldsCase();
+
+private:
+    QTemporaryDir *m_dir = nullptr;
+    ArticleStore *m_store = nullptr;
+
+    QString path() const { return m_dir->filePath(QStringLiteral("articles.sqlite")); }
+};
+
+static const char FeedA[] = "https://a.example.com/feed";
+static const char FeedB[] = "https://b.example.com/feed";
+
+// Titles of fewer than four words are never clustered by title, and every
+// item has its own link, so each item is a story of its own
+static FeedItem makeItem(const QString &guid, qint64 pubTime, bool read = false, const QString &link = QString())
+{
+    FeedItem item;
+    item.setGuid(guid);
+    item.title = QStringLiteral("Story ") + guid;
+    item.setLink(link.isEmpty() ? QStringLiteral("https://example.com/news/") + guid : link);
+    item.setDescription(QStringLiteral("<p>Body of ") + guid + QStringLiteral("</p>"));
+    item.pubTime = pubTime;
+    item.fetchTime = pubTime;
+    item.isRead = read;
+    return item;
+}
+
+static QStringList guids(const QList<FeedItem> &items)
+{
+    QStringList result;
+    for (const FeedItem &item : items) {
+        result.append(item.guid());
+    }
+    return result;
+}
+
+static QHash<QString, int> counts(std::initializer_list<QPair<QString, int>> values)
+{
+    QHash<QString, int> result;
+    for (const auto &value : values) {
+        result.insert(value.first, value.second);
+    }
+    return result;
+}
+
+// Runs statements on a connection of its own, closed before returning
+static bool execOn(const QString &path, const QStringList &statements)
+{
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("fixture"));
+        db.setDatabaseName(path);
+        ok = db.open();
+        QSqlQuery query(db);
+        for (int i = 0; ok && i < statements.size(); ++i) {
+            ok = query.exec(statements.at(i));
+            if (!ok) {
+                qWarning() << statements.at(i) << query.lastError().text();
+            }
+        }
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("fixture"));
+    return ok;
+}
+
+static qint64 pragmaOn(const QString &path, const QString &pragma)
+{
+    qint64 value = -1;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("fixture"));
+        db.setDatabaseName(path);
+        if (db.open()) {
+            QSqlQuery query(db);
+            if (query.exec(QStringLiteral("PRAGMA ") + pragma) && query.next()) {
+                value = query.value(0).toLongLong();
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("fixture"));
+    return value;
+}
+
+void tst_ArticleStore::init()
+{
+    m_dir = new QTemporaryDir;
+    QVERIFY(m_dir->isValid());
+    m_store = new ArticleStore;
+}
+
+void tst_ArticleStore::cleanup()
+{
+    delete m_store;
+    m_store = nullptr;
+    delete m_dir;
+    m_dir = nullptr;
+}
+
+void tst_ArticleStore::migrateFromVersion1()
+{
+    // The first schema: bodies in the article rows, no summaries, stories,
+    // counters or tombstones. Two feeds carry the same link.
+    QVERIFY(execOn(path(), {
+        "CREATE TABLE feeds (url TEXT PRIMARY KEY, etag TEXT, last_modified TEXT, last_update INTEGER)",
+        "CREATE TABLE articles (id INTEGER PRIMARY KEY, feed_url TEXT NOT NULL, guid TEXT NOT NULL, title TEXT,"
+        " link TEXT, description TEXT, pub_date TEXT, pub_time INTEGER NOT NULL DEFAULT 0, image_url TEXT,"
+        " category TEXT, is_read INTEGER NOT NULL DEFAULT 0, fetch_time INTEGER NOT NULL)",
+        "CREATE UNIQUE INDEX idx_articles_feed_guid ON articles(feed_url, guid)",
+        "CREATE INDEX idx_articles_guid ON articles(guid)",
+        "CREATE INDEX idx_articles_feed_pub ON articles(feed_url, pub_time)",
+        "CREATE INDEX idx_articles_feed_read ON articles(feed_url, is_read)",
+        "INSERT INTO feeds (url, etag, last_update) VALUES ('https://a.example.com/feed', '\"abc\"', 1700000000)",
+        "INSERT INTO articles (feed_url, guid, title, link, description, pub_time, image_url, category, is_read,"
+        " fetch_time) VALUES ('https://a.example.com/feed', 'a1', 'Alpha one', 'https://example.com/shared',"
+        " '<p>Shared <b>story</b> <a href=\"https://example.com/ref\">ref</a>"
+        " <img src=\"https://cdn.example.com/s.jpg\"></p>', 1000, '', 'Formula 1', 0, 1000)",
+        "INSERT INTO articles (feed_url, guid, title, link, description, pub_time, image_url, category, is_read,"
+        " fetch_time) VALUES ('https://a.example.com/feed', 'a2', 'Alpha two', 'https://example.com/a2',"
+        " '<p>Second</p>', 2000, 'https://cdn.example.com/own.jpg', 'MotoGP', 1, 2000)",
+        "INSERT INTO articles (feed_url, guid, title, link, description, pub_time, image_url, category, is_read,"
+        " fetch_time) VALUES ('https://b.example.com/feed', 'b1', 'Bravo one', 'https://www.example.com/shared/',"
+        " '', 1500, '', 'Formula 1', 0, 1500)",
+        "PRAGMA user_version = 1"
+    }));
+
+    {
+        ArticleStore store;
+        QVERIFY(store.open(path()));
+
+        // Summaries are backfilled from the bodies; an image of its own is kept
+        const QList<FeedItem> items = store.loadItems(FeedA);
+        QCOMPARE(guids(items), (QStringList{ "a1", "a2" }));
+        QCOMPARE(items.at(0).snippet(), QStringLiteral("Shared story ref"));
+        QCOMPARE(items.at(0).wordCount, 3u);
+        QCOMPARE(items.at(0).imageUrl(), QStringLiteral("https://cdn.example.com/s.jpg"));
+        QCOMPARE(items.at(0).categories(), QStringList{ "Formula 1" });
+        QVERIFY(!items.at(0).isRead);
+        QCOMPARE(items.at(1).snippet(), QStringLiteral("Second"));
+        QCOMPARE(items.at(1).imageUrl(), QStringLiteral("https://cdn.example.com/own.jpg"));
+        QVERIFY(items.at(1).isRead);
+
+        // Both copies of the shared link are one story holding the body
+        const QString body = store.loadDescription(FeedA, QStringLiteral("a1"));
+        QVERIFY(body.startsWith(QStringLiteral("<p>Shared <b>story</b>")));
+        QCOMPARE(store.loadDescription(FeedB, QStringLiteral("b1")), body);
+        QStringList sources = store.storySources(FeedA, QStringLiteral("a1"));
+        std::sort(sources.begin(), sources.end());
+        QCOMPARE(sources, (QStringList{ FeedA, FeedB }));
+
+        // Counters are counted once, validators survive
+        QCOMPARE(store.unreadCounts(), counts({ { FeedA, 1 }, { FeedB, 1 } }));
+        const FeedMeta meta = store.feedMeta(FeedA);
+        QCOMPARE(meta.etag, QStringLiteral("\"abc\""));
+        QCOMPARE(meta.lastUpdate, QDateTime::fromSecsSinceEpoch(1700000000));
+
+        // The triggers of the later versions are in place
+        RetentionPolicy policy;
+        policy.maxAgeDays = 0;
+        policy.maxItemsPerFeed = 1;
+        policy.maxTotalBytes = 0;
+        QCOMPARE(store.prune(FeedA, policy), 1);
+        QVERIFY(store.containsItem(FeedA, QStringLiteral("a1")));
+        QCOMPARE(store.itemCount(FeedA), 1);
+        QCOMPARE(store.unreadCounts(), counts({ { FeedB, 1 } }));
+        QCOMPARE(store.loadDescription(FeedB, QStringLiteral("b1")), body);
+    }
+
+    QCOMPARE(pragmaOn(path(), QStringLiteral("user_version")), qint64(6));
+    QCOMPARE(pragmaOn(path(), QStringLiteral("auto_vacuum")), qint64(2)); // incremental
+}
+
+void tst_ArticleStore::keysetPaging()
+{
+    QVERIFY(m_store->open(path()));
+
+    // Pairs of items share a publish time, so pages must break ties by id
+    const qint64 base = QDateTime::currentSecsSinceEpoch() - 3600;
+    QList<FeedItem> itemsA;
+    QList<FeedItem> itemsB;
+    QStringList newestFirst;
+    for (int i = 0; i < 25; ++i) {
+        const QString guid = QStringLiteral("a%1").arg(i, 2, 10, QLatin1Char('0'));
+        itemsA.append(makeItem(guid, base + (i / 2) * 60));
+        itemsB.append(makeItem(QStringLiteral("b%1").arg(i, 2, 10, QLatin1Char('0')), base + i * 30 + 15));
+        newestFirst.prepend(guid);
+    }
+    QVERIFY(m_store->insertItems(FeedA, itemsA));
+    QVERIFY(m_store->insertItems(FeedB, itemsB));
+
+    // The newest page comes back oldest first, as it is shown
+    ItemCursor cursor;
+    QList<FeedItem> page = m_store->loadItems(FeedA, 10, &cursor);
+    QCOMPARE(page.size(), 10);
+    QVERIFY(!cursor.atEnd);
+    QCOMPARE(page.first().feedUrl(), QString(FeedA));
+    QStringList seen = guids(page);
+    std::reverse(seen.begin(), seen.end());
+
+    page = m_store->loadItemsBefore(FeedA, &cursor, 10);
+    QCOMPARE(page.size(), 10);
+    QVERIFY(!cursor.atEnd);
+    seen += guids(page);
+
+    page = m_store->loadItemsBefore(FeedA, &cursor, 10);
+    QCOMPARE(page.size(), 5);
+    QVERIFY(cursor.atEnd);
+    seen += guids(page);
+
+    QCOMPARE(seen, newestFirst);
+    QVERIFY(m_store->loadItemsBefore(FeedA, &cursor, 10).isEmpty());
+
+    // A short feed fits on the first page
+    page = m_store->loadItems(FeedB, 50, &cursor);
+    QCOMPARE(page.size(), 25);
+    QVERIFY(cursor.atEnd);
+}
+
+void tst_ArticleStore::unreadCounters()
+{
+    QVERIFY(m_store->open(path()));
+    QVERIFY(m_store->unreadCounts().isEmpty());
+
+    const qint64 base = QDateTime::currentSecsSinceEpoch() - 3600;
+    const QString shared = QStringLiteral("https://example.com/news/shared");
+    QVERIFY(m_store->insertItems(FeedA, { makeItem("a1", base + 3, false, shared), makeItem("a2", base + 2),
+                                          makeItem("a3", base + 1, true) }));
+    QVERIFY(m_store->insertItems(FeedB, { makeItem("b1", base, false, shared) }));
+    QCOMPARE(m_store->unreadCounts(), counts({ { FeedA, 2 }, { FeedB, 1 } }));
+
+    // A duplicate is not inserted and not counted
+    QVERIFY(m_store->insertItems(FeedA, { makeItem("a2", base + 2) }));
+    QCOMPARE(m_store->unreadCounts(), counts({ { FeedA, 2 }, { FeedB, 1 } }));
+
+    // Only real changes of the read state count
+    QVERIFY(m_store->setRead(FeedA, QStringLiteral("a2")));
+    QCOMPARE(m_store->unreadCounts(), counts({ { FeedA, 1 }, { FeedB, 1 } }));
+    QVERIFY(m_store->setRead(FeedA, QStringLiteral("a2")));
+    QCOMPARE(m_store->unreadCounts(), counts({ { FeedA, 1 }, { FeedB, 1 } }));
+
+    // The shared story is read in both feeds; feeds without unread are left out
+    QVERIFY(m_store->setRead(FeedA, QStringLiteral("a1")));
+    QVERIFY(m_store->unreadCounts().isEmpty());
+    QVERIFY(m_store->setRead(FeedB, QStringLiteral("b1"), false));
+    QCOMPARE(m_store->unreadCounts(), counts({ { FeedA, 1 }, { FeedB, 1 } }));
+
+    ArticleKey a2 = { FeedA, "a2" };
+    ArticleKey a3 = { FeedA, "a3" };
+    QVERIFY(m_store->setRead({ a2, a3 }, false));
+    QCOMPARE(m_store->unreadCounts(), counts({ { FeedA, 3 }, { FeedB, 1 } }));
+
+    // Deleting unread articles counts down
+    RetentionPolicy policy;
+    policy.maxAgeDays = 0;
+    policy.maxItemsPerFeed = 1;
+    policy.maxTotalBytes = 0;
+    QCOMPARE(m_store->prune(FeedA, policy), 2);
+    QCOMPARE(m_store->unreadCounts(), counts({ { FeedA, 1 }, { FeedB, 1 } }));
+
+    QVERIFY(m_store->clear());
+    QVERIFY(m_store->unreadCounts().isEmpty());
+}
+
+void tst_ArticleStore::tombstones()
+{
+    QVERIFY(m_store->open(path()));
+
+    const qint64 base = QDateTime::currentSecsSinceEpoch() - 3600;
+    QList<FeedItem> items;
+    for (int i = 0; i < 5; ++i) {
+        items.append(makeItem(QStringLiteral("g%1").arg(i), base + i * 60));
+    }
+    QVERIFY(m_store->insertItems(FeedA, items));
+
+    RetentionPolicy policy;
+    policy.maxAgeDays = 0;
+    policy.maxItemsPerFeed = 2;
+    policy.maxTotalBytes = 0;
+    QList<ArticleKey> evicted;
+    QCOMPARE(m_store->prune(FeedA, policy, &evicted), 3);
+    QCOMPARE(m_store->itemCount(FeedA), 2);
+
+    // Every removed article is reported, the oldest ones
+    QStringList evictedGuids;
+    for (const ArticleKey &key : qAsConst(evicted)) {
+        QCOMPARE(key.feedUrl, QString(FeedA));
+        evictedGuids.append(QString::fromUtf8(key.guid));
+    }
+    std::sort(evictedGuids.begin(), evictedGuids.end());
+    QCOMPARE(evictedGuids, (QStringList{ "g0", "g1", "g2" }));
+
+    // Evicted articles are still known to their own feed only
+    QVERIFY(m_store->containsItem(FeedA, QStringLiteral("g0")));
+    QVERIFY(m_store->containsItem(FeedA, QStringLiteral("g4")));
+    QVERIFY(!m_store->containsItem(FeedB, QStringLiteral("g0")));
+    QVERIFY(!m_store->containsItem(FeedA, QStringLiteral("never stored")));
+    QCOMPARE(m_store->loadItems(FeedA).size(), 2);
+
+    // The eviction log is emptied after each report
+    evicted.clear();
+    QCOMPARE(m_store->prune(FeedA, policy, &evicted), 0);
+    QVERIFY(evicted.isEmpty());
+
+    // Tombstones older than the retention window are dropped on the next prune
+    QVERIFY(execOn(path(), { "UPDATE evicted_guids SET evicted_at = 0 WHERE guid = 'g0'" }));
+    m_store->prune(FeedA, policy);
+    QVERIFY(!m_store->containsItem(FeedA, QStringLiteral("g0")));
+    QVERIFY(m_store->containsItem(FeedA, QStringLiteral("g1")));
+
+    // Clearing the store forgets them all
+    QVERIFY(m_store->clear());
+    QVERIFY(!m_store->containsItem(FeedA, QStringLiteral("g1")));
+    QCOMPARE(m_store->itemCount(FeedA), 0);
+}
+
+void tst_ArticleStore::searchFoldsCase()
+{
+    QVERIFY(m_store->open(path()));
+
+    FeedItem accented = makeItem(QStringLiteral("p1"), 3000);
+    accented.title = QString::fromUtf8("Pole for P\xC3\xA9rez");
+    FeedItem upper = makeItem(QStringLiteral("p2"), 2000);
+    upper.title = QString::fromUtf8("P\xC3\x89REZ wins");
+    FeedItem plain = makeItem(QStringLiteral("p3"), 1000);
+    plain.title = QStringLiteral("Perez wins");
+    FeedItem underscore = makeItem(QStringLiteral("p4"), 500);
+    underscore.title = QStringLiteral("car_42 on track");
+    QVERIFY(m_store->insertItems(FeedA, { accented, upper, plain, underscore }));
+
+    // Non-ASCII letters match in either case, and only themselves
+    const QString lower = QString::fromUtf8("p\xC3\xA9rez");
+    QCOMPARE(m_store->searchItems(FeedA, lower), (QSet<QByteArray>{ "p1", "p2" }));
+    QCOMPARE(m_store->searchItems(FeedA, QStringLiteral("PEREZ")), QSet<QByteArray>{ "p3" });
+    QCOMPARE(guids(m_store->searchArticles(QString(), lower)), (QStringList{ "p1", "p2" }));
+    QCOMPARE(guids(m_store->searchArticles(FeedA, lower.toUpper(), 1)), QStringList{ "p1" });
+
+    // LIKE wildcards in the text are literal
+    QCOMPARE(m_store->searchItems(FeedA, QStringLiteral("R_4")), QSet<QByteArray>{ "p4" });
+    QVERIFY(m_store->searchItems(FeedA, QStringLiteral("r%4")).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(tst_ArticleStore)
+
+#include "tst_articlestore.moc"
\ No newline at end of file
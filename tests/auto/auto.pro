@@ -0,0 +1,12 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    alertengine \
+    articlestore \
+    bytescanner \
+    feeditem \
+    feeditemdelegate \
+    feedreaders \
+    feedrecovery \
+    htmlscanner \
+    localapiserver
\ No newline at end of file
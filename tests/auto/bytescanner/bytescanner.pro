@@ -0,0 +1,7 @@
+include(../../tests.pri)
+
+TARGET = tst_bytescanner
+
+SOURCES += \
+    tst_bytescanner.cpp \
+    $$SRC_DIR/bytescanner.cpp
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include <QtTest>
+
+#include "bytescanner.h"
+
+// Every kernel must return exactly what the scalar loop returns. The vector
+// kernels only differ in how they reach the tail: a full block, then a
+// scalar remainder, so the cases below put the needle in the last byte of
+// every tail length a 16 or 32 byte block can leave.
+class tst_ByteScanner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void needleInLastByte_data();
+    void needleInLastByte();
+    void noNeedle_data();
+    void noNeedle();
+    void agreesWithScalar_data();
+    void agreesWithScalar();
+    void unsupportedKernelIgnored();
+
+private:
+    static void addKernels();
+    static const char *find(int needles, const char *p, const char *end);
+    static const char *findReference(int needles, const char *p, const char *end);
+};
+
+// Needles include bytes with the high bit set, which are negative as char
+static const char Needles[] = { '<', '&', '\xE2', '\x80' };
+static const int MaxLength = 2 * 32 + 32; // two AVX2 blocks and every tail
+
+void tst_ByteScanner::cleanup()
+{
+    ByteScanner::setKernel(ByteScanner::bestKernel());
+}
+
+void tst_ByteScanner::addKernels()
+{
+    QTest::addColumn<int>("kernel");
+    QTest::newRow("scalar") << int(ByteScanner::Scalar);
+    QTest::newRow("sse2") << int(ByteScanner::Sse2);
+    QTest::newRow("avx2") << int(ByteScanner::Avx2);
+}
+
+const char *tst_ByteScanner::find(int needles, const char *p, const char *end)
+{
+    switch (needles) {
+    case 2:
+        return ByteScanner::findFirstOf(p, end, Needles[0], Needles[1]);
+    case 3:
+        return ByteScanner::findFirstOf(p, end, Needles[0], Needles[1], Needles[2]);
+    default:
+        return ByteScanner::findFirstOf(p, end, Needles[0], Needles[1], Needles[2], Needles[3]);
+    }
+}
+
+const char *tst_ByteScanner::findReference(int needles, const char *p, const char *end)
+{
+    for (; p < end; ++p) {
+        for (int i = 0; i < needles; ++i) {
+            if (*p == Needles[i]) {
+                return p;
+            }
+        }
+    }
+    return end;
+}
+
+void tst_ByteScanner::needleInLastByte_data()
+{
+    addKernels();
+}
+
+void tst_ByteScanner::needleInLastByte()
+{
+    QFETCH(int, kernel);
+    if (!ByteScanner::isSupported(ByteScanner::Kernel(kernel))) {
+        QSKIP("Kernel not supported on this CPU");
+    }
+    ByteScanner::setKernel(ByteScanner::Kernel(kernel));
+
+    // Every start alignment within a block, every length up to two blocks
+    // plus a full tail, each needle of each overload in the last byte
+    QByteArray buffer(32 + MaxLength, 'x');
+    for (int offset = 0; offset < 32; ++offset) {
+        for (int length = 1; length <= MaxLength; ++length) {
+            for (int needles = 2; needles <= 4; ++needles) {
+                for (int n = 0; n < needles; ++n) {
+                    const char *begin = buffer.constData() + offset;
+                    const char *end = begin + length;
+                    buffer[offset + length - 1] = Needles[n];
+                    const char *found = find(needles, begin, end);
+                    buffer[offset + length - 1] = 'x';
+                    if (found != end - 1) {
+                        QFAIL(qPrintable(QString("offset %1, length %2, needle %3 of %4: found at %5")
+                                         .arg(offset).arg(length).arg(n).arg(needles).arg(found - begin)));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void tst_ByteScanner::noNeedle_data()
+{
+    addKernels();
+}
+
+void tst_ByteScanner::noNeedle()
+{
+    QFETCH(int, kernel);
+    if (!ByteScanner::isSupported(ByteScanner::Kernel(kernel))) {
+        QSKIP("Kernel not supported on this CPU");
+    }
+    ByteScanner::setKernel(ByteScanner::Kernel(kernel));
+
+    // A needle right past the end must not be found
+    QByteArray buffer(32 + MaxLength + 1, 'x');
+    for (int offset = 0; offset < 32; ++offset) {
+        for (int length = 0; length <= MaxLength; ++length) {
+            const char *begin = buffer.constData() + offset;
+            const char *end = begin + length;
+            buffer[offset + length] = Needles[0];
+            const char *found = find(4, begin, end);
+            buffer[offset + length] = 'x';
+            if (found != end) {
+                QFAIL(qPrintable(QString("offset %1, length %2: found at %3")
+                                 .arg(offset).arg(length).arg(found - begin)));
+            }
+        }
+    }
+}
+
+void tst_ByteScanner::agreesWithScalar_data()
+{
+    addKernels();
+}
+
+void tst_ByteScanner::agreesWithScalar()
+{
+    QFETCH(int, kernel);
+    if (!ByteScanner::isSupported(ByteScanner::Kernel(kernel))) {
+        QSKIP("Kernel not supported on this CPU");
+    }
+
+    // Random text with sparse needles, compared against the scalar kernel
+    // and a plain loop
+    QRandomGenerator random(20251011);
+    const char alphabet[] = "abcdefgh <&\xE2\x80\x99\n";
+    for (int round = 0; round < 2000; ++round) {
+        const int length = random.bounded(MaxLength * 4);
+        QByteArray text(length, Qt::Uninitialized);
+        for (int i = 0; i < length; ++i) {
+            text[i] = random.bounded(8) == 0 ? alphabet[random.bounded(int(sizeof(alphabet) - 1))] : 'a';
+        }
+        const int offset = length > 0 ? random.bounded(length) : 0;
+        const char *begin = text.constData() + offset;
+        const char *end = text.constData() + length;
+
+        for (int needles = 2; needles <= 4; ++needles) {
+            ByteScanner::setKernel(ByteScanner::Scalar);
+            const char *scalar = find(needles, begin, end);
+            ByteScanner::setKernel(ByteScanner::Kernel(kernel));
+            const char *found = find(needles, begin, end);
+            // Offsets, since QCOMPARE on char pointers compares strings
+            QCOMPARE(found - begin, scalar - begin);
+            QCOMPARE(found - begin, findReference(needles, begin, end) - begin);
+        }
+    }
+}
+
+void tst_ByteScanner::unsupportedKernelIgnored()
+{
+    ByteScanner::setKernel(ByteScanner::Scalar);
+    for (ByteScanner::Kernel kernel : { ByteScanner::Sse2, ByteScanner::Avx2 }) {
+        if (!ByteScanner::isSupported(kernel)) {
+            ByteScanner::setKernel(kernel);
+            QCOMPARE(ByteScanner::kernel(), ByteScanner::Scalar);
+        }
+    }
+    QVERIFY(ByteScanner::isSupported(ByteScanner::bestKernel()));
+}
+
+QTEST_APPLESS_MAIN(tst_ByteScanner)
+
+#include "tst_bytescanner.moc"
\ No newline at end of file
@@ -0,0 +1,8 @@
+include(../../tests.pri)
+
+TARGET = tst_feeditem
+
+SOURCES += \
+    tst_feeditem.cpp \
+    $$SRC_DIR/feeditem.cpp \
+    $$SRC_DIR/categoryindex.cpp
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include <QtTest>
+
+#include "feeditem.h"
+
+// Intern IDs are 16 bits wide: a full table must refuse new strings rather
+// than wrap around onto existing IDs. CompactUrl must give back the URL it
+// was given, whether or not the prefix could be interned.
+class tst_FeedItem : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void internEmpty();
+    void internStringRef();
+    void internOverflow();
+    void compactUrlRoundTrip_data();
+    void compactUrlRoundTrip();
+    void compactUrlSharesPrefix();
+    void itemUrls();
+    void compactUrlWithFullPrefixTable(); // fills the shared table, keep last
+};
+
+static void fill(InternTable &table)
+{
+    while (!table.isFull()) {
+        table.intern(QStringLiteral("value-%1").arg(table.size()));
+    }
+}
+
+void tst_FeedItem::internEmpty()
+{
+    InternTable table;
+    QCOMPARE(table.size(), 1);
+    QCOMPARE(table.intern(QString()), quint16(0));
+    QCOMPARE(table.intern(QStringLiteral("")), quint16(0));
+    QVERIFY(table.value(0).isEmpty());
+
+    // Unknown IDs read as the empty string
+    QVERIFY(table.value(42).isEmpty());
+}
+
+void tst_FeedItem::internStringRef()
+{
+    InternTable table;
+    const QString text = QStringLiteral("Formula 1, MotoGP");
+    const quint16 id = table.intern(text.leftRef(9));
+    QCOMPARE(id, quint16(1));
+    QCOMPARE(table.value(id), QStringLiteral("Formula 1"));
+    QCOMPARE(table.intern(QStringLiteral("Formula 1")), id);
+    QCOMPARE(table.intern(text.midRef(11)), quint16(2));
+    QCOMPARE(table.size(), 3);
+}
+
+void tst_FeedItem::internOverflow()
+{
+    InternTable table;
+    fill(table);
+
+    // IDs 1 to 0xFFFF are in use, each still mapping to its own string
+    QCOMPARE(table.size(), 0x10000);
+    QCOMPARE(table.value(1), QStringLiteral("value-1"));
+    QCOMPARE(table.value(0xFFFF), QStringLiteral("value-65535"));
+    QCOMPARE(table.intern(QStringLiteral("value-65535")), quint16(0xFFFF));
+
+    // New strings get the empty ID and are not added
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Intern table full"));
+    QCOMPARE(table.intern(QStringLiteral("one too many")), quint16(0));
+    const QString text = QStringLiteral("another one");
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Intern table full"));
+    QCOMPARE(table.intern(text.midRef(0)), quint16(0));
+    QCOMPARE(table.size(), 0x10000);
+    QCOMPARE(table.value(1), QStringLiteral("value-1"));
+
+    // Known strings still resolve
+    QCOMPARE(table.intern(QStringLiteral("value-1")), quint16(1));
+    QCOMPARE(table.intern(QStringLiteral("value-1").midRef(0)), quint16(1));
+}
+
+void tst_FeedItem::compactUrlRoundTrip_data()
+{
+    QTest::addColumn<QString>("url");
+    QTest::addColumn<bool>("interned");
+
+    QTest::newRow("empty") << QString() << false;
+    QTest::newRow("path") << "https://www.motorsport.com/f1/news/race-report/123456/" << true;
+    QTest::newRow("query and fragment") << "https://www.autosport.com/news?id=42&page=2#comments" << true;
+    QTest::newRow("host only") << "https://www.formula1.com" << true;
+    QTest::newRow("root") << "http://www.nascar.com/" << true;
+    QTest::newRow("port") << "http://localhost:8080/feed.xml" << true;
+    QTest::newRow("non-ASCII") << QString::fromUtf8("https://www.m\xC3\xBCller.de/n\xC3\xA9ws/\xE2\x80\x99") << true;
+    QTest::newRow("relative") << "/news/2025/10/article.html" << false;
+    QTest::newRow("no scheme") << "www.example.com/news" << false;
+    QTest::newRow("empty scheme") << "://www.example.com/news" << false;
+    QTest::newRow("mailto") << "mailto:press@example.com" << false;
+    QTest::newRow("guid") << "urn:uuid:1225c695-cfb8-4ebb-aaaa-80da344efa6a" << false;
+}
+
+void tst_FeedItem::compactUrlRoundTrip()
+{
+    QFETCH(QString, url);
+    QFETCH(bool, interned);
+
+    CompactUrl compact;
+    compact.assign(url);
+    QCOMPARE(compact.toString(), url);
+    QCOMPARE(compact.isEmpty(), url.isEmpty());
+    QCOMPARE(compact.prefixId != 0, interned);
+
+    // The same through a view into a larger string
+    const QString padded = QStringLiteral("<link>") + url + QStringLiteral("</link>");
+    CompactUrl fromRef;
+    fromRef.assign(padded.midRef(6, url.size()));
+    QCOMPARE(fromRef.toString(), url);
+    QCOMPARE(fromRef.prefixId, compact.prefixId);
+    QCOMPARE(fromRef.rest, compact.rest);
+}
+
+void tst_FeedItem::compactUrlSharesPrefix()
+{
+    CompactUrl first;
+    first.assign(QStringLiteral("https://www.wrc.com/en/news/rally-finland"));
+    CompactUrl second;
+    second.assign(QStringLiteral("https://www.wrc.com/en/news/rally-japan"));
+    QVERIFY(first.prefixId != 0);
+    QCOMPARE(second.prefixId, first.prefixId);
+    QCOMPARE(InternTable::urlPrefixes().value(first.prefixId), QStringLiteral("https://www.wrc.com"));
+    QCOMPARE(second.rest, QByteArray("/en/news/rally-japan"));
+}
+
+void tst_FeedItem::itemUrls()
+{
+    FeedItem item;
+    QVERIFY(!item.hasLink());
+    QVERIFY(!item.hasImageUrl());
+
+    const QString link = QStringLiteral("https://www.motogp.com/en/news/2025/10/12/sprint-report/1");
+    const QString image = QStringLiteral("https://photos.motogp.com/2025/10/12/sprint.jpg?w=800");
+    item.setLink(link);
+    item.setImageUrl(image);
+    QCOMPARE(item.link(), link);
+    QCOMPARE(item.imageUrl(), image);
+    QVERIFY(item.hasLink());
+    QVERIFY(item.hasImageUrl());
+
+    FeedItem copy = item;
+    QCOMPARE(copy.link(), link);
+    QCOMPARE(copy.imageUrl(), image);
+}
+
+void tst_FeedItem::compactUrlWithFullPrefixTable()
+{
+    CompactUrl known;
+    known.assign(QStringLiteral("https://www.indycar.com/news/1"));
+    QVERIFY(known.prefixId != 0);
+
+    InternTable &prefixes = InternTable::urlPrefixes();
+    fill(prefixes);
+
+    // A new host is kept whole in the remainder and still round-trips
+    const QString url = QStringLiteral("https://www.fiawec.com/en/news/2");
+    CompactUrl compact;
+    compact.assign(url);
+    QCOMPARE(compact.prefixId, quint16(0));
+    QCOMPARE(compact.toString(), url);
+
+    CompactUrl fromRef;
+    fromRef.assign(url.midRef(0));
+    QCOMPARE(fromRef.toString(), url);
+
+    // URLs interned before the table filled up still resolve
+    QCOMPARE(known.toString(), QStringLiteral("https://www.indycar.com/news/1"));
+}
+
+QTEST_APPLESS_MAIN(tst_FeedItem)
+
+#include "tst_feeditem.moc"
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include <QtTest>
+#include <QApplication>
+#include <QStandardItemModel>
+#include <QPainter>
+
+#include "feeditemdelegate.h"
+#include "rssfeedmodel.h"
+#include "thememanager.h"
+
+// The delegate keeps the laid-out QStaticText of each row. A row must be
+// laid out again after its data changes, after rows shift, and after the
+// font or the theme changes; otherwise the list paints stale text.
+class tst_FeedItemDelegate : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void paintCachesRow();
+    void dataChangeDropsRow();
+    void rowsInsertedDropFollowingRows();
+    void layoutChangeDropsAllRows();
+    void fontChangeDropsAllRows();
+    void themeChangeDropsAllRows();
+
+private:
+    QStandardItemModel *m_model = nullptr;
+    FeedItemDelegate *m_delegate = nullptr;
+
+    void addRow(const QString &title);
+    QImage paintRow(int row, const QFont &font = QFont());
+    int cachedRows() const;
+};
+
+static const int Width = 400;
+
+void tst_FeedItemDelegate::init()
+{
+    m_model = new QStandardItemModel(this);
+    for (int i = 0; i < 4; ++i) {
+        addRow(QStringLiteral("Title %1").arg(i));
+    }
+    m_delegate = new FeedItemDelegate(nullptr, this);
+    m_delegate->trackModel(m_model);
+}
+
+void tst_FeedItemDelegate::cleanup()
+{
+    delete m_delegate;
+    m_delegate = nullptr;
+    delete m_model;
+    m_model = nullptr;
+}
+
+void tst_FeedItemDelegate::addRow(const QString &title)
+{
+    QStandardItem *item = new QStandardItem;
+    item->setData(title, RssFeedModel::TitleRole);
+    item->setData(QStringLiteral("Formula 1"), RssFeedModel::CategoryRole);
+    item->setData(false, RssFeedModel::IsReadRole);
+    item->setData(qint64(1760000000), RssFeedModel::PubTimeRole);
+    m_model->appendRow(item);
+}
+
+QImage tst_FeedItemDelegate::paintRow(int row, const QFont &font)
+{
+    QImage image(Width, FeedItemDelegate::RowHeight, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QStyleOptionViewItem option;
+    option.rect = image.rect();
+    option.font = font;
+    option.palette = QApplication::palette();
+    option.state = QStyle::State_Enabled;
+
+    QPainter painter(&image);
+    m_delegate->paint(&painter, option, m_model->index(row, 0));
+    return image;
+}
+
+int tst_FeedItemDelegate::cachedRows() const
+{
+    int rows = 0;
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        rows += m_delegate->isRowCached(row) ? 1 : 0;
+    }
+    return rows;
+}
+
+void tst_FeedItemDelegate::paintCachesRow()
+{
+    QCOMPARE(cachedRows(), 0);
+    const QImage first = paintRow(1);
+    QVERIFY(m_delegate->isRowCached(1));
+    QCOMPARE(cachedRows(), 1);
+
+    // A cached row paints the same
+    QCOMPARE(paintRow(1), first);
+}
+
+void tst_FeedItemDelegate::dataChangeDropsRow()
+{
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        paintRow(row);
+    }
+    const QImage before = paintRow(2);
+
+    m_model->item(2)->setData(QStringLiteral("A different title"), RssFeedModel::TitleRole);
+    QVERIFY(!m_delegate->isRowCached(2));
+    QCOMPARE(cachedRows(), m_model->rowCount() - 1);
+
+    // The new title is painted, not the cached one
+    QVERIFY(paintRow(2) != before);
+
+    // So is the read state
+    const QImage unread = paintRow(3);
+    m_model->item(3)->setData(true, RssFeedModel::IsReadRole);
+    QVERIFY(!m_delegate->isRowCached(3));
+    QVERIFY(paintRow(3) != unread);
+}
+
+void tst_FeedItemDelegate::rowsInsertedDropFollowingRows()
+{
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        paintRow(row);
+    }
+    m_model->insertRow(2, new QStandardItem);
+    QVERIFY(m_delegate->isRowCached(0));
+    QVERIFY(m_delegate->isRowCached(1));
+    for (int row = 2; row < m_model->rowCount(); ++row) {
+        QVERIFY(!m_delegate->isRowCached(row));
+    }
+
+    paintRow(0);
+    paintRow(3);
+    m_model->removeRow(1);
+    QVERIFY(m_delegate->isRowCached(0));
+    QCOMPARE(cachedRows(), 1);
+}
+
+void tst_FeedItemDelegate::layoutChangeDropsAllRows()
+{
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        paintRow(row);
+    }
+    // Sorting moves rows through a layout change
+    m_model->sort(0, Qt::DescendingOrder);
+    QCOMPARE(cachedRows(), 0);
+}
+
+void tst_FeedItemDelegate::fontChangeDropsAllRows()
+{
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        paintRow(row);
+    }
+
+    // The delegate sets its own point sizes; other font changes carry over
+    QFont font;
+    font.setItalic(true);
+    paintRow(0, font);
+    QCOMPARE(cachedRows(), 1);
+    QVERIFY(m_delegate->isRowCached(0));
+}
+
+void tst_FeedItemDelegate::themeChangeDropsAllRows()
+{
+    ThemeManager &theme = ThemeManager::instance();
+    const ThemeManager::Theme previous = theme.theme();
+    theme.apply(ThemeManager::LightTheme);
+
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        paintRow(row);
+    }
+    QCOMPARE(cachedRows(), m_model->rowCount());
+
+    theme.apply(ThemeManager::DarkTheme);
+    QCOMPARE(cachedRows(), 0);
+
+    theme.apply(previous);
+}
+
+// Painting needs a QApplication; the offscreen platform works without a display
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    tst_FeedItemDelegate test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_feeditemdelegate.moc"
\ No newline at end of file
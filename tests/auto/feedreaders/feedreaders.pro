@@ -0,0 +1,25 @@
+include(../../tests.pri)
+
+TARGET = tst_feedreaders
+
+QT += network sql
+
+SOURCES += \
+    tst_feedreaders.cpp \
+    $$SRC_DIR/rssparser.cpp \
+    $$SRC_DIR/feedmetrics.cpp \
+    $$SRC_DIR/stallwatchdog.cpp \
+    $$SRC_DIR/articlestore.cpp \
+    $$SRC_DIR/feeditem.cpp \
+    $$SRC_DIR/feedrecovery.cpp \
+    $$SRC_DIR/htmlscanner.cpp \
+    $$SRC_DIR/bytescanner.cpp \
+    $$SRC_DIR/jsonfeedreader.cpp \
+    $$SRC_DIR/alertengine.cpp \
+    $$SRC_DIR/categoryindex.cpp \
+    $$SRC_DIR/storycluster.cpp \
+    $$SRC_DIR/savedsearch.cpp
+
+HEADERS += \
+    $$SRC_DIR/rssparser.h \
+    $$SRC_DIR/stallwatchdog.h
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include <QtTest>
+
+#include "jsonfeedreader.h"
+#include "rssparser.h"
+
+// JSON Feed and RSS 1.0 (RDF) documents. The JSON Feed pull reader must
+// map every field onto the RSS shaped item, skip keys it does not know
+// however deeply nested, decode escapes and stop on malformed input
+// without taking back the items it has delivered. Both formats must come
+// out of the parser's ingest path with their links, dates and categories.
+class tst_FeedReaders : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void jsonFeedFields();
+    void jsonFeedFallbacks();
+    void jsonFeedErrors_data();
+    void jsonFeedErrors();
+    void jsonFeedPartial();
+    void jsonFeedIngest();
+    void rdfIngest();
+
+private:
+    RssParser *m_parser = nullptr;
+
+    static QList<FeedItem> readJson(const QByteArray &data, bool *ok = nullptr, QString *error = nullptr);
+};
+
+static const char JsonFeed[] = R"json({
+  "version": "https://jsonfeed.org/version/1.1",
+  "title": "Example",
+  "_meta": { "nested": [1, 2.5e3, -4, true, false, null, { "deep": ["x", { "y": "}" }] }], "s": "a\"b" },
+  "authors": [{ "name": "Desk" }],
+  "items": [
+    {
+      "id": "https://example.com/news/1",
+      "url": "https://example.com/news/1",
+      "title": "Pole for P\u00e9rez \ud83c\udfc1",
+      "content_html": "<p>Lap of <b>1:29.7</b></p>",
+      "summary": "Not used when there is a body",
+      "image": "https://cdn.example.com/1.jpg",
+      "date_published": "2025-06-14T15:00:00Z",
+      "tags": ["Formula One", "Qualifying"],
+      "_ext": { "tags": ["not", "these"] }
+    },
+    {
+      "id": 42,
+      "external_url": "https://other.example.com/story",
+      "content_text": "Rain <heavy>\nRed flag",
+      "banner_image": "https://cdn.example.com/banner.jpg",
+      "date_modified": "2025-06-15T09:30:00+02:00",
+      "tags": "not a list"
+    },
+    { "id": "3", "title": "No link" }
+  ],
+  "next_url": "https://example.com/feed.json?page=2"
+})json";
+
+static const char RdfFeed[] = R"rdf(<?xml version="1.0" encoding="UTF-8"?>
+<!-- generated -->
+<rdf:RDF xmlns:rdf="http://www.w3.org/1999/02/22-rdf-syntax-ns#" xmlns="http://purl.org/rss/1.0/"
+         xmlns:dc="http://purl.org/dc/elements/1.1/" xmlns:content="http://purl.org/rss/1.0/modules/content/">
+  <channel rdf:about="https://example.com/">
+    <title>Channel title</title>
+    <link>https://example.com/</link>
+    <description>Channel description</description>
+    <items><rdf:Seq><rdf:li rdf:resource="https://example.com/news/1"/></rdf:Seq></items>
+  </channel>
+  <item rdf:about="https://example.com/news/1">
+    <title>Le Mans: Toyota on pole</title>
+    <link>https://example.com/news/1?utm=rss</link>
+    <description>Short</description>
+    <content:encoded><![CDATA[<p>Full <b>body</b></p>]]></content:encoded>
+    <dc:date>2025-06-14T15:00:00Z</dc:date>
+    <dc:subject>Endurance</dc:subject>
+    <dc:subject>Le Mans 24h</dc:subject>
+    <dc:subject>wec</dc:subject>
+  </item>
+  <item rdf:about="https://example.com/news/2">
+    <title>Second</title>
+    <link>https://example.com/news/2</link>
+    <description>Only &lt;b&gt;summary&lt;/b&gt;</description>
+  </item>
+</rdf:RDF>
+)rdf";
+
+QList<FeedItem> tst_FeedReaders::readJson(const QByteArray &data, bool *ok, QString *error)
+{
+    QList<FeedItem> items;
+    JsonFeedReader reader(data);
+    const bool read = reader.readItems([&items](FeedItem &item) {
+        items.append(item);
+    });
+    if (ok) {
+        *ok = read;
+    }
+    if (error) {
+        *error = reader.errorString();
+    }
+    return items;
+}
+
+void tst_FeedReaders::initTestCase()
+{
+    // The parser opens a store and reads settings; keep both out of the user's
+    QStandardPaths::setTestModeEnabled(true);
+    m_parser = new RssParser(this);
+}
+
+void tst_FeedReaders::cleanupTestCase()
+{
+    delete m_parser;
+    m_parser = nullptr;
+}
+
+void tst_FeedReaders::jsonFeedFields()
+{
+    bool ok = false;
+    QString error;
+    const QList<FeedItem> items = readJson(JsonFeed, &ok, &error);
+    QVERIFY2(ok, qPrintable(error));
+    QCOMPARE(items.size(), 3);
+
+    const FeedItem &item = items.at(0);
+    QCOMPARE(item.guid(), QStringLiteral("https://example.com/news/1"));
+    QCOMPARE(item.link(), QStringLiteral("https://example.com/news/1"));
+    QCOMPARE(item.title, QString::fromUtf8("Pole for P\xC3\xA9rez \xF0\x9F\x8F\x81"));
+    QCOMPARE(item.description(), QStringLiteral("<p>Lap of <b>1:29.7</b></p>"));
+    QCOMPARE(item.imageUrl(), QStringLiteral("https://cdn.example.com/1.jpg"));
+    QCOMPARE(item.pubDate, QStringLiteral("2025-06-14T15:00:00Z"));
+    // Tags are categories, series aliases under the series name
+    QCOMPARE(item.categories(), (QStringList{ "Formula 1", "Qualifying" }));
+}
+
+void tst_FeedReaders::jsonFeedFallbacks()
+{
+    const QList<FeedItem> items = readJson(JsonFeed);
+    QCOMPARE(items.size(), 3);
+
+    // Numeric id, external URL, banner image, modified date, text body
+    const FeedItem &item = items.at(1);
+    QCOMPARE(item.guid(), QStringLiteral("42"));
+    QCOMPARE(item.link(), QStringLiteral("https://other.example.com/story"));
+    QCOMPARE(item.title, QStringLiteral("Rain <heavy> Red flag"));
+    QCOMPARE(item.description(), QStringLiteral("<p>Rain &lt;heavy&gt;<br>Red flag</p>"));
+    QCOMPARE(item.imageUrl(), QStringLiteral("https://cdn.example.com/banner.jpg"));
+    QCOMPARE(item.pubDate, QStringLiteral("2025-06-15T09:30:00+02:00"));
+    QVERIFY(item.categories().isEmpty());
+
+    QCOMPARE(items.at(2).title, QStringLiteral("No link"));
+    QVERIFY(!items.at(2).hasLink());
+}
+
+void tst_FeedReaders::jsonFeedErrors_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QString>("error");
+
+    QTest::newRow("array") << QByteArray("[]") << "expected '{'";
+    QTest::newRow("no items") << QByteArray(R"({ "version": "1.1", "title": "No items" })") << "not a JSON Feed";
+    QTest::newRow("items not a list") << QByteArray(R"({ "items": {} })") << "expected '['";
+    QTest::newRow("bad escape") << QByteArray(R"({ "items": [{ "title": "a\qb" }] })") << "bad escape";
+    QTest::newRow("bad literal") << QByteArray(R"({ "x": nope, "items": [] })") << "bad literal";
+    QTest::newRow("unterminated") << QByteArray(R"({ "items": [{ "title": "open )") << "unterminated string";
+}
+
+void tst_FeedReaders::jsonFeedErrors()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QString, error);
+
+    bool ok = true;
+    QString message;
+    QVERIFY(readJson(data, &ok, &message).isEmpty());
+    QVERIFY(!ok);
+    QVERIFY2(message.startsWith(error), qPrintable(message));
+}
+
+void tst_FeedReaders::jsonFeedPartial()
+{
+    // A byte order mark is fine; the first item is kept when the second is cut off
+    const QByteArray data = "\xEF\xBB\xBF"
+                            R"({ "items": [{ "id": "1", "url": "https://example.com/1", "title": "One" },)"
+                            R"( { "id": "2", "title": "Tw)";
+    bool ok = true;
+    const QList<FeedItem> items = readJson(data, &ok);
+    QVERIFY(!ok);
+    QCOMPARE(items.size(), 1);
+    QCOMPARE(items.first().title, QStringLiteral("One"));
+}
+
+void tst_FeedReaders::jsonFeedIngest()
+{
+    QList<FeedItem> items;
+    QString error;
+    bool recovered = true;
+    QVERIFY2(m_parser->parseItems(QStringLiteral("test:json"), JsonFeed, "application/feed+json",
+                                  &items, &error, &recovered), qPrintable(error));
+    QVERIFY(!recovered);
+
+    // Items without a link are dropped
+    QCOMPARE(items.size(), 2);
+    QCOMPARE(items.at(0).guid(), QStringLiteral("https://example.com/news/1"));
+    QCOMPARE(items.at(0).pubTime, qint64(1749913200));
+    QCOMPARE(items.at(0).snippet(), QStringLiteral("Lap of 1:29.7"));
+    QCOMPARE(items.at(0).feedUrl(), QStringLiteral("test:json"));
+    QCOMPARE(items.at(1).guid(), QStringLiteral("42"));
+    QCOMPARE(items.at(1).pubTime, qint64(1749972600));
+    QCOMPARE(items.at(1).snippet(), QStringLiteral("Rain <heavy> Red flag"));
+}
+
+void tst_FeedReaders::rdfIngest()
+{
+    QList<FeedItem> items;
+    QString error;
+    bool recovered = true;
+    QVERIFY2(m_parser->parseItems(QStringLiteral("test:rdf"), RdfFeed, "text/xml", &items, &error, &recovered),
+             qPrintable(error));
+    QVERIFY(!recovered);
+
+    // The channel's title and link are not an item
+    QCOMPARE(items.size(), 2);
+
+    // rdf:about is the GUID; content:encoded wins over description
+    const FeedItem &item = items.at(0);
+    QCOMPARE(item.guid(), QStringLiteral("https://example.com/news/1"));
+    QCOMPARE(item.title, QStringLiteral("Le Mans: Toyota on pole"));
+    QCOMPARE(item.link(), QStringLiteral("https://example.com/news/1?utm=rss"));
+    QCOMPARE(item.description(), QStringLiteral("<p>Full <b>body</b></p>"));
+    QCOMPARE(item.snippet(), QStringLiteral("Full body"));
+    QCOMPARE(item.pubDate, QStringLiteral("2025-06-14T15:00:00Z"));
+    QCOMPARE(item.pubTime, qint64(1749913200));
+    QCOMPARE(item.categories(), (QStringList{ "WEC", "Le Mans 24h" }));
+
+    QCOMPARE(items.at(1).guid(), QStringLiteral("https://example.com/news/2"));
+    QCOMPARE(items.at(1).description(), QStringLiteral("Only <b>summary</b>"));
+    QCOMPARE(items.at(1).snippet(), QStringLiteral("Only summary"));
+    QCOMPARE(items.at(1).pubTime, qint64(0));
+}
+
+QTEST_GUILESS_MAIN(tst_FeedReaders)
+
+#include "tst_feedreaders.moc"
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <QtTest>
+
+#include "feedrecovery.h"
+#include "rssparser.h"
+
+// Feeds as servers really break them. Each payload must fail to parse as
+// it is, parse once FeedRecovery has repaired it, and come out of the
+// parser's ingest path with every item and the right text.
+class tst_FeedRecovery : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void repair_data();
+    void repair();
+    void parse_data();
+    void parse();
+    void wellFormedUntouched();
+
+private:
+    RssParser *m_parser = nullptr;
+
+    static void addPayloads();
+};
+
+static QByteArray item(const QByteArray &title, const QByteArray &link, const QByteArray &description = QByteArray())
+{
+    return "<item><title>" + title + "</title><link>" + link + "</link>"
+         + (description.isEmpty() ? QByteArray() : "<description>" + description + "</description>")
+         + "</item>";
+}
+
+static QByteArray feed(const QByteArray &items)
+{
+    return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<rss version=\"2.0\"><channel><title>Test</title>" + items + "</channel></rss>\n";
+}
+
+static bool isWellFormed(const QByteArray &data)
+{
+    QXmlStreamReader xml(data);
+    while (!xml.atEnd()) {
+        xml.readNext();
+    }
+    return !xml.hasError();
+}
+
+void tst_FeedRecovery::initTestCase()
+{
+    // The parser opens a store and reads settings; keep both out of the user's
+    QStandardPaths::setTestModeEnabled(true);
+    m_parser = new RssParser(this);
+}
+
+void tst_FeedRecovery::cleanupTestCase()
+{
+    delete m_parser;
+    m_parser = nullptr;
+}
+
+void tst_FeedRecovery::addPayloads()
+{
+    QTest::addColumn<QByteArray>("payload");
+    QTest::addColumn<QByteArray>("contentType");
+    QTest::addColumn<QString>("fix");
+    QTest::addColumn<QStringList>("titles");
+    QTest::addColumn<QString>("firstLink");
+
+    const QByteArray second = item("Second story", "https://example.com/news/2");
+
+    QTest::newRow("stray ampersand")
+        << feed(item("Hamilton & Russell lock out the front row", "https://example.com/news/1?id=1&ref=rss") + second)
+        << QByteArray("application/rss+xml")
+        << "unescaped ampersands"
+        << QStringList{ "Hamilton & Russell lock out the front row", "Second story" }
+        << "https://example.com/news/1?id=1&ref=rss";
+
+    QTest::newRow("unclosed CDATA")
+        << feed(item("Race report", "https://example.com/news/1", "<![CDATA[<p>Verstappen <b>wins</b> again</p>")
+                + second)
+        << QByteArray("application/rss+xml")
+        << "unclosed CDATA sections"
+        << QStringList{ "Race report", "Second story" }
+        << "https://example.com/news/1";
+
+    // Windows-1252 bytes in a document that declares UTF-8
+    QTest::newRow("codec mismatch")
+        << feed(item("Sergio P\xE9rez \x96 podium in Mexico", "https://example.com/news/1") + second)
+        << QByteArray("text/xml; charset=UTF-8")
+        << "encoding"
+        << QStringList{ QString::fromUtf8("Sergio P\xC3\xA9rez \xE2\x80\x93 podium in Mexico"), "Second story" }
+        << "https://example.com/news/1";
+
+    // A byte order mark, then a newline the server's template added
+    QTest::newRow("byte order mark")
+        << QByteArray("\xEF\xBB\xBF\n") + feed(item("Qualifying", "https://example.com/news/1") + second)
+        << QByteArray("application/rss+xml")
+        << "byte order mark"
+        << QStringList{ "Qualifying", "Second story" }
+        << "https://example.com/news/1";
+
+    // A PHP notice printed ahead of the document
+    QTest::newRow("junk before the root")
+        << QByteArray("Deprecated: function each() is deprecated in /var/www/rss.php on line 3\n")
+           + feed(item("Practice", "https://example.com/news/1") + second)
+        << QByteArray("application/rss+xml")
+        << "content outside the document"
+        << QStringList{ "Practice", "Second story" }
+        << "https://example.com/news/1";
+}
+
+void tst_FeedRecovery::repair_data()
+{
+    addPayloads();
+}
+
+void tst_FeedRecovery::repair()
+{
+    QFETCH(QByteArray, payload);
+    QFETCH(QByteArray, contentType);
+    QFETCH(QString, fix);
+
+    QVERIFY2(!isWellFormed(payload), "the payload must be malformed to begin with");
+
+    QStringList fixes;
+    const QByteArray repaired = FeedRecovery::repair(payload, contentType, &fixes);
+    QVERIFY2(isWellFormed(repaired), repaired.constData());
+
+    bool noted = false;
+    for (const QString &applied : qAsConst(fixes)) {
+        noted = noted || applied.startsWith(fix);
+    }
+    QVERIFY2(noted, qPrintable(fixes.join(", ")));
+}
+
+void tst_FeedRecovery::parse_data()
+{
+    addPayloads();
+}
+
+void tst_FeedRecovery::parse()
+{
+    QFETCH(QByteArray, payload);
+    QFETCH(QByteArray, contentType);
+    QFETCH(QStringList, titles);
+    QFETCH(QString, firstLink);
+
+    QList<FeedItem> items;
+    QString error;
+    bool recovered = false;
+    QVERIFY2(m_parser->parseItems(QStringLiteral("test:") + QTest::currentDataTag(), payload, contentType,
+                                  &items, &error, &recovered), qPrintable(error));
+    QVERIFY(recovered);
+
+    // Items read before the error are neither lost nor repeated
+    QStringList parsed;
+    for (const FeedItem &item : qAsConst(items)) {
+        parsed.append(item.title);
+    }
+    QCOMPARE(parsed, titles);
+    QCOMPARE(items.first().link(), firstLink);
+}
+
+void tst_FeedRecovery::wellFormedUntouched()
+{
+    const QByteArray payload = feed(item("Title &amp; more", "https://example.com/news/1",
+                                         "<![CDATA[<p>Body &nbsp; text</p>]]>"));
+    QVERIFY(isWellFormed(payload));
+
+    QList<FeedItem> items;
+    bool recovered = true;
+    QVERIFY(m_parser->parseItems(QStringLiteral("test:well-formed"), payload, QByteArray(), &items, nullptr,
+                                 &recovered));
+    QVERIFY(!recovered);
+    QCOMPARE(items.size(), 1);
+    QCOMPARE(items.first().title, QStringLiteral("Title & more"));
+    QCOMPARE(items.first().description(), QStringLiteral("<p>Body &nbsp; text</p>"));
+}
+
+QTEST_GUILESS_MAIN(tst_FeedRecovery)
+
+#include "tst_feedrecovery.moc"
\ No newline at end of file
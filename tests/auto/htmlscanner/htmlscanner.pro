@@ -0,0 +1,8 @@
+include(../../tests.pri)
+
+TARGET = tst_htmlscanner
+
+SOURCES += \
+    tst_htmlscanner.cpp \
+    $$SRC_DIR/htmlscanner.cpp \
+    $$SRC_DIR/bytescanner.cpp
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include <QtTest>
+
+#include "htmlscanner.h"
+
+// What ingest keeps of an item body: the snippet and word count with
+// entities decoded and script and style bodies left out, the lead image
+// (largest srcset candidate, lazy-load attributes, no tracking pixels) and
+// the outbound links.
+class tst_HtmlScanner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void scan_data();
+    void scan();
+    void snippetCutAtWord();
+    void plainText();
+    void entityCodePoint();
+};
+
+void tst_HtmlScanner::scan_data()
+{
+    QTest::addColumn<QString>("html");
+    QTest::addColumn<QString>("snippet");
+    QTest::addColumn<int>("wordCount");
+    QTest::addColumn<QString>("imageUrl");
+    QTest::addColumn<QStringList>("links");
+
+    QTest::newRow("empty") << QString() << QString() << 0 << QString() << QStringList();
+
+    // Named and numeric entities; unknown or unterminated ones stay as text
+    QTest::newRow("entities")
+        << "<p>Fish &amp; chips &lt;3 caf&eacute; &#233;&#xE9; a&nbsp;b &unknown; &amp</p>"
+        << QString::fromUtf8("Fish & chips <3 caf\xC3\xA9 \xC3\xA9\xC3\xA9 a b &unknown; &amp")
+        << 10 << QString() << QStringList();
+
+    QTest::newRow("script and style")
+        << "<p>Before</p><script type=\"text/javascript\">var s = '<p>not text</p>'; if (a < b) {}</script>"
+           "<STYLE>p { color: red; }</STYLE><p>After</p>"
+        << "Before After" << 2 << QString() << QStringList();
+    QTest::newRow("unclosed script")
+        << "<p>Kept</p><script>document.write('lost')"
+        << "Kept" << 1 << QString() << QStringList();
+    QTest::newRow("comment and CDATA")
+        << "<!-- hidden --><p>Shown</p><![CDATA[raw <b>text]]>"
+        << "Shown raw <b>text" << 3 << QString() << QStringList();
+
+    QTest::newRow("srcset width")
+        << "<p>Pic</p><img src=\"https://cdn.example.com/small.jpg\" srcset=\"https://cdn.example.com/a-480.jpg 480w, "
+           "https://cdn.example.com/a-1200.jpg 1200w, https://cdn.example.com/a-800.jpg 800w\">"
+        << "Pic" << 1 << "https://cdn.example.com/a-1200.jpg" << QStringList();
+    QTest::newRow("srcset density")
+        << "<img srcset=\"https://cdn.example.com/b.jpg 1x, https://cdn.example.com/b@2x.jpg 2x\">"
+        << QString() << 0 << "https://cdn.example.com/b@2x.jpg" << QStringList();
+    QTest::newRow("lazy loaded")
+        << "<img src=\"data:image/gif;base64,R0lGOD\" data-src=\"https://cdn.example.com/real.jpg\">"
+        << QString() << 0 << "https://cdn.example.com/real.jpg" << QStringList();
+    QTest::newRow("larger image later")
+        << "<img src=\"https://cdn.example.com/icon.png\" width=\"32\">"
+           "<img src=\"https://cdn.example.com/photo.jpg\" width=\"1024\">"
+        << QString() << 0 << "https://cdn.example.com/photo.jpg" << QStringList();
+
+    // Images of at most 2 pixels a side are trackers, never the lead image
+    QTest::newRow("tracking pixel first")
+        << "<img src=\"https://track.example.com/p.gif\" width=\"1\" height=\"1\">"
+           "<img src=\"https://cdn.example.com/lead.jpg\">"
+        << QString() << 0 << "https://cdn.example.com/lead.jpg" << QStringList();
+    QTest::newRow("tracking pixel only")
+        << "<p>Text</p><img src=\"https://track.example.com/p.gif\" width=\"1\" height=\"1\" />"
+        << "Text" << 1 << QString() << QStringList();
+
+    // Absolute http(s) links only, once each, entities in attributes decoded
+    QTest::newRow("links")
+        << "<p><a href=\"https://example.com/a?x=1&amp;y=2\">one</a> <a href='mailto:x@example.com'>mail</a> "
+           "<a href=\"/relative\">rel</a> <A HREF=\"HTTP://example.com/b\">two</A> "
+           "<a href=\"https://example.com/a?x=1&amp;y=2\">dup</a></p>"
+        << "one mail rel two dup" << 5 << QString()
+        << QStringList{ "https://example.com/a?x=1&y=2", "HTTP://example.com/b" };
+}
+
+void tst_HtmlScanner::scan()
+{
+    QFETCH(QString, html);
+    QFETCH(QString, snippet);
+    QFETCH(int, wordCount);
+    QFETCH(QString, imageUrl);
+    QFETCH(QStringList, links);
+
+    const HtmlSummary summary = HtmlScanner::scan(html);
+    QCOMPARE(summary.snippet, snippet);
+    QCOMPARE(summary.wordCount, wordCount);
+    QCOMPARE(summary.imageUrl, imageUrl);
+    QCOMPARE(summary.links, links);
+}
+
+void tst_HtmlScanner::snippetCutAtWord()
+{
+    QStringList words;
+    for (int i = 0; i < 100; ++i) {
+        words.append(QStringLiteral("word%1").arg(i));
+    }
+    const QString text = words.join(QLatin1Char(' '));
+    const HtmlSummary summary = HtmlScanner::scan(QStringLiteral("<p>") + text + QStringLiteral("</p>"));
+
+    // Every word is counted, the snippet ends on a whole word and an ellipsis
+    QCOMPARE(summary.wordCount, 100);
+    QVERIFY(summary.snippet.size() <= HtmlScanner::SnippetLength + 1);
+    QVERIFY(summary.snippet.endsWith(QChar(0x2026)));
+    const QString kept = summary.snippet.chopped(1);
+    QVERIFY(text.startsWith(kept));
+    QCOMPARE(text.at(kept.size()), QChar(' '));
+}
+
+void tst_HtmlScanner::plainText()
+{
+    QCOMPARE(HtmlScanner::toPlainText(QStringLiteral("<p>One</p><p>Two <b>bold</b></p><ul><li>A</li><li>B</li></ul>")),
+             QStringLiteral("One\nTwo bold\nA\nB"));
+}
+
+void tst_HtmlScanner::entityCodePoint()
+{
+    QCOMPARE(HtmlScanner::entityCodePoint("amp"), int('&'));
+    QCOMPARE(HtmlScanner::entityCodePoint("nbsp"), 0xA0);
+    QCOMPARE(HtmlScanner::entityCodePoint("eacute"), 0xE9);
+    QCOMPARE(HtmlScanner::entityCodePoint("Eacute"), 0xC9);
+    QCOMPARE(HtmlScanner::entityCodePoint("AMP"), -1);
+    QCOMPARE(HtmlScanner::entityCodePoint("nosuchentity"), -1);
+}
+
+QTEST_APPLESS_MAIN(tst_HtmlScanner)
+
+#include "tst_htmlscanner.moc"
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include <QtTest>
+#include <QTcpSocket>
+
+#include "localapiserver.h"
+#include "rssparser.h"
+
+// The API answers only requests that name it as 127.0.0.1:<port> or
+// localhost:<port>, so a page on a rebound DNS name cannot read it, and
+// grants CORS access only to the configured origins.
+class tst_LocalApiServer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void host_data();
+    void host();
+    void origin_data();
+    void origin();
+    void forbiddenHostWithAllowedOrigin();
+
+private:
+    RssParser *m_parser = nullptr;
+    LocalApiServer *m_server = nullptr;
+
+    QByteArray get(const QByteArray &headers) const;
+};
+
+static const char AllowedOrigin[] = "http://wallboard.local:8080";
+
+static int status(const QByteArray &response)
+{
+    const QList<QByteArray> statusLine = response.left(response.indexOf("\r\n")).split(' ');
+    return statusLine.size() >= 2 ? statusLine.at(1).toInt() : 0;
+}
+
+static QByteArray header(const QByteArray &response, const QByteArray &name)
+{
+    const QList<QByteArray> lines = response.left(response.indexOf("\r\n\r\n")).split('\n');
+    for (const QByteArray &line : lines) {
+        const int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == name.toLower()) {
+            return line.mid(colon + 1).trimmed();
+        }
+    }
+    return QByteArray();
+}
+
+void tst_LocalApiServer::initTestCase()
+{
+    // The parser opens a store and reads settings; keep both out of the user's
+    QStandardPaths::setTestModeEnabled(true);
+    m_parser = new RssParser(this);
+    m_server = new LocalApiServer(m_parser, this);
+    m_server->setAllowedOrigins({ QLatin1String(AllowedOrigin) });
+
+    // The checks need the real port, so look for a free one
+    for (quint16 port = LocalApiServer::DefaultPort + 10000; port < LocalApiServer::DefaultPort + 10100; ++port) {
+        if (m_server->setEnabled(true, port)) {
+            break;
+        }
+    }
+    QVERIFY(m_server->isListening());
+}
+
+void tst_LocalApiServer::cleanupTestCase()
+{
+    delete m_server;
+    m_server = nullptr;
+    delete m_parser;
+    m_parser = nullptr;
+}
+
+// The server answers on this thread, so the exchange runs in an event loop
+QByteArray tst_LocalApiServer::get(const QByteArray &headers) const
+{
+    QTcpSocket socket;
+    QByteArray response;
+    QEventLoop loop;
+    connect(&socket, &QTcpSocket::connected, &socket, [&socket, &headers]() {
+        socket.write("GET /api/feeds HTTP/1.1\r\n" + headers + "\r\n");
+    });
+    connect(&socket, &QTcpSocket::readyRead, &socket, [&socket, &response]() {
+        response += socket.readAll();
+    });
+    connect(&socket, &QTcpSocket::disconnected, &loop, &QEventLoop::quit);
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    socket.connectToHost(QHostAddress::LocalHost, m_server->port());
+    loop.exec();
+    return response + socket.readAll();
+}
+
+void tst_LocalApiServer::host_data()
+{
+    QTest::addColumn<QByteArray>("host");
+    QTest::addColumn<int>("expected");
+
+    const QByteArray port = QByteArray::number(m_server->port());
+    const QByteArray otherPort = QByteArray::number(m_server->port() + 1);
+
+    QTest::newRow("address") << "127.0.0.1:" + port << 200;
+    QTest::newRow("localhost") << "localhost:" + port << 200;
+    QTest::newRow("mixed case") << "LocalHost:" + port << 200;
+    QTest::newRow("no host") << QByteArray() << 403;
+    QTest::newRow("no port") << QByteArray("127.0.0.1") << 403;
+    QTest::newRow("other port") << "localhost:" + otherPort << 403;
+    QTest::newRow("rebound name") << "attacker.example:" + port << 403;
+    QTest::newRow("address as subdomain") << "127.0.0.1.attacker.example:" + port << 403;
+    QTest::newRow("localhost as subdomain") << "localhost.attacker.example:" + port << 403;
+    QTest::newRow("IPv6 loopback") << "[::1]:" + port << 403;
+}
+
+void tst_LocalApiServer::host()
+{
+    QFETCH(QByteArray, host);
+    QFETCH(int, expected);
+
+    const QByteArray response = get(host.isEmpty() ? QByteArray() : "Host: " + host + "\r\n");
+    QCOMPARE(status(response), expected);
+    if (expected == 403) {
+        QVERIFY(!response.contains("\"feeds\""));
+    }
+}
+
+void tst_LocalApiServer::origin_data()
+{
+    QTest::addColumn<QByteArray>("origin");
+    QTest::addColumn<QByteArray>("allowed");
+
+    QTest::newRow("none") << QByteArray() << QByteArray();
+    QTest::newRow("allowed") << QByteArray(AllowedOrigin) << QByteArray(AllowedOrigin);
+    QTest::newRow("other") << QByteArray("https://attacker.example") << QByteArray();
+    QTest::newRow("allowed as prefix") << QByteArray(AllowedOrigin) + ".attacker.example" << QByteArray();
+    QTest::newRow("other port") << QByteArray("http://wallboard.local:8081") << QByteArray();
+    QTest::newRow("opaque") << QByteArray("null") << QByteArray();
+}
+
+void tst_LocalApiServer::origin()
+{
+    QFETCH(QByteArray, origin);
+    QFETCH(QByteArray, allowed);
+
+    QByteArray headers = "Host: 127.0.0.1:" + QByteArray::number(m_server->port()) + "\r\n";
+    if (!origin.isEmpty()) {
+        headers += "Origin: " + origin + "\r\n";
+    }
+    const QByteArray response = get(headers);
+
+    // Other origins are answered too; the browser just may not read it
+    QCOMPARE(status(response), 200);
+    QCOMPARE(header(response, "Access-Control-Allow-Origin"), allowed);
+    QCOMPARE(header(response, "Access-Control-Expose-Headers").isEmpty(), allowed.isEmpty());
+}
+
+void tst_LocalApiServer::forbiddenHostWithAllowedOrigin()
+{
+    const QByteArray response = get("Host: attacker.example:" + QByteArray::number(m_server->port()) + "\r\n"
+                                    "Origin: " + QByteArray(AllowedOrigin) + "\r\n");
+    QCOMPARE(status(response), 403);
+    QVERIFY(header(response, "Access-Control-Allow-Origin").isEmpty());
+}
+
+QTEST_GUILESS_MAIN(tst_LocalApiServer)
+
+#include "tst_localapiserver.moc"
\ No newline at end of file
@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    bytescanner \
+    footprint \
+    parse \
+    theme
\ No newline at end of file
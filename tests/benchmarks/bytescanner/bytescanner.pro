@@ -0,0 +1,14 @@
+include(../../tests.pri)
+
+TARGET = tst_bench_bytescanner
+
+QT += sql
+
+SOURCES += \
+    tst_bench_bytescanner.cpp \
+    $$SRC_DIR/bytescanner.cpp \
+    $$SRC_DIR/htmlscanner.cpp \
+    $$SRC_DIR/articlestore.cpp \
+    $$SRC_DIR/feeditem.cpp \
+    $$SRC_DIR/categoryindex.cpp \
+    $$SRC_DIR/storycluster.cpp
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <QtTest>
+
+#include "bytescanner.h"
+#include "htmlscanner.h"
+#include "articlestore.h"
+
+// Byte scan and HTML scan throughput per kernel over real feed data: the
+// files in $MOTORSPORTRSS_CAPTURES (raw responses saved from feeds), or
+// else the bodies in the application's article store.
+//
+//   MOTORSPORTRSS_CAPTURES=~/captures ./tst_bench_bytescanner
+class tst_BenchByteScanner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+    void findFirstOf_data();
+    void findFirstOf();
+    void htmlScan_data();
+    void htmlScan();
+
+private:
+    QList<QByteArray> m_samples;
+    qint64 m_bytes = 0;
+
+    static void addKernels();
+};
+
+void tst_BenchByteScanner::initTestCase()
+{
+    const QString captures = qEnvironmentVariable("MOTORSPORTRSS_CAPTURES");
+    if (!captures.isEmpty()) {
+        QDirIterator it(captures, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            QFile file(it.next());
+            if (file.open(QIODevice::ReadOnly)) {
+                m_samples.append(file.readAll());
+            }
+        }
+    } else {
+        // The same store the application uses, never created here
+        QCoreApplication::setOrganizationName("Motorsport");
+        QCoreApplication::setApplicationName("MotorsportRSS");
+        const QString path = ArticleStore::defaultPath();
+        if (QFile::exists(path)) {
+            ArticleStore store;
+            if (store.open(path)) {
+                m_samples = store.sampleDescriptions(500);
+            }
+        }
+    }
+
+    for (const QByteArray &sample : m_samples) {
+        m_bytes += sample.size();
+    }
+    if (m_bytes == 0) {
+        QSKIP("No captures: set MOTORSPORTRSS_CAPTURES or run the application once");
+    }
+    qInfo("%d samples, %lld bytes", m_samples.size(), m_bytes);
+}
+
+void tst_BenchByteScanner::cleanup()
+{
+    ByteScanner::setKernel(ByteScanner::bestKernel());
+}
+
+void tst_BenchByteScanner::addKernels()
+{
+    QTest::addColumn<int>("kernel");
+    QTest::newRow("scalar") << int(ByteScanner::Scalar);
+    QTest::newRow("sse2") << int(ByteScanner::Sse2);
+    QTest::newRow("avx2") << int(ByteScanner::Avx2);
+}
+
+void tst_BenchByteScanner::findFirstOf_data()
+{
+    addKernels();
+}
+
+void tst_BenchByteScanner::findFirstOf()
+{
+    QFETCH(int, kernel);
+    if (!ByteScanner::isSupported(ByteScanner::Kernel(kernel))) {
+        QSKIP("Kernel not supported on this CPU");
+    }
+    ByteScanner::setKernel(ByteScanner::Kernel(kernel));
+
+    // Markup and entity starts, the scan the parsers and HtmlScanner run
+    int hits = 0;
+    QBENCHMARK {
+        hits = 0;
+        for (const QByteArray &sample : m_samples) {
+            const char *p = sample.constData();
+            const char *end = p + sample.size();
+            while ((p = ByteScanner::findFirstOf(p, end, '<', '&')) != end) {
+                ++hits;
+                ++p;
+            }
+        }
+    }
+    QVERIFY(hits >= 0);
+}
+
+void tst_BenchByteScanner::htmlScan_data()
+{
+    addKernels();
+}
+
+void tst_BenchByteScanner::htmlScan()
+{
+    QFETCH(int, kernel);
+    if (!ByteScanner::isSupported(ByteScanner::Kernel(kernel))) {
+        QSKIP("Kernel not supported on this CPU");
+    }
+    ByteScanner::setKernel(ByteScanner::Kernel(kernel));
+
+    int words = 0;
+    QBENCHMARK {
+        words = 0;
+        for (const QByteArray &sample : m_samples) {
+            words += HtmlScanner::scan(sample).wordCount;
+        }
+    }
+    QVERIFY(words >= 0);
+}
+
+QTEST_GUILESS_MAIN(tst_BenchByteScanner)
+
+#include "tst_bench_bytescanner.moc"
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include <QtTest>
+
+#include "feeditem.h"
+#include "rssparser.h"
+#include "alloccounter.h"
+
+// Heap bytes per resident item for the compact FeedItem and for the layout
+// it replaced (seven QStrings and a QDateTime), measured as the growth of
+// malloc's in-use bytes while 10,000 items are built. The items are the
+// entries of $MOTORSPORTRSS_CAPTURES, repeated up to the count, or else
+// generated ones with the shape of a typical news feed entry.
+//
+//   MOTORSPORTRSS_CAPTURES=~/captures ./tst_bench_footprint
+class tst_BenchFootprint : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void compactLayout();
+    void legacyLayout();
+
+private:
+    struct Entry {
+        QString title;
+        QString link;
+        QString description;
+        QString pubDate;
+        QString imageUrl;
+        QString guid;
+        QStringList categories;
+    };
+
+    // FeedItem before the compact layout
+    struct LegacyFeedItem {
+        QString title;
+        QString link;
+        QString description;
+        QString pubDate;
+        QString imageUrl;
+        QString category;
+        QString guid;
+        bool isRead = false;
+        QDateTime fetchTime = QDateTime::currentDateTime();
+    };
+
+    QVector<Entry> m_entries;
+
+    void loadCaptures(const QString &directory);
+    void generateEntries();
+    static QString copy(const QString &value);
+};
+
+static const int ItemCount = 10000;
+static const char FeedUrl[] = "https://www.example.com/rss/news";
+
+void tst_BenchFootprint::initTestCase()
+{
+    if (!AllocCounter::isAvailable()) {
+        QSKIP("Heap usage is only measured with glibc");
+    }
+
+    const QString captures = qEnvironmentVariable("MOTORSPORTRSS_CAPTURES");
+    if (!captures.isEmpty()) {
+        loadCaptures(captures);
+    }
+    if (m_entries.isEmpty()) {
+        generateEntries();
+    }
+
+    // Repeat the entries up to the item count, each copy with its own GUID
+    const int distinct = m_entries.size();
+    m_entries.reserve(ItemCount);
+    for (int i = distinct; i < ItemCount; ++i) {
+        Entry entry = m_entries.at(i % distinct);
+        entry.guid += QLatin1Char('#') + QString::number(i);
+        m_entries.append(entry);
+    }
+    m_entries.resize(ItemCount);
+    qInfo("%d distinct entries, %d items", distinct, ItemCount);
+}
+
+void tst_BenchFootprint::loadCaptures(const QString &directory)
+{
+    QStandardPaths::setTestModeEnabled(true);
+    RssParser parser;
+    QDirIterator it(directory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        QList<FeedItem> items;
+        if (!file.open(QIODevice::ReadOnly)
+                || !parser.parseItems(QStringLiteral("capture:") + QFileInfo(file).fileName(), file.readAll(),
+                                      QByteArray(), &items)) {
+            continue;
+        }
+        for (const FeedItem &item : items) {
+            Entry entry;
+            entry.title = item.title;
+            entry.link = item.link();
+            entry.description = item.description();
+            entry.pubDate = item.pubDate;
+            entry.imageUrl = item.imageUrl();
+            entry.guid = item.guid();
+            entry.categories = item.categories();
+            m_entries.append(entry);
+        }
+    }
+}
+
+void tst_BenchFootprint::generateEntries()
+{
+    // A few sites, a few series, a headline and a body of a few paragraphs
+    const QStringList hosts = {
+        "https://www.motorsport.com", "https://www.autosport.com", "https://www.formula1.com",
+        "https://www.motogp.com", "https://www.nascar.com", "https://www.wrc.com"
+    };
+    const QStringList series = { "Formula 1", "MotoGP", "NASCAR", "WRC", "IndyCar", "WEC", "Formula E" };
+    const QString paragraph = QStringLiteral(
+        "<p>The team confirmed on Thursday that the upgraded floor will race this weekend after "
+        "the simulator work showed a gain in the slow corners. Drivers reported less bouncing on "
+        "the straights and more consistent balance through the long runs of the second session.</p>");
+
+    for (int i = 0; i < 500; ++i) {
+        const QString host = hosts.at(i % hosts.size());
+        const QString slug = QStringLiteral("team-confirms-upgrade-package-for-round-%1").arg(i);
+        Entry entry;
+        entry.title = QStringLiteral("Team confirms upgrade package ahead of round %1 of the season").arg(i);
+        entry.link = host + QStringLiteral("/news/") + slug + QStringLiteral("/") + QString::number(100000 + i);
+        entry.description = paragraph.repeated(1 + i % 4);
+        entry.pubDate = QDateTime::fromSecsSinceEpoch(1760000000 - i * 1800, Qt::UTC).toString(Qt::RFC2822Date);
+        entry.imageUrl = host + QStringLiteral("/images/") + QString::number(200000 + i) + QStringLiteral(".jpg");
+        entry.guid = entry.link;
+        entry.categories << series.at(i % series.size());
+        if (i % 3 == 0) {
+            entry.categories << series.at((i + 1) % series.size());
+        }
+        m_entries.append(entry);
+    }
+}
+
+// Fresh string data, so no item shares its strings with the entries
+QString tst_BenchFootprint::copy(const QString &value)
+{
+    return value.isEmpty() ? QString() : QString(value.constData(), value.size());
+}
+
+void tst_BenchFootprint::compactLayout()
+{
+    // Includes the growth of the intern tables these items fill
+    const quint64 before = AllocCounter::heapInUse();
+    QVector<FeedItem> items;
+    items.reserve(ItemCount);
+    for (const Entry &entry : qAsConst(m_entries)) {
+        FeedItem item;
+        item.title = copy(entry.title);
+        item.pubDate = copy(entry.pubDate);
+        item.setLink(entry.link);
+        item.setImageUrl(entry.imageUrl);
+        item.setGuid(entry.guid);
+        item.setDescription(entry.description);
+        item.setCategories(entry.categories);
+        item.setFeedUrl(QLatin1String(FeedUrl));
+        items.append(item);
+    }
+    const quint64 after = AllocCounter::heapInUse();
+
+    qint64 estimate = 0;
+    for (const FeedItem &item : qAsConst(items)) {
+        estimate += item.memoryFootprint();
+    }
+    qInfo("Measured %llu bytes, estimated %lld bytes without the intern tables",
+          after - before, estimate);
+    QTest::setBenchmarkResult(qreal(after - before) / ItemCount, QTest::BytesAllocated);
+}
+
+void tst_BenchFootprint::legacyLayout()
+{
+    const quint64 before = AllocCounter::heapInUse();
+    QVector<LegacyFeedItem> items;
+    items.reserve(ItemCount);
+    for (const Entry &entry : qAsConst(m_entries)) {
+        LegacyFeedItem item;
+        item.title = copy(entry.title);
+        item.link = copy(entry.link);
+        item.description = copy(entry.description);
+        item.pubDate = copy(entry.pubDate);
+        item.imageUrl = copy(entry.imageUrl);
+        item.category = copy(entry.categories.value(0));
+        item.guid = copy(entry.guid);
+        items.append(item);
+    }
+    const quint64 after = AllocCounter::heapInUse();
+
+    // legacyFootprint() estimates the same from a compact item
+    qint64 estimate = 0;
+    for (const Entry &entry : qAsConst(m_entries)) {
+        FeedItem item;
+        item.title = entry.title;
+        item.pubDate = entry.pubDate;
+        item.setLink(entry.link);
+        item.setImageUrl(entry.imageUrl);
+        item.setGuid(entry.guid);
+        item.setDescription(entry.description);
+        item.setCategories(entry.categories);
+        estimate += item.legacyFootprint();
+    }
+    qInfo("Measured %llu bytes, estimated %lld bytes", after - before, estimate);
+    QTest::setBenchmarkResult(qreal(after - before) / ItemCount, QTest::BytesAllocated);
+}
+
+QTEST_GUILESS_MAIN(tst_BenchFootprint)
+
+#include "tst_bench_footprint.moc"
\ No newline at end of file
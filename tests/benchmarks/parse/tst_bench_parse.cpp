@@ -0,0 +1,115 @@
+#include <QtTest>
+
+#include "rssparser.h"
+#include "alloccounter.h"
+
+// Parse time and heap allocations per item for real feed documents: the
+// files in $MOTORSPORTRSS_CAPTURES, raw responses saved from feeds. Every
+// capture is parsed through the same ingest path as a fetched feed.
+//
+//   MOTORSPORTRSS_CAPTURES=~/captures ./tst_bench_parse
+class tst_BenchParse : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void parse_data();
+    void parse();
+    void allocations_data();
+    void allocations();
+
+private:
+    RssParser *m_parser = nullptr;
+    QList<QPair<QString, QByteArray>> m_captures; // file name, bytes
+
+    void addCaptures();
+};
+
+void tst_BenchParse::initTestCase()
+{
+    const QString captures = qEnvironmentVariable("MOTORSPORTRSS_CAPTURES");
+    if (captures.isEmpty()) {
+        QSKIP("Set MOTORSPORTRSS_CAPTURES to a directory of captured feeds");
+    }
+    QDirIterator it(captures, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        if (file.open(QIODevice::ReadOnly)) {
+            m_captures.append(qMakePair(QFileInfo(file).fileName(), file.readAll()));
+        }
+    }
+    if (m_captures.isEmpty()) {
+        QSKIP("No captures found");
+    }
+
+    // The parser opens a store and reads settings; keep both out of the user's
+    QStandardPaths::setTestModeEnabled(true);
+    m_parser = new RssParser(this);
+}
+
+void tst_BenchParse::cleanupTestCase()
+{
+    delete m_parser;
+    m_parser = nullptr;
+}
+
+void tst_BenchParse::addCaptures()
+{
+    QTest::addColumn<QString>("feedUrl");
+    QTest::addColumn<QByteArray>("payload");
+    for (const auto &capture : m_captures) {
+        QTest::newRow(qPrintable(capture.first)) << QStringLiteral("capture:") + capture.first << capture.second;
+    }
+}
+
+void tst_BenchParse::parse_data()
+{
+    addCaptures();
+}
+
+void tst_BenchParse::parse()
+{
+    QFETCH(QString, feedUrl);
+    QFETCH(QByteArray, payload);
+
+    QList<FeedItem> items;
+    QBENCHMARK {
+        items.clear();
+        QVERIFY(m_parser->parseItems(feedUrl, payload, QByteArray(), &items));
+    }
+    QVERIFY(!items.isEmpty());
+}
+
+void tst_BenchParse::allocations_data()
+{
+    addCaptures();
+}
+
+void tst_BenchParse::allocations()
+{
+    if (!AllocCounter::isAvailable()) {
+        QSKIP("Allocations are only counted with glibc");
+    }
+    QFETCH(QString, feedUrl);
+    QFETCH(QByteArray, payload);
+
+    // The first parse warms the intern tables and the parse arena
+    QList<FeedItem> items;
+    m_parser->parseItems(feedUrl, payload, QByteArray(), &items);
+    items.clear();
+    items.reserve(1024);
+
+    AllocCounter::start();
+    m_parser->parseItems(feedUrl, payload, QByteArray(), &items);
+    const quint64 allocations = AllocCounter::stop();
+    QVERIFY(!items.isEmpty());
+
+    // Reported as allocations ("events") per parsed item
+    QTest::setBenchmarkResult(qreal(allocations) / items.size(), QTest::Events);
+}
+
+QTEST_GUILESS_MAIN(tst_BenchParse)
+
+#include "tst_bench_parse.moc"
\ No newline at end of file
@@ -0,0 +1,14 @@
+include(../../tests.pri)
+
+TARGET = tst_bench_theme
+
+# Switches the palette of a widget tree; runs on the offscreen platform
+QT += gui widgets
+
+SOURCES += \
+    tst_bench_theme.cpp \
+    $$SRC_DIR/thememanager.cpp \
+    $$SRC_DIR/feedmetrics.cpp
+
+HEADERS += \
+    $$SRC_DIR/thememanager.h
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include <QtTest>
+#include <QApplication>
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QGridLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QComboBox>
+#include <QListWidget>
+#include <QTextBrowser>
+
+#include "thememanager.h"
+
+// Theme switch latency: ThemeManager::apply() on a shown widget tree the
+// size of the main window, until the polish and layout requests it queued
+// have run. One iteration switches to the dark theme and back.
+class tst_BenchTheme : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void switchAndBack();
+
+private:
+    QWidget *m_window = nullptr;
+};
+
+void tst_BenchTheme::initTestCase()
+{
+    ThemeManager::instance().apply(ThemeManager::LightTheme);
+
+    m_window = new QWidget;
+    QVBoxLayout *layout = new QVBoxLayout(m_window);
+    QGridLayout *controls = new QGridLayout;
+    for (int row = 0; row < 20; ++row) {
+        controls->addWidget(new QLabel(QStringLiteral("Setting %1").arg(row)), row, 0);
+        controls->addWidget(new QLineEdit(QStringLiteral("Value %1").arg(row)), row, 1);
+        QComboBox *combo = new QComboBox;
+        combo->addItems({ "Formula 1", "MotoGP", "NASCAR", "WRC" });
+        controls->addWidget(combo, row, 2);
+        controls->addWidget(new QPushButton(QStringLiteral("Apply")), row, 3);
+    }
+    layout->addLayout(controls);
+
+    QListWidget *list = new QListWidget;
+    for (int i = 0; i < 500; ++i) {
+        list->addItem(QStringLiteral("Team confirms upgrade package ahead of round %1").arg(i));
+    }
+    layout->addWidget(list);
+    QTextBrowser *article = new QTextBrowser;
+    article->setHtml(QStringLiteral("<h2>Race report</h2><p>%1</p>")
+                     .arg(QStringLiteral("The leader held on through the final stint. ").repeated(40)));
+    layout->addWidget(article);
+
+    m_window->resize(1200, 900);
+    m_window->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_window));
+}
+
+void tst_BenchTheme::cleanupTestCase()
+{
+    delete m_window;
+    m_window = nullptr;
+}
+
+void tst_BenchTheme::switchAndBack()
+{
+    ThemeManager &theme = ThemeManager::instance();
+    QBENCHMARK {
+        theme.apply(ThemeManager::DarkTheme);
+        QCoreApplication::processEvents();
+        theme.apply(ThemeManager::LightTheme);
+        QCoreApplication::processEvents();
+    }
+    QCOMPARE(theme.theme(), ThemeManager::LightTheme);
+}
+
+// Widgets need a QApplication; the offscreen platform works without a display
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    tst_BenchTheme test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_bench_theme.moc"
\ No newline at end of file
@@ -0,0 +1,12 @@
+# Shared setup for the test and benchmark targets. Each target lists the
+# sources under src/ that it needs; only the targets that paint link widgets.
+QT += testlib
+QT -= gui
+
+CONFIG += testcase c++11 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SRC_DIR = $$PWD/../src
+INCLUDEPATH += $$SRC_DIR
\ No newline at end of file
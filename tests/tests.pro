@@ -0,0 +1,5 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    auto \
+    benchmarks
\ No newline at end of file